@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <jvm/class.h>
+#include <jvm/class-finalizer.h>
+#include <jvm/class-hierarchy.h>
+#include <jvm/constant-fieldref.h>
+#include <jvm/constant-methodref.h>
+#include <jvm/descriptor-method.h>
+#include <jvm/embedded-jvm.h>
+#include <jvm/method.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t classCount = 10000;
+
+    /**
+     * Build a small class with a printing loop in @c main.
+     */
+    std::unique_ptr<Class> buildClass(int32_t number, const ClassHierarchy& hierarchy)
+    {
+        auto benchmarkClass = std::make_unique<Class>("FinalizerBenchmark" + std::to_string(number),
+                                                      "java/lang/Object");
+        benchmarkClass->addFlag(Class::ACC_PUBLIC);
+        benchmarkClass->addFlag(Class::ACC_SUPER);
+        benchmarkClass->setClassHierarchy(&hierarchy);
+
+        Method* method = benchmarkClass->getOrCreateMethod(
+            "main", DescriptorMethod{std::nullopt, {{"java/lang/String", 1}}});
+        method->addFlag(Method::ACC_PUBLIC);
+        method->addFlag(Method::ACC_STATIC);
+
+        auto* out = benchmarkClass->getOrCreateFieldrefConstant(
+            "java/lang/System", "out", DescriptorField("java/io/PrintStream"));
+        auto* println = benchmarkClass->getOrCreateMethodrefConstant(
+            "java/io/PrintStream", "println", DescriptorMethod(std::nullopt, {{"java/lang/String"}}));
+
+        AttributeCode* code = method->getCodeAttribute();
+        auto* loop = code->CodeLabel();
+        *code << code->PushInt(number) << code->StoreInt(1)
+            << loop << code->GetStatic(out) << code->PushString("iteration")
+            << code->InvokeVirtual(println)
+            << code->IncrementLocalVariable(1, -1) << code->LoadInt(1)
+            << code->If(Instruction::NotEqual, loop)
+            << code->ReturnVoid();
+
+        return benchmarkClass;
+    }
+
+    /**
+     * Build @p count fresh classes and write them all with @p finalizer.
+     * @return Written classes per second, finalization included.
+     * @throws std::runtime_error If not every class reached the sink.
+     */
+    double measure(const ClassFinalizer& finalizer, int32_t count)
+    {
+        SimpleClassHierarchy hierarchy;
+        std::vector<std::unique_ptr<Class>> classes;
+        std::vector<const Class*> batch;
+        for (int32_t i = 0; i < count; ++i)
+        {
+            classes.push_back(buildClass(i, hierarchy));
+            batch.push_back(classes.back().get());
+        }
+
+        std::size_t totalSize = 0;
+        int32_t writtenCount = 0;
+        auto start = Clock::now();
+        Class::writeAll(batch, [&totalSize, &writtenCount](const Class&, std::span<const std::byte> bytes)
+        {
+            totalSize += bytes.size();
+            ++writtenCount;
+        }, finalizer);
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        if (writtenCount != count || totalSize == 0)
+        {
+            throw std::runtime_error("Not all classes were written.");
+        }
+
+        return static_cast<double>(count) / elapsed;
+    }
+}
+
+int main()
+{
+    struct Strategy
+    {
+        const char* name;
+        const ClassFinalizer& finalizer;
+    };
+
+    const Strategy strategies[] = {
+        {"none", ClassFinalizer::none()},
+        {"native maxs", ClassFinalizer::nativeMaxs()},
+        {"native frames", ClassFinalizer::nativeFrames()},
+        {"embedded jvm", ClassFinalizer::embeddedJvm()},
+        {"helper process", ClassFinalizer::externalHelperProcess()},
+    };
+
+    // pay jvm and helper process startup and warm up FixClass before measuring;
+    // the classes have a hierarchy, so every strategy must also write code it finalizes weaker than nativeFrames
+    EmbeddedJvm session;
+    for (const auto& strategy : strategies)
+    {
+        try
+        {
+            (void)measure(strategy.finalizer, classCount / 10);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << strategy.name << " can't write classes with a hierarchy: " << e.what() << '\n';
+            return 1;
+        }
+    }
+
+    std::cout << std::setw(16) << "finalizer" << std::setw(16) << "classes/s" << '\n';
+    for (const auto& strategy : strategies)
+    {
+        std::cout << std::setw(16) << strategy.name
+            << std::setw(16) << std::fixed << std::setprecision(0)
+            << measure(strategy.finalizer, classCount) << '\n';
+    }
+}
@@ -0,0 +1,57 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+
+#include <jvm/class.h>
+#include <jvm/descriptor-method.h>
+#include <jvm/method.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t classCount = 1000;
+    constexpr int32_t instructionsPerClass = 1000;
+
+    /**
+     * Build and destroy @ref classCount classes with a method of @ref instructionsPerClass instructions,
+     * taking arena blocks from @p upstream.
+     * @return Nanoseconds per instruction, class teardown included.
+     */
+    double measure(std::pmr::memory_resource* upstream)
+    {
+        auto start = Clock::now();
+        for (int32_t i = 0; i < classCount; ++i)
+        {
+            Class benchmarkClass("LifetimeBenchmark" + std::to_string(i), "java/lang/Object", upstream);
+            Method* method = benchmarkClass.getOrCreateMethod("run", DescriptorMethod(std::nullopt, {}));
+            method->addFlag(Method::ACC_STATIC);
+
+            AttributeCode* code = method->getCodeAttribute();
+            for (int32_t j = 0; j < instructionsPerClass / 2; ++j)
+            {
+                *code << code->PushInt(j) << code->PopOne();
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        return elapsed / (static_cast<double>(classCount) * instructionsPerClass);
+    }
+}
+
+int main()
+{
+    std::pmr::unsynchronized_pool_resource pool;
+
+    std::cout << std::setw(24) << "upstream" << std::setw(20) << "ns/instruction" << '\n';
+    std::cout << std::setw(24) << "default resource"
+        << std::setw(20) << std::fixed << std::setprecision(1) << measure(std::pmr::get_default_resource()) << '\n';
+    std::cout << std::setw(24) << "unsynchronized pool"
+        << std::setw(20) << std::fixed << std::setprecision(1) << measure(&pool) << '\n';
+}
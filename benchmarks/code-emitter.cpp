@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <jvm/class.h>
+#include <jvm/class-finalizer.h>
+#include <jvm/descriptor-method.h>
+#include <jvm/method.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t classCount = 1000;
+    constexpr int32_t loopsPerMethod = 100;
+
+    /**
+     * Build and serialize @ref classCount classes with a method of @ref loopsPerMethod counting loops,
+     * writing the code with @p writeCode.
+     * @return Nanoseconds per emitted instruction, serialization included.
+     */
+    template <typename WriteCode>
+    double measure(WriteCode writeCode)
+    {
+        std::size_t instructions = 0;
+        auto start = Clock::now();
+        for (int32_t i = 0; i < classCount; ++i)
+        {
+            Class benchmarkClass("EmitterBenchmark" + std::to_string(i), "java/lang/Object");
+            benchmarkClass.setFinalizer(&ClassFinalizer::nativeMaxs());
+            Method* method = benchmarkClass.getOrCreateMethod("run", DescriptorMethod(std::nullopt, {}));
+            method->addFlag(Method::ACC_STATIC);
+
+            instructions += writeCode(method);
+            auto bytes = benchmarkClass.toBytes();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        return elapsed / static_cast<double>(instructions);
+    }
+
+    std::size_t writeWithAttributeCode(Method* method)
+    {
+        AttributeCode* code = method->getCodeAttribute();
+        for (int32_t j = 0; j < loopsPerMethod; ++j)
+        {
+            auto* loop = code->CodeLabel();
+            *code << code->PushInt(j) << code->StoreInt(0)
+                << loop << code->IncrementLocalVariable(0, 1)
+                << code->LoadInt(0) << code->PushInt(1000) << code->IfWithCompare(Instruction::LessThan, loop);
+        }
+        *code << code->ReturnVoid();
+        return loopsPerMethod * 6 + 1;
+    }
+
+    std::size_t writeWithCodeEmitter(Method* method)
+    {
+        CodeEmitter& code = *method->getCodeEmitter();
+        for (int32_t j = 0; j < loopsPerMethod; ++j)
+        {
+            auto loop = code.newLabel();
+            code.emitPushInt(j).emitLocal(Instruction::INSTRUCTION_istore, 0)
+                .bind(loop).emitIncrement(0, 1)
+                .emitLocal(Instruction::INSTRUCTION_iload, 0).emitPushInt(1000)
+                .emitJump(Instruction::INSTRUCTION_if_icmplt, loop);
+        }
+        code.emit(Instruction::INSTRUCTION_return);
+        return loopsPerMethod * 6 + 1;
+    }
+}
+
+int main()
+{
+    std::cout << std::setw(24) << "code writer" << std::setw(20) << "ns/instruction" << '\n';
+    std::cout << std::setw(24) << "AttributeCode"
+        << std::setw(20) << std::fixed << std::setprecision(1) << measure(writeWithAttributeCode) << '\n';
+    std::cout << std::setw(24) << "CodeEmitter"
+        << std::setw(20) << std::fixed << std::setprecision(1) << measure(writeWithCodeEmitter) << '\n';
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <jvm/class.h>
+#include <jvm/class-finalizer.h>
+#include <jvm/constant-fieldref.h>
+#include <jvm/descriptor-method.h>
+#include <jvm/method.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t methodCount = 40;
+    constexpr int32_t loopsPerMethod = 5000; ///< Five instructions per loop, 1M instructions in total.
+    constexpr int32_t runCount = 5;
+
+    /**
+     * Build a class of @ref methodCount methods with loops of a load, a push, a backward jump,
+     * a field read and a pop, then finalize all of their code attributes with @p analysis.
+     * @return Nanoseconds per instruction spent in finalize, the best of @ref runCount runs.
+     */
+    double measure(ClassFinalizer::Analysis analysis)
+    {
+        double best = 0;
+        for (int32_t run = 0; run < runCount; ++run)
+        {
+            Class benchmarkClass("FinalizeBenchmark", "java/lang/Object");
+            auto* field = benchmarkClass.getOrCreateFieldrefConstant("FinalizeBenchmark", "value", DescriptorField(Descriptor::Int));
+
+            std::vector<AttributeCode*> codes;
+            std::size_t instructions = 0;
+            for (int32_t i = 0; i < methodCount; ++i)
+            {
+                Method* method = benchmarkClass.getOrCreateMethod("run" + std::to_string(i),
+                                                                  DescriptorMethod(std::nullopt, {DescriptorField(Descriptor::Int)}));
+                method->addFlag(Method::ACC_STATIC);
+
+                AttributeCode* code = method->getCodeAttribute();
+                for (int32_t j = 0; j < loopsPerMethod; ++j)
+                {
+                    auto* loop = code->CodeLabel();
+                    *code << loop << code->LoadInt(0) << code->PushInt(100)
+                        << code->IfWithCompare(Instruction::LessThan, loop)
+                        << code->GetStatic(field) << code->PopOne();
+                }
+                *code << code->ReturnVoid();
+                instructions += loopsPerMethod * 5 + 1;
+                codes.push_back(code);
+            }
+
+            auto start = Clock::now();
+            for (auto* code : codes)
+            {
+                code->finalize(analysis);
+            }
+            auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+            double perInstruction = elapsed / static_cast<double>(instructions);
+            best = run == 0 ? perInstruction : std::min(best, perInstruction);
+        }
+        return best;
+    }
+}
+
+int main()
+{
+    std::cout << std::setw(24) << "analysis" << std::setw(20) << "ns/instruction" << '\n';
+    std::cout << std::setw(24) << "none"
+        << std::setw(20) << std::fixed << std::setprecision(1) << measure(ClassFinalizer::None) << '\n';
+    std::cout << std::setw(24) << "max stack and locals"
+        << std::setw(20) << std::fixed << std::setprecision(1) << measure(ClassFinalizer::Maxs) << '\n';
+}
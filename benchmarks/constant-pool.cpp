@@ -0,0 +1,61 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <jvm/class.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Fill a class with @p count distinct constants (UTF-8 and Integer entries interleaved),
+     * then look every one of them up again.
+     * @return Nanoseconds per getOrCreate call.
+     */
+    double measure(int32_t count)
+    {
+        Class benchmarkClass("ConstantPoolBenchmark", "java/lang/Object");
+
+        auto start = Clock::now();
+        for (int32_t i = 0; i < count; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                (void)benchmarkClass.getOrCreateUtf8Constant("constant_" + std::to_string(i));
+            }
+            else
+            {
+                (void)benchmarkClass.getOrCreateIntegerConstant(i);
+            }
+        }
+        for (int32_t i = 0; i < count; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                (void)benchmarkClass.getOrCreateUtf8Constant("constant_" + std::to_string(i));
+            }
+            else
+            {
+                (void)benchmarkClass.getOrCreateIntegerConstant(i);
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        return elapsed / (2.0 * count);
+    }
+}
+
+int main()
+{
+    std::cout << std::setw(10) << "entries" << std::setw(16) << "ns/constant" << '\n';
+    for (int32_t count : {100, 1000, 5000, 10000, 20000, 40000, 60000})
+    {
+        std::cout << std::setw(10) << count
+            << std::setw(16) << std::fixed << std::setprecision(1) << measure(count) << '\n';
+    }
+}
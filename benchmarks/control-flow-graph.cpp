@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <jvm/class.h>
+#include <jvm/control-flow-graph.h>
+#include <jvm/descriptor-method.h>
+#include <jvm/method.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t classCount = 1000;
+    constexpr int32_t methodsPerClass = 10;
+    constexpr int32_t loopsPerMethod = 20; ///< Six instructions and three blocks per loop.
+    constexpr int32_t runCount = 5;
+}
+
+/**
+ * Build the graphs of many small methods with loops, a switch and an exception handler,
+ * like a batch of generated classes, and report the cost per method and per instruction.
+ */
+int main()
+{
+    std::vector<std::unique_ptr<Class>> classes;
+    std::vector<AttributeCode*> codes;
+    std::size_t instructions = 0;
+    for (int32_t i = 0; i < classCount; ++i)
+    {
+        auto& benchmarkClass = classes.emplace_back(
+            std::make_unique<Class>("GraphBenchmark" + std::to_string(i), "java/lang/Object"));
+        for (int32_t j = 0; j < methodsPerClass; ++j)
+        {
+            Method* method = benchmarkClass->getOrCreateMethod("run" + std::to_string(j),
+                                                               DescriptorMethod(std::nullopt, {DescriptorField(Descriptor::Int)}));
+            method->addFlag(Method::ACC_STATIC);
+
+            AttributeCode* code = method->getCodeAttribute();
+            auto* tryStart = code->CodeLabel();
+            auto* tryEnd = code->CodeLabel();
+            auto* handler = code->CodeLabel();
+            *code << tryStart;
+            for (int32_t k = 0; k < loopsPerMethod; ++k)
+            {
+                auto* loop = code->CodeLabel();
+                auto* odd = code->CodeLabel();
+                auto* next = code->CodeLabel();
+                *code << loop << code->LoadInt(0) << code->Switch(0, 1, next, {loop, odd})
+                    << odd << code->IncrementLocalVariable(0, 1) << code->LoadInt(0)
+                    << code->IfWithCompare(Instruction::LessThan, loop) << next << code->Nop();
+            }
+            *code << tryEnd << code->ReturnVoid() << handler << code->PopOne() << code->ReturnVoid();
+            code->addTryCatch(tryStart, tryEnd, handler, nullptr);
+            instructions += loopsPerMethod * 6 + 3;
+            codes.push_back(code);
+        }
+    }
+
+    double best = 0;
+    std::size_t blocks = 0;
+    for (int32_t run = 0; run < runCount; ++run)
+    {
+        blocks = 0;
+        auto start = Clock::now();
+        for (const auto* code : codes)
+        {
+            ControlFlowGraph graph(*code);
+            blocks += graph.getReversePostorder().size();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        best = run == 0 ? elapsed : std::min(best, elapsed);
+    }
+
+    std::cout << std::setw(16) << "methods" << std::setw(16) << "blocks"
+        << std::setw(16) << "us/method" << std::setw(20) << "ns/instruction" << '\n';
+    std::cout << std::setw(16) << codes.size() << std::setw(16) << blocks
+        << std::setw(16) << std::fixed << std::setprecision(2) << best / 1000 / static_cast<double>(codes.size())
+        << std::setw(20) << std::fixed << std::setprecision(1) << best / static_cast<double>(instructions) << '\n';
+}
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <jvm/class.h>
+#include <jvm/constant-fieldref.h>
+#include <jvm/constant-methodref.h>
+#include <jvm/descriptor-method.h>
+#include <jvm/embedded-jvm.h>
+#include <jvm/method.h>
+
+using namespace jvm;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t classCount = 10000;
+
+    /**
+     * Build a small class with a printing loop in @c main.
+     * @return Class in binary format, not fixed.
+     */
+    std::vector<unsigned char> buildClass(int32_t number)
+    {
+        Class benchmarkClass("FixBenchmark" + std::to_string(number), "java/lang/Object");
+        benchmarkClass.addFlag(Class::ACC_PUBLIC);
+        benchmarkClass.addFlag(Class::ACC_SUPER);
+
+        Method* method = benchmarkClass.getOrCreateMethod(
+            "main", DescriptorMethod{std::nullopt, {{"java/lang/String", 1}}});
+        method->addFlag(Method::ACC_PUBLIC);
+        method->addFlag(Method::ACC_STATIC);
+
+        auto* out = benchmarkClass.getOrCreateFieldrefConstant(
+            "java/lang/System", "out", DescriptorField("java/io/PrintStream"));
+        auto* println = benchmarkClass.getOrCreateMethodrefConstant(
+            "java/io/PrintStream", "println", DescriptorMethod(std::nullopt, {{"java/lang/String"}}));
+
+        AttributeCode* code = method->getCodeAttribute();
+        auto* loop = code->CodeLabel();
+        *code << code->PushInt(number) << code->StoreInt(1)
+            << loop << code->GetStatic(out) << code->PushString("iteration")
+            << code->InvokeVirtual(println)
+            << code->IncrementLocalVariable(1, -1) << code->LoadInt(1)
+            << code->If(Instruction::NotEqual, loop)
+            << code->ReturnVoid();
+
+        auto bytes = benchmarkClass.toBytes();
+        auto* data = reinterpret_cast<const unsigned char*>(bytes.data());
+        return {data, data + bytes.size()};
+    }
+
+    /**
+     * Fix all @p classes using @p threadCount threads taking classes from a shared counter.
+     * @return Fixed classes per second.
+     */
+    double measure(const std::vector<std::vector<unsigned char>>& classes, int32_t threadCount)
+    {
+        std::atomic<std::size_t> next = 0;
+
+        auto start = Clock::now();
+        std::vector<std::thread> threads;
+        for (int32_t i = 0; i < threadCount; ++i)
+        {
+            threads.emplace_back([&]
+            {
+                for (std::size_t index = next++; index < classes.size(); index = next++)
+                {
+                    (void)EmbeddedJvm::fix(classes[index]);
+                }
+            });
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        return static_cast<double>(classes.size()) / elapsed;
+    }
+}
+
+int main()
+{
+    std::vector<std::vector<unsigned char>> classes;
+    classes.reserve(classCount);
+    for (int32_t i = 0; i < classCount; ++i)
+    {
+        classes.push_back(buildClass(i));
+    }
+
+    // pay jvm startup and warm up FixClass before measuring
+    EmbeddedJvm session;
+    (void)measure(classes, 1);
+
+    std::cout << std::setw(10) << "threads" << std::setw(16) << "classes/s" << '\n';
+    for (int32_t threadCount : {1, 2, 4, 8, 16})
+    {
+        std::cout << std::setw(10) << threadCount
+            << std::setw(16) << std::fixed << std::setprecision(0) << measure(classes, threadCount) << '\n';
+    }
+}
@@ -3,15 +3,33 @@
 
 #include <map>
 #include <memory>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
 
 #include "attribute.h"
+#include "attribute-stack-map-table.h"
+#include "class-finalizer.h"
 #include "exception-handler.h"
 #include "instruction.h"
 #include "instruction-jump.h"
+#include "instruction-switch.h"
+#include "method-size-limits.h"
 
+namespace jvm::internal
+{
+    class DeadCodeEliminator;
+    class FrameAnalyzer;
+    class JumpThreader;
+    class MethodOutliner;
+    class PeepholeOptimizer;
+}
 
 namespace jvm
 {
+    class ClassHierarchy;
+
     /**
      * @brief Code attribute.
      *
@@ -35,16 +53,23 @@ namespace jvm
      * 4) Serialize the attribute via @ref toBinary.
      *
      * @note After @ref finalize is called, the instance becomes immutable.
-     * Example (ownership):
+     * Instructions, labels and exception handlers are allocated in the arena of the owning @ref Class
+     * and released with it, whether they are registered or not.
      * @code
-     * auto* L = code->CodeLabel();              // caller owns label
-     * auto* I = code->Nop();                    // caller owns instruction
-     * *code << L << I;                          // ownership transferred to AttributeCode
+     * auto* L = code->CodeLabel();              // allocated in the class arena
+     * auto* I = code->Nop();                    // allocated in the class arena
+     * *code << L << I;                          // placed into the code stream
      * @endcode
      */
     class AttributeCode final : public Attribute, public ClassFileElement<Method>
     {
         friend class Method;
+        friend class ControlFlowGraph;
+        friend class internal::DeadCodeEliminator;
+        friend class internal::FrameAnalyzer;
+        friend class internal::JumpThreader;
+        friend class internal::MethodOutliner;
+        friend class internal::PeepholeOptimizer;
 
     public:
         ~AttributeCode() override;
@@ -57,7 +82,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_nop.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* Nop();
 
@@ -77,7 +102,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_aconst_null.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PushNull();
 
@@ -114,7 +139,7 @@ namespace jvm
          *
          * @param value Integer value.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PushInt(int32_t value);
 
@@ -142,7 +167,7 @@ namespace jvm
          *
          * @param value Long value.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PushLong(int64_t value);
 
@@ -170,7 +195,7 @@ namespace jvm
          *
          * @param value Float value.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PushFloat(float value);
 
@@ -198,7 +223,7 @@ namespace jvm
          *
          * @param value Double value.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PushDouble(double value);
 
@@ -223,7 +248,7 @@ namespace jvm
          *
          * @param stringConstant String constant to push.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using {@ref addInstruction}.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using {@ref addInstruction}.
          */
         [[nodiscard]] Instruction* PushString(ConstantString* stringConstant);
 
@@ -247,7 +272,7 @@ namespace jvm
          *
          * @param value String value to push.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using {@ref addInstruction}.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using {@ref addInstruction}.
          */
         [[nodiscard]] Instruction* PushString(const std::string& value);
 
@@ -264,11 +289,11 @@ namespace jvm
          * | 2     | @ref INSTRUCTION_iload_2 |
          * | 3     | @ref INSTRUCTION_iload_3 |
          *
-         * For indexes other than 0–3, uses @ref INSTRUCTION_iload.
+         * For indexes other than 0–3, uses @ref INSTRUCTION_iload, prefixed with @ref INSTRUCTION_wide for indexes above 255.
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadInt(uint16_t index);
 
@@ -284,11 +309,11 @@ namespace jvm
          * | 2     | @ref INSTRUCTION_lload_2 |
          * | 3     | @ref INSTRUCTION_lload_3 |
          *
-         * For indexes other than 0–3, uses @ref INSTRUCTION_lload.
+         * For indexes other than 0–3, uses @ref INSTRUCTION_lload, prefixed with @ref INSTRUCTION_wide for indexes above 255.
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadLong(uint16_t index);
 
@@ -304,11 +329,11 @@ namespace jvm
          * | 2     | @ref INSTRUCTION_fload_2 |
          * | 3     | @ref INSTRUCTION_fload_3 |
          *
-         * For indexes other than 0–3, uses @ref INSTRUCTION_fload.
+         * For indexes other than 0–3, uses @ref INSTRUCTION_fload, prefixed with @ref INSTRUCTION_wide for indexes above 255.
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadFloat(uint16_t index);
 
@@ -325,11 +350,11 @@ namespace jvm
          * | 2     | @ref INSTRUCTION_dload_2 |
          * | 3     | @ref INSTRUCTION_dload_3 |
          *
-         * For indexes other than 0–3, uses @ref INSTRUCTION_dload.
+         * For indexes other than 0–3, uses @ref INSTRUCTION_dload, prefixed with @ref INSTRUCTION_wide for indexes above 255.
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadDouble(uint16_t index);
 
@@ -345,11 +370,11 @@ namespace jvm
          * | 2     | @ref INSTRUCTION_aload_2 |
          * | 3     | @ref INSTRUCTION_aload_3 |
          *
-         * For indexes other than 0–3, uses @ref INSTRUCTION_aload.
+         * For indexes other than 0–3, uses @ref INSTRUCTION_aload, prefixed with @ref INSTRUCTION_wide for indexes above 255.
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadReference(uint16_t index);
 
@@ -369,7 +394,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_baload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadBooleanFromArray();
 
@@ -389,7 +414,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_baload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadByteFromArray();
 
@@ -409,7 +434,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_caload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadCharFromArray();
 
@@ -429,7 +454,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_saload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadShortFromArray();
 
@@ -449,7 +474,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_iaload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadIntFromArray();
 
@@ -470,7 +495,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_laload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadLongFromArray();
 
@@ -490,7 +515,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_faload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadFloatFromArray();
 
@@ -511,7 +536,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_daload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadDoubleFromArray();
 
@@ -531,7 +556,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_aaload.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LoadReferenceFromArray();
 
@@ -562,7 +587,7 @@ namespace jvm
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreInt(uint16_t index);
 
@@ -595,7 +620,7 @@ namespace jvm
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreLong(uint16_t index);
 
@@ -626,7 +651,7 @@ namespace jvm
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreFloat(uint16_t index);
 
@@ -659,7 +684,7 @@ namespace jvm
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreDouble(uint16_t index);
 
@@ -690,7 +715,7 @@ namespace jvm
          *
          * @param index The local variable index.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreReference(uint16_t index);
 
@@ -710,7 +735,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_iastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreIntToArray();
 
@@ -731,7 +756,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreLongToArray();
 
@@ -751,7 +776,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_fastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreFloatToArray();
 
@@ -772,7 +797,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreDoubleToArray();
 
@@ -792,7 +817,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_aastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreReferenceToArray();
 
@@ -812,7 +837,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_bastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreBooleanToArray();
 
@@ -832,7 +857,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_bastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreByteToArray();
 
@@ -852,7 +877,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_castore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreCharToArray();
 
@@ -872,7 +897,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_sastore.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* StoreShortToArray();
 
@@ -892,7 +917,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_pop.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PopOne();
 
@@ -912,7 +937,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_pop2.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PopTwo();
 
@@ -935,7 +960,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dup.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* Duplicate();
 
@@ -958,7 +983,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dup_x1.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DuplicateBeforeOne();
 
@@ -981,7 +1006,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dup_x2.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DuplicateBeforeTwo();
 
@@ -1005,7 +1030,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dup2.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DuplicateDouble();
 
@@ -1028,7 +1053,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dup2_x1.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DuplicateDoubleBeforeOne();
 
@@ -1051,7 +1076,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dup2_x2.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DuplicateDoubleBeforeTwo();
 
@@ -1071,7 +1096,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_swap.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* Swap();
 
@@ -1091,7 +1116,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_iadd.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* AddInt();
 
@@ -1112,7 +1137,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ladd.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* AddLong();
 
@@ -1132,7 +1157,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_fadd.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* AddFloat();
 
@@ -1153,7 +1178,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dadd.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* AddDouble();
 
@@ -1178,7 +1203,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_isub.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* SubInt();
 
@@ -1204,7 +1229,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lsub.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* SubLong();
 
@@ -1229,7 +1254,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_fsub.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* SubFloat();
 
@@ -1255,7 +1280,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dsub.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* SubDouble();
 
@@ -1275,7 +1300,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_imul.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MulInt();
 
@@ -1296,7 +1321,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lmul.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MulLong();
 
@@ -1316,7 +1341,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_fmul.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MulFloat();
 
@@ -1337,7 +1362,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dmul.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MulDouble();
 
@@ -1362,7 +1387,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_idiv.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DivInt();
 
@@ -1388,7 +1413,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ldiv.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DivLong();
 
@@ -1413,7 +1438,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_fdiv.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DivFloat();
 
@@ -1439,7 +1464,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ddiv.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DivDouble();
 
@@ -1466,7 +1491,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_irem.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RemInt();
 
@@ -1494,7 +1519,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lrem.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RemLong();
 
@@ -1519,7 +1544,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_frem.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RemFloat();
 
@@ -1545,7 +1570,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_drem.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RemDouble();
 
@@ -1570,7 +1595,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ineg.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* NegInt();
 
@@ -1596,7 +1621,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lneg.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* NegLong();
 
@@ -1621,7 +1646,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_fneg.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* NegFloat();
 
@@ -1647,7 +1672,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dneg.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* NegDouble();
 
@@ -1674,7 +1699,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ishl.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LeftShiftInt();
 
@@ -1701,7 +1726,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ishr.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RightArithmeticShiftInt();
 
@@ -1728,7 +1753,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_iushr.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RightLogicShiftInt();
 
@@ -1756,7 +1781,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lshl.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LeftShiftLong();
 
@@ -1784,7 +1809,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lshr.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RightArithmeticShiftLong();
 
@@ -1812,7 +1837,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lushr.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* RightLogicShiftLong();
 
@@ -1837,7 +1862,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_iand.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* BitwiseAndInt();
 
@@ -1863,7 +1888,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_land.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* BitwiseAndLong();
 
@@ -1888,7 +1913,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ior.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* BitwiseOrInt();
 
@@ -1914,7 +1939,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lor.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* BitwiseOrLong();
 
@@ -1939,7 +1964,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ixor.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* BitwiseXorInt();
 
@@ -1965,7 +1990,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lxor.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* BitwiseXorLong();
 
@@ -1980,13 +2005,14 @@ namespace jvm
          * locals[index] = locals[index] + value
          * @endcode
          *
-         * Command: @ref INSTRUCTION_iinc.
+         * Command: @ref INSTRUCTION_iinc, prefixed with @ref INSTRUCTION_wide if @p index is above 255
+         * or @p value is out of [-128, 127].
          *
          * @param index Index of the local variable.
          * @param value Signed increment value.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IncrementLocalVariable(uint16_t index, int16_t value);
 
@@ -2007,7 +2033,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_i2l.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IntToLong();
 
@@ -2027,7 +2053,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_i2f.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IntToFloat();
 
@@ -2048,7 +2074,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_i2d.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IntToDouble();
 
@@ -2069,7 +2095,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_l2i.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LongToInt();
 
@@ -2090,7 +2116,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_l2f.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LongToFloat();
 
@@ -2112,7 +2138,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_l2d.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* LongToDouble();
 
@@ -2132,7 +2158,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_f2i.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* FloatToInt();
 
@@ -2153,7 +2179,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_f2l.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* FloatToLong();
 
@@ -2174,7 +2200,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_f2d.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* FloatToDouble();
 
@@ -2195,7 +2221,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_d2i.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DoubleToInt();
 
@@ -2217,7 +2243,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_d2l.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DoubleToLong();
 
@@ -2238,7 +2264,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_d2f.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* DoubleToFloat();
 
@@ -2258,7 +2284,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_i2b.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IntToByte();
 
@@ -2278,7 +2304,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_i2c.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IntToChar();
 
@@ -2298,7 +2324,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_i2s.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* IntToShort();
 
@@ -2326,7 +2352,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lcmp.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* CompareLong();
 
@@ -2364,7 +2390,7 @@ namespace jvm
          * @param nanResult Result when either operand is NaN.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* CompareFloat(Instruction::StrictCompare nanResult);
 
@@ -2403,7 +2429,7 @@ namespace jvm
          * @param nanResult Result when either operand is NaN.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* CompareDouble(Instruction::StrictCompare nanResult);
 
@@ -2437,7 +2463,7 @@ namespace jvm
          * @param label Target label to branch to when the condition is true.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* If(Instruction::Compare operation, Label* label);
 
@@ -2471,7 +2497,7 @@ namespace jvm
          * @param label Target label to branch to when the condition is true.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* IfWithCompare(Instruction::Compare operation, Label* label);
 
@@ -2496,7 +2522,7 @@ namespace jvm
          * @param label Target label to branch to when the references are equal.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* IfReferenceEqual(Label* label);
 
@@ -2521,7 +2547,7 @@ namespace jvm
          * @param label Target label to branch to when the references are not equal.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* IfReferenceNotEqual(Label* label);
 
@@ -2536,7 +2562,7 @@ namespace jvm
          * @param label Target label to branch to.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* GoTo(Label* label);
 
@@ -2565,15 +2591,15 @@ namespace jvm
          * @param labels Target labels for keys in range [low, high].
          *               The element labels[i] corresponds to key value (low + i).
          * @note The target labels must be placed into the code stream using @ref AttributeCode::addLabel.
-         * @throws std::invalid_argument If labels.size() != (high - low + 1).
+         * @throws std::invalid_argument If @p low > @p high, labels.size() != (high - low + 1) or a label is null.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
-        [[nodiscard]] Instruction* Switch(int32_t low, int32_t high, Label* defaultLabel,
-                                          const std::vector<Label*>& labels);
+        [[nodiscard]] InstructionSwitch* Switch(int32_t low, int32_t high, Label* defaultLabel,
+                                                const std::vector<Label*>& labels);
 
         /**
-         * @brief Jump to one of several targets based on an integer key (lookupswitch).
+         * @brief Jump to one of several targets based on an integer key (tableswitch or lookupswitch).
          *
          * Pops an integer key from the operand stack and transfers control to the target label associated with the key value.
          * If the key does not match any entry, execution transfers to @p defaultLabel.
@@ -2588,15 +2614,19 @@ namespace jvm
          * ...
          * @endcode
          *
-         * Command: @ref INSTRUCTION_lookupswitch.
+         * Command: @ref INSTRUCTION_tableswitch or @ref INSTRUCTION_lookupswitch, selected with the cost model of
+         * javac: a table, with @p defaultLabel for missing keys, is used unless its size plus three times its
+         * lookup time is larger than those of a lookupswitch, or its key range doesn't fit in
+         * @ref InstructionSwitch::maxTableCases. An empty map gives a lookupswitch.
          *
          * @param defaultLabel Target label when the key does not match any case.
          * @param labels Key-to-label mapping. The map key is the case value and the map value is the target label.
          * @note The target labels must be placed into the code stream using @ref AttributeCode::addLabel.
+         * @throws std::invalid_argument If a label is null or there are too many cases for a method.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
-        [[nodiscard]] Instruction* Switch(Label* defaultLabel, const std::map<int32_t, Label*>& labels);
+        [[nodiscard]] InstructionSwitch* Switch(Label* defaultLabel, const std::map<int32_t, Label*>& labels);
 
 
         /**
@@ -2617,7 +2647,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ireturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnBoolean();
 
@@ -2639,7 +2669,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ireturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnByte();
 
@@ -2661,7 +2691,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ireturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnChar();
 
@@ -2683,7 +2713,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ireturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnShort();
 
@@ -2705,7 +2735,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_ireturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnInt();
 
@@ -2727,7 +2757,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_lreturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          * @note Long values occupy two words on the operand stack (category 2).
          */
         [[nodiscard]] Instruction* ReturnLong();
@@ -2750,7 +2780,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_freturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnFloat();
 
@@ -2772,7 +2802,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_dreturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          * @note Double values occupy two words on the operand stack (category 2).
          */
         [[nodiscard]] Instruction* ReturnDouble();
@@ -2795,7 +2825,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_areturn.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnReference();
 
@@ -2807,7 +2837,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_return.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ReturnVoid();
 
@@ -2830,7 +2860,7 @@ namespace jvm
          *
          * @param field Fieldref constant for a class static field.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* GetStatic(ConstantFieldref* field);
 
@@ -2853,7 +2883,7 @@ namespace jvm
          *
          * @param field Fieldref constant for a class static field.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PutStatic(ConstantFieldref* field);
 
@@ -2876,7 +2906,7 @@ namespace jvm
          *
          * @param field Fieldref constant for a class instance field.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* GetField(ConstantFieldref* field);
 
@@ -2899,7 +2929,7 @@ namespace jvm
          *
          * @param field Fieldref constant for a class instance field.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* PutField(ConstantFieldref* field);
 
@@ -2922,7 +2952,7 @@ namespace jvm
          *
          * @param method Methodref constant for an instance method.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* InvokeVirtual(ConstantMethodref* method);
 
@@ -2946,7 +2976,7 @@ namespace jvm
          *
          * @param method Methodref constant for an instance method.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* InvokeSpecial(ConstantMethodref* method);
 
@@ -2969,7 +2999,7 @@ namespace jvm
          *
          * @param method Methodref constant for a static method.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* InvokeStatic(ConstantMethodref* method);
 
@@ -2992,7 +3022,7 @@ namespace jvm
          *
          * @param method AttributeCode constant for an interface method.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* InvokeInterface(ConstantInterfaceMethodref* method);
 
@@ -3018,7 +3048,7 @@ namespace jvm
          *
          * @param classConstant Class constant for object allocation.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* New(ConstantClass* classConstant);
 
@@ -3042,7 +3072,7 @@ namespace jvm
          *
          * @param type Primitive array element type.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* NewArray(Instruction::Type type);
 
@@ -3066,7 +3096,7 @@ namespace jvm
          *
          * @param classConstant Class constant for array element type.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* NewArray(ConstantClass* classConstant);
 
@@ -3088,7 +3118,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_arraylength.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* ArrayLength();
 
@@ -3110,7 +3140,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_athrow.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* Throw();
 
@@ -3134,7 +3164,7 @@ namespace jvm
          *
          * @param classConstant Class constant for cast target type.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* CheckCast(ConstantClass* classConstant);
 
@@ -3158,7 +3188,7 @@ namespace jvm
          *
          * @param classConstant Class constant for test target type.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* InstanceOf(ConstantClass* classConstant);
 
@@ -3180,7 +3210,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_monitorenter.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MonitorEnter();
 
@@ -3202,7 +3232,7 @@ namespace jvm
          * Command: @ref INSTRUCTION_monitorexit.
          *
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MonitorExit();
 
@@ -3227,7 +3257,7 @@ namespace jvm
          * @param classConstant Class constant for array type.
          * @param dimensions Number of array dimensions.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] Instruction* MultiNewArray(ConstantClass* classConstant, uint8_t dimensions);
 
@@ -3251,7 +3281,7 @@ namespace jvm
          * @param label Target label to branch to when the value is null.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* IfNull(Label* label);
 
@@ -3275,7 +3305,7 @@ namespace jvm
          * @param label Target label to branch to when the value is not null.
          * @note The target label must be placed into the code stream using @ref AttributeCode::addLabel.
          * @return A new instruction for this code attribute.
-         * @note The returned instruction is owned by the caller until it is registered using @ref addInstruction.
+         * @note The returned instruction belongs to the class arena; it is emitted once registered using @ref addInstruction.
          */
         [[nodiscard]] InstructionJump* IfNotNull(Label* label);
 
@@ -3285,7 +3315,7 @@ namespace jvm
          * Add an instruction to the end of the @ref code_ "list of instructions".
          * @param instruction New instruction.
          * @return This instance.
-         * @note Transfers ownership of @p instruction to this @ref AttributeCode instance.
+         * @note @p instruction must be created by this @ref AttributeCode instance.
          */
         AttributeCode& addInstruction(Instruction* instruction);
 
@@ -3352,7 +3382,7 @@ namespace jvm
          *
          * @return A new label instance for this code attribute.
          * @see AttributeCode::addLabel
-         * @note The returned label is owned by the caller until it is registered using @ref addLabel.
+         * @note The returned label belongs to the class arena; it is placed once registered using @ref addLabel.
          */
         Label* CodeLabel();
 
@@ -3374,7 +3404,7 @@ namespace jvm
          *
          * @param label The label to place.
          * @return This instance.
-         * @note Transfers ownership of @p label to this @ref AttributeCode instance.
+         * @note @p label must be created by this @ref AttributeCode instance.
          */
         AttributeCode& addLabel(Label* label);
 
@@ -3448,6 +3478,65 @@ namespace jvm
         }
 
         //endregion
+        // region OPTIMIZATION
+
+        /**
+         * @brief Optimizations done by @ref optimize.
+         *
+         * Each level includes the previous ones.
+         */
+        enum OptLevel : uint8_t
+        {
+            OPT_none = 0, ///< Keep the code as is.
+            OPT_unreachable = 1, ///< Remove unreachable instructions, see @ref internal::DeadCodeEliminator.
+            OPT_jumps = 2, ///< Shorten chains of jumps, see @ref internal::JumpThreader.
+            OPT_peephole = 3, ///< Rewrite short instruction sequences into smaller ones, see @ref internal::PeepholeOptimizer.
+        };
+
+        /**
+         * @brief Rewrite the code into smaller equivalent code.
+         *
+         * Optional: code is finalized as written unless optimized. Branch targets and exception ranges are kept,
+         * labels bound to removed instructions are moved to the instruction that replaces them, or to the next one.
+         * Exception handlers left without protected instructions are removed.
+         *
+         * Jumps are threaded first, so that the @c goto they no longer use are removed as unreachable code.
+         * All of it runs before layout, where fewer and shorter jumps need less widening.
+         *
+         * @param level Optimizations to do.
+         * @return Number of removed bytes, counted before layout: without switch padding and with short jumps.
+         * @throws std::logic_error If the code attribute is already finalized, or if a label used by
+         * an instruction or an exception handler is not bound.
+         */
+        std::size_t optimize(OptLevel level);
+
+        /**
+         * @brief Move regions of the code into private static methods of the class until it fits in a size.
+         *
+         * Optional: for generated methods too large to be JIT-compiled (see @ref MethodSizeLimits::hugeMethodLimit)
+         * or to be encoded at all. A region is a run of basic blocks entered only at its first instruction,
+         * with an empty operand stack there and where it continues, see @ref internal::MethodOutliner.
+         * It is replaced with a call of the new method, which takes the local variables as arguments
+         * and returns the one written by the region and read after it. The largest regions are moved first.
+         *
+         * @code
+         * std::size_t limit = generatedClass.getMethodSizeLimits().hugeMethodLimit;
+         * for (Method* helper : code->outline(limit))
+         * {
+         *     // helpers are finalized with the class like any other method
+         * }
+         * @endcode
+         *
+         * @param maxSize Size to reach, counted before layout: without switch padding and with short jumps.
+         * @return Created methods, with at most @p maxSize bytes of code each. The code may stay above
+         * @p maxSize if no region can be moved.
+         * @throws std::logic_error If the code attribute is already finalized, belongs to an interface,
+         * if the class has no hierarchy (see @ref Class::setClassHierarchy), or if types can't be inferred,
+         * see @ref internal::FrameAnalyzer.
+         */
+        std::vector<Method*> outline(std::size_t maxSize);
+
+        // endregion
         // region FINALIZATION
         /**
          * @brief Check whether the code attribute is finalized.
@@ -3456,15 +3545,76 @@ namespace jvm
          */
         [[nodiscard]] bool isFinalized() const;
 
+        /**
+         * @brief Finalize the code attribute with the analysis of the owning class finalizer.
+         *
+         * @see finalize(ClassFinalizer::Analysis), Class::getFinalizer
+         */
+        void finalize();
+
         /**
          * @brief Finalize the code attribute.
          *
-         * @throws std::logic_error If there are pending labels without a following instruction.
-         * @throws std::runtime_error If the resulting code is too large to fit into JVM limits.
+         * Binds labels and lays out instructions. With @ref ClassFinalizer::Maxs or higher,
+         * also computes @c max_stack and @c max_locals.
          *
-         * @note Safe to call multiple times; subsequent calls have no effect.
+         * With @ref ClassFinalizer::Frames, also computes stack map frames and adds a @ref AttributeStackMapTable,
+         * merging reference types with the @ref ClassHierarchy of the owning class (as @c java/lang/Object
+         * if it has none). The verifier can't check code without frames, so unreachable instructions are then
+         * replaced with a single @c athrow per run, and are excluded from exception handler ranges.
+         *
+         * @param analysis Analysis to do natively.
+         * @throws std::logic_error If there are pending labels without a following instruction,
+         * the operand stack underflows or has different sizes on merging paths,
+         * or the attribute is already finalized with a weaker analysis.
+         * @throws std::runtime_error If the resulting code is too large to fit into JVM limits, or into
+         * the @ref MethodSizeLimits::strictCategory of the owning class. The attribute is then left unfinalized,
+         * so it can be reduced (e.g. with @ref outline) and finalized again.
+         *
+         * @note Safe to call multiple times; subsequent calls with the same or a weaker analysis have no effect.
          */
-        void finalize();
+        void finalize(ClassFinalizer::Analysis analysis);
+
+        /**
+         * @brief Get the maximum depth of the operand stack (in slots) at any point of execution.
+         *
+         * @return Max stack size, 0 if finalized with @ref ClassFinalizer::None.
+         * @throws std::logic_error If called before finalization.
+         */
+        [[nodiscard]] uint16_t getMaxStack() const;
+
+        /**
+         * @brief Get the size of the local variable array, including @c this and method arguments.
+         *
+         * @return Max locals size, 0 if finalized with @ref ClassFinalizer::None.
+         * @throws std::logic_error If called before finalization.
+         */
+        [[nodiscard]] uint16_t getMaxLocals() const;
+
+        /**
+         * @brief Get the packed bytecode: opcodes and operands of all instructions, laid out as in the class file.
+         *
+         * Encoded once by @ref finalize, serialization copies it as is.
+         *
+         * @return Bytecode, valid while the code attribute lives.
+         * @throws std::logic_error If called before finalization.
+         */
+        [[nodiscard]] std::span<const std::byte> getBytecode() const;
+
+        /**
+         * @brief Get the size of the code against the @ref MethodSizeLimits of the owning class.
+         *
+         * @return Report of the owning method.
+         * @throws std::logic_error If called before finalization.
+         */
+        [[nodiscard]] MethodSizeReport getSizeReport() const;
+
+        /**
+         * @brief Get the instructions of the code stream, in order.
+         *
+         * @return Registered instructions; after finalization their offsets match @ref getBytecode.
+         */
+        [[nodiscard]] std::span<Instruction* const> getInstructions() const noexcept;
         // endregion
         // region ATTRIBUTES
         // ToDo operations with code's attributes are not implemented
@@ -3473,11 +3623,13 @@ namespace jvm
         [[nodiscard]] bool isMethodAttribute() const noexcept override { return true; };
 
     protected:
+        using Attribute::writeTo;
+
         /**
          * @pre The attribute must be finalized via @ref finalize.
          * @throws std::logic_error If called before finalization.
          */
-        void writeTo(std::ostream& os) const override;
+        void writeTo(ByteWriter& writer) const override;
 
         /**
          * @pre The attribute must be finalized via @ref finalize.
@@ -3493,22 +3645,173 @@ namespace jvm
          */
         explicit AttributeCode(Method* methodOwner);
 
+        /**
+         * @brief Construct an element of this code in the arena of the owning class.
+         */
+        template <typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            return new(memoryResource_->allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
+
+        /**
+         * @brief Compute @ref maxStack_ and @ref maxLocals_ natively.
+         *
+         * Propagates the operand stack size along all paths from the first instruction and from exception
+         * handler entries (with the exception on the stack), using per-opcode stack changes and the descriptors
+         * of referenced fields and methods. Unreachable instructions do not affect @ref maxStack_.
+         *
+         * @pre Labels are bound.
+         * @throws std::logic_error If the stack underflows or has different sizes on merging paths.
+         */
+        void computeMaxStackAndLocals();
+
+        /**
+         * @brief Constant pool index operand in @ref bytecode_.
+         */
+        struct ConstantFixup
+        {
+            uint32_t offset; ///< Position of the operand.
+            const Constant* constant; ///< Referenced constant.
+            bool isWide; ///< Two-byte operand, otherwise one byte.
+        };
+
+        /**
+         * @brief Branch offset operand in @ref bytecode_.
+         */
+        struct LabelFixup
+        {
+            uint32_t offset; ///< Position of the operand.
+            uint16_t source; ///< Position of the branch instruction, the offset is relative to it.
+            const Label* label; ///< Branch target.
+            bool isWide; ///< Four-byte operand, otherwise two bytes.
+        };
+
+        /**
+         * @brief Set the position of every instruction, widening jumps to targets out of the 2-byte range.
+         *
+         * Widening a jump moves the instructions after it, which may put other jumps out of range,
+         * so the layout is repeated until no jump needs widening. Jumps are never narrowed back,
+         * so it terminates after at most one pass per jump.
+         *
+         * Switches are padded for their positions.
+         *
+         * @param isTentative Layout before unreachable code is replaced: leave room in the jump range for
+         * the padding of switches to grow.
+         * @throws std::runtime_error If the code is larger than 65535 bytes.
+         */
+        void layOutInstructions(bool isTentative = false);
+
+        /**
+         * @brief Remove the exception handlers whose protected range is empty.
+         *
+         * Optimizations leave such handlers when they remove all the instructions of a range.
+         */
+        void removeEmptyExceptionHandlers();
+
+        /**
+         * @brief Get the size of the instructions before layout: without switch padding and with short jumps.
+         */
+        [[nodiscard]] std::size_t getUnlaidSize() const;
+
+        /**
+         * @brief Get the size of the instructions [@p first, @p last) before layout.
+         */
+        [[nodiscard]] std::size_t getUnlaidSize(std::size_t first, std::size_t last) const;
+
+        /**
+         * @brief Move instructions to the end of another code attribute of the same class.
+         *
+         * Labels bound to the moved instructions and the given exception handlers move with them.
+         *
+         * @param target Code attribute of a method of the owning class.
+         * @param first Position of the first moved instruction.
+         * @param last Position after the last moved instruction.
+         * @param handlers Exception handlers of this code to move.
+         */
+        void moveTo(AttributeCode& target, std::size_t first, std::size_t last,
+                    std::span<ExceptionHandler* const> handlers);
+
+        /**
+         * @brief Encode the laid out instructions into @ref bytecode_.
+         *
+         * One pass writes opcodes and immediate operands, leaving constant pool indices and branch offsets
+         * as placeholders recorded in @ref constantFixups_ and @ref labelFixups_; a second pass over
+         * these side tables resolves them.
+         *
+         * @pre Instructions are laid out, constant instructions are updated.
+         * @throws std::out_of_range If a constant index doesn't fit its operand.
+         * @throws std::logic_error If a branch label is not bound.
+         */
+        void encodeBytecode();
+
+        /**
+         * @brief Write the constant pool indices and branch offsets recorded in the side tables.
+         */
+        void resolveFixups();
+
+        /**
+         * @brief Stack map frames computed before the instructions are laid out.
+         */
+        struct StackMap
+        {
+            std::vector<AttributeStackMapTable::VerificationType> initialLocals{}; ///< Locals at method entry.
+            std::vector<AttributeStackMapTable::Frame> frames{}; ///< Frames in code order.
+            bool hasReplacedCode = false; ///< Unreachable code was replaced with @c athrow.
+        };
+
+        /**
+         * @brief Compute stack map frames natively.
+         *
+         * Infers types with @ref internal::FrameAnalyzer, then replaces every run of unreachable
+         * instructions with an @c athrow framed with a @c java/lang/Throwable on the stack: it is never
+         * executed, but the verifier accepts it. Labels bound to removed instructions are moved to the
+         * @c athrow. Exception handlers are split around it and dropped if nothing they protect is reachable.
+         *
+         * @pre Labels are bound, instruction constants are updated.
+         * @param hierarchy Class hierarchy used to merge reference types.
+         * @return Frames to encode after layout.
+         * @throws std::logic_error If types can't be inferred.
+         */
+        [[nodiscard]] StackMap computeStackMap(const ClassHierarchy& hierarchy);
+
+        /**
+         * @brief Get the change of the operand stack size made by an instruction of this code.
+         *
+         * @param instruction Instruction.
+         * @return Stack size change in slots.
+         */
+        [[nodiscard]] int32_t getStackDelta(const Instruction* instruction) const;
+
+        /**
+         * @brief Get the end of the local variable slots accessed by an instruction of this code.
+         *
+         * @param instruction Instruction.
+         * @return Index of the slot after the last accessed one, or 0 if no local variable is accessed.
+         */
+        [[nodiscard]] uint32_t getLocalsEnd(const Instruction* instruction) const;
+
     public:
         [[nodiscard]] std::size_t getByteSize() const override;
 
     private:
+        std::pmr::memory_resource* memoryResource_; ///< Arena of the owning class.
         uint16_t maxStack_ = 0; ///< Max stack size.
         uint16_t maxLocals_ = 0; ///< Max size of local variable array.
         uint16_t instructionsByteSize_ = 0; ///< Size of bytecode instruction array measured in bytes.
         /// Size of exceptions handlers set measured in bytes (exception_table structure).
         uint16_t exceptionsHandlersByteSize_ = 0;
         std::vector<Instruction*> code_{}; ///< Bytecode instructions array.
+        std::pmr::vector<std::byte> bytecode_; ///< Packed code, encoded on finalization.
+        std::pmr::vector<ConstantFixup> constantFixups_; ///< Constant pool operands of @ref bytecode_.
+        std::pmr::vector<LabelFixup> labelFixups_; ///< Branch operands of @ref bytecode_.
         std::set<ExceptionHandler*> exceptionHandlers_{}; ///< Exception handlers set.
         std::set<Attribute*> attributes_{}; ///< Attributes.
 
         std::set<Label*> labelsOnCurrentStep_{}; ///< Set of labels on current step.
 
         bool isFinalized_ = false; ///< Flag of completed attribute initialization.
+        ClassFinalizer::Analysis analysis_ = ClassFinalizer::None; ///< Analysis done on finalization.
         std::set<Label*> allRegisteredLabels_; ///< Registered labels
     };
 } // jvm
@@ -0,0 +1,100 @@
+#ifndef JVM__ATTRIBUTE_STACK_MAP_TABLE_H
+#define JVM__ATTRIBUTE_STACK_MAP_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "attribute.h"
+#include "class-file-element.h"
+
+namespace jvm
+{
+    class AttributeCode;
+    class ConstantClass;
+    class Instruction;
+
+    /**
+     * @brief StackMapTable attribute of a code attribute.
+     *
+     * Holds the types of local variables and operand stack entries at the start of every basic block
+     * that is a jump target, an exception handler or follows an unconditional control transfer.
+     * Frames are created by @ref AttributeCode::finalize and encoded once, in the most compact
+     * form (same, same_locals_1_stack_item, chop, append or full frame) relative to the previous frame.
+     */
+    class AttributeStackMapTable final : public Attribute, public ClassFileElement<AttributeCode>
+    {
+        friend class AttributeCode;
+    public:
+        /**
+         * @brief Verification type of one local variable or operand stack entry.
+         *
+         * Types of @c long and @c double take one entry.
+         */
+        struct VerificationType
+        {
+            /**
+             * @brief Verification type tags, see JVMS §4.7.4.
+             */
+            enum Tag : uint8_t
+            {
+                ITEM_Top = 0,
+                ITEM_Integer = 1,
+                ITEM_Float = 2,
+                ITEM_Double = 3,
+                ITEM_Long = 4,
+                ITEM_Null = 5,
+                ITEM_UninitializedThis = 6,
+                ITEM_Object = 7,
+                ITEM_Uninitialized = 8,
+            };
+
+            Tag tag = ITEM_Top; ///< Type tag.
+            ConstantClass* classConstant = nullptr; ///< Class of an @ref ITEM_Object.
+            const Instruction* newInstruction = nullptr; ///< @c new instruction of an @ref ITEM_Uninitialized.
+
+            bool operator==(const VerificationType&) const = default;
+        };
+
+        /**
+         * @brief Types at the start of an instruction.
+         */
+        struct Frame
+        {
+            const Instruction* instruction = nullptr; ///< First instruction of the basic block.
+            std::vector<VerificationType> locals{}; ///< Local variable types, without trailing tops.
+            std::vector<VerificationType> stack{}; ///< Operand stack types, from bottom to top.
+        };
+
+        /**
+         * @return Number of encoded frames.
+         */
+        [[nodiscard]] uint16_t getNumberOfEntries() const noexcept { return numberOfEntries_; }
+
+        [[nodiscard]] std::size_t getByteSize() const override;
+
+    protected:
+        using Attribute::writeTo;
+        void writeTo(ByteWriter& writer) const override;
+
+        [[nodiscard]] size_t getContentSizeInBytes() const override;
+
+    private:
+        /**
+         * @brief Construct and encode a stack map table.
+         *
+         * @param owner Owning code attribute.
+         * @param initialLocals Local variable types at method entry.
+         * @param frames Frames ordered by instruction offset; instruction offsets must be set.
+         * @throws std::logic_error If frames are not ordered by offset.
+         */
+        AttributeStackMapTable(AttributeCode* owner,
+                               const std::vector<VerificationType>& initialLocals,
+                               const std::vector<Frame>& frames);
+
+        uint16_t numberOfEntries_ = 0; ///< Number of frames.
+        std::vector<std::byte> entries_{}; ///< Encoded frames.
+    };
+} // jvm
+
+#endif //JVM__ATTRIBUTE_STACK_MAP_TABLE_H
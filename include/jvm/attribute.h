@@ -53,7 +53,8 @@ namespace jvm
         [[nodiscard]] virtual bool isCodeAttribute() const noexcept { return false; }
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Serializable::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] size_t getByteSize() const override;
 
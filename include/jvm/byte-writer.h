@@ -0,0 +1,160 @@
+#ifndef JVM__BYTE_WRITER_H
+#define JVM__BYTE_WRITER_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+namespace jvm
+{
+    /**
+     * @brief Contiguous big-endian byte sink used for class-file serialization.
+     *
+     * Works in one of two modes:
+     * - growable: bytes are appended to an internal buffer that grows geometrically;
+     * - fixed: bytes are written in place into a caller-provided @c std::span.
+     *
+     * Multi-byte values are converted to big-endian with a byte swap and stored with a single
+     * unaligned @c memcpy, so writing a u2/u4/u8 costs one bounds check and one store.
+     */
+    class ByteWriter
+    {
+    public:
+        /**
+         * @brief Create a growable writer.
+         *
+         * @param initialCapacity Number of bytes reserved up front.
+         */
+        explicit ByteWriter(std::size_t initialCapacity = 0);
+
+        /**
+         * @brief Create a writer over a caller-provided buffer.
+         *
+         * The buffer is never reallocated.
+         *
+         * @param buffer Destination buffer. Must outlive the writer.
+         */
+        explicit ByteWriter(std::span<std::byte> buffer);
+
+        ByteWriter(const ByteWriter&) = delete;
+        ByteWriter& operator=(const ByteWriter&) = delete;
+
+        void writeBigEndian(uint8_t val) { *reserve(1) = static_cast<std::byte>(val); }
+        void writeBigEndian(int8_t val) { writeBigEndian(static_cast<uint8_t>(val)); }
+        void writeBigEndian(uint16_t val) { store(toBigEndian(val)); }
+        void writeBigEndian(int16_t val) { writeBigEndian(static_cast<uint16_t>(val)); }
+        void writeBigEndian(uint32_t val) { store(toBigEndian(val)); }
+        void writeBigEndian(int32_t val) { writeBigEndian(static_cast<uint32_t>(val)); }
+        void writeBigEndian(uint64_t val) { store(toBigEndian(val)); }
+        void writeBigEndian(int64_t val) { writeBigEndian(static_cast<uint64_t>(val)); }
+        void writeBigEndian(float val) { writeBigEndian(std::bit_cast<uint32_t>(val)); }
+        void writeBigEndian(double val) { writeBigEndian(std::bit_cast<uint64_t>(val)); }
+
+        /**
+         * @brief Write raw bytes as is.
+         *
+         * @param data Source bytes.
+         * @param size Number of bytes to write.
+         */
+        void writeBytes(const void* data, std::size_t size)
+        {
+            if (size != 0)
+            {
+                std::memcpy(reserve(size), data, size);
+            }
+        }
+
+        /**
+         * @return Number of bytes written so far.
+         */
+        [[nodiscard]] std::size_t size() const { return static_cast<std::size_t>(cursor_ - begin_); }
+
+        /**
+         * @return Bytes written so far.
+         */
+        [[nodiscard]] std::span<const std::byte> bytes() const { return {begin_, size()}; }
+
+        /**
+         * @brief Take the written bytes out of a growable writer.
+         *
+         * The writer is left empty and may be reused.
+         *
+         * @return Written bytes.
+         * @throws std::logic_error If the writer works over a caller-provided buffer.
+         */
+        [[nodiscard]] std::vector<std::byte> release();
+
+    private:
+        /**
+         * @brief Reserve @p count bytes at the cursor and advance it.
+         *
+         * @return Pointer to the reserved bytes.
+         * @throws std::out_of_range If a fixed buffer has not enough space left.
+         */
+        std::byte* reserve(std::size_t count)
+        {
+            if (static_cast<std::size_t>(end_ - cursor_) < count)
+            {
+                grow(count);
+            }
+            std::byte* position = cursor_;
+            cursor_ += count;
+            return position;
+        }
+
+        /**
+         * @brief Make room for at least @p count more bytes.
+         */
+        void grow(std::size_t count);
+
+        template <class T>
+        void store(T val)
+        {
+            std::memcpy(reserve(sizeof(T)), &val, sizeof(T));
+        }
+
+        template <class T>
+        static constexpr T toBigEndian(T val)
+        {
+            if constexpr (std::endian::native == std::endian::big)
+            {
+                return val;
+            }
+#if defined(__GNUC__) || defined(__clang__)
+            else if constexpr (sizeof(T) == 2)
+            {
+                return __builtin_bswap16(val);
+            }
+            else if constexpr (sizeof(T) == 4)
+            {
+                return __builtin_bswap32(val);
+            }
+            else
+            {
+                return __builtin_bswap64(val);
+            }
+#else
+            else
+            {
+                T result = 0;
+                for (std::size_t i = 0; i < sizeof(T); ++i)
+                {
+                    result = static_cast<T>(result << 8 | (val >> (i * 8) & 0xFF));
+                }
+                return result;
+            }
+#endif
+        }
+
+        std::vector<std::byte> buffer_{}; ///< Storage of a growable writer.
+        bool isGrowable_ = true; ///< False if the writer works over a caller-provided buffer.
+        std::byte* begin_ = nullptr; ///< Start of the destination buffer.
+        std::byte* cursor_ = nullptr; ///< Next byte to write.
+        std::byte* end_ = nullptr; ///< End of the destination buffer.
+    };
+} // jvm
+
+#endif //JVM__BYTE_WRITER_H
@@ -0,0 +1,122 @@
+#ifndef JVM__CLASS_FINALIZER_H
+#define JVM__CLASS_FINALIZER_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+
+#include "class.h"
+
+namespace jvm
+{
+    /**
+     * @brief Strategy that completes code attributes of written classes.
+     *
+     * A class file needs @c max_stack, @c max_locals and, since Java 6, stack map frames.
+     * A finalizer decides which of them are computed natively when code attributes are finalized
+     * (see @ref getAnalysis) and how the serialized class is post-processed before it is written.
+     *
+     * Built-in strategies, from the cheapest:
+     * | Strategy | Native analysis | Post-processing |
+     * |----------|-----------------|-----------------|
+     * | @ref none | none | none, raw bytes |
+     * | @ref nativeMaxs | max stack and locals | none |
+     * | @ref nativeFrames | max stack and locals, stack map frames | none |
+     * | @ref embeddedJvm | none | @c FixClass in the process-wide JVM, see @ref EmbeddedJvm |
+     * | @ref externalHelperProcess | none | @c FixClass in a pool of @c java processes, see @ref HelperProcessPool |
+     *
+     * A finalizer is selected per class with @ref Class::setFinalizer, or per batch
+     * with @ref Class::writeAll(std::span<const Class* const>, const Class::ClassSink&, const ClassFinalizer&).
+     *
+     * @note Implementations must be thread-safe: one finalizer is shared by many classes.
+     */
+    class ClassFinalizer
+    {
+    public:
+        /**
+         * @brief Code analysis done natively when a code attribute is finalized.
+         *
+         * Each level includes the previous ones.
+         */
+        enum Analysis : uint8_t
+        {
+            None = 0, ///< Only lay out instructions; @c max_stack and @c max_locals are 0.
+            Maxs = 1, ///< Compute @c max_stack and @c max_locals.
+            Frames = 2, ///< Also compute the StackMapTable, using the class hierarchy of the class.
+        };
+
+        virtual ~ClassFinalizer() = default;
+
+        /**
+         * @return Analysis done natively before the class is serialized.
+         */
+        [[nodiscard]] virtual Analysis getAnalysis() const = 0;
+
+        /**
+         * @brief Write a class with code attributes finalized by @ref getAnalysis.
+         *
+         * The default implementation writes the class as is.
+         *
+         * @param classToWrite Class to write.
+         * @param os Output stream.
+         */
+        virtual void write(const Class& classToWrite, std::ostream& os) const;
+
+        /**
+         * @brief Write several classes with code attributes finalized by @ref getAnalysis.
+         *
+         * The default implementation passes each class to @p sink as is.
+         *
+         * @param classes Classes to write.
+         * @param sink Receives each class file, in the order of @p classes.
+         */
+        virtual void writeAll(std::span<const Class* const> classes, const Class::ClassSink& sink) const;
+
+        /**
+         * @brief Write raw class files without any analysis.
+         *
+         * Useful when the classes are post-processed elsewhere, or to measure serialization alone.
+         */
+        [[nodiscard]] static const ClassFinalizer& none();
+
+        /**
+         * @brief Compute @c max_stack and @c max_locals natively, without stack map frames.
+         *
+         * Enough for class files older than Java 6 or when verification is disabled.
+         */
+        [[nodiscard]] static const ClassFinalizer& nativeMaxs();
+
+        /**
+         * @brief Compute @c max_stack, @c max_locals and stack map frames natively.
+         *
+         * Reference types are merged with the class hierarchy of each class
+         * (see @ref Class::setClassHierarchy), or as @c java/lang/Object if it has none.
+         */
+        [[nodiscard]] static const ClassFinalizer& nativeFrames();
+
+        /**
+         * @brief Fix classes with @c FixClass in the process-wide JVM embedded via JNI.
+         *
+         * Batches are fixed in a single JNI call.
+         */
+        [[nodiscard]] static const ClassFinalizer& embeddedJvm();
+
+        /**
+         * @brief Fix classes with @c FixClass in the pool of persistent @c java processes.
+         *
+         * Does not load the JVM into this process, and a crash of a helper JVM only fails the classes
+         * it was fixing. Batches are spread over all processes of the pool.
+         * Requires the @c JAVA_HOME environment variable.
+         */
+        [[nodiscard]] static const ClassFinalizer& externalHelperProcess();
+
+        /**
+         * @brief Get the finalizer used by classes that have none selected.
+         *
+         * @return @ref externalHelperProcess on Windows, @ref embeddedJvm otherwise.
+         */
+        [[nodiscard]] static const ClassFinalizer& platformDefault();
+    };
+} // jvm
+
+#endif //JVM__CLASS_FINALIZER_H
@@ -0,0 +1,60 @@
+#ifndef JVM__CLASS_HIERARCHY_H
+#define JVM__CLASS_HIERARCHY_H
+
+#include <string>
+#include <unordered_map>
+
+namespace jvm
+{
+    /**
+     * @brief Answers subtyping questions needed to compute stack map frames.
+     *
+     * When two execution paths bring different reference types into the same local variable
+     * or stack slot, the frame at the merge point must hold their common superclass.
+     * Classes are usually not loaded while they are generated, so the answer comes from the user.
+     *
+     * @note Implementations must be thread-safe if classes are finalized concurrently.
+     */
+    class ClassHierarchy
+    {
+    public:
+        virtual ~ClassHierarchy() = default;
+
+        /**
+         * @brief Get the most specific common superclass of two classes.
+         *
+         * Interfaces are verified as @c java/lang/Object, so it is always a correct answer for them.
+         *
+         * @param first Internal name of the first class (e.g. "java/lang/String").
+         * @param second Internal name of the second class.
+         * @return Internal name of the common superclass.
+         */
+        [[nodiscard]] virtual std::string getCommonSuperClass(const std::string& first,
+                                                              const std::string& second) const = 0;
+    };
+
+    /**
+     * @brief Class hierarchy built from explicitly declared superclasses.
+     *
+     * Classes that are not declared are treated as direct subclasses of @c java/lang/Object.
+     */
+    class SimpleClassHierarchy final : public ClassHierarchy
+    {
+    public:
+        /**
+         * @brief Declare the superclass of a class.
+         *
+         * @param name Internal name of the class.
+         * @param superName Internal name of its superclass.
+         */
+        void addClass(const std::string& name, const std::string& superName);
+
+        [[nodiscard]] std::string getCommonSuperClass(const std::string& first,
+                                                      const std::string& second) const override;
+
+    private:
+        std::unordered_map<std::string, std::string> superClasses_{}; ///< Superclass by class name.
+    };
+} // jvm
+
+#endif //JVM__CLASS_HIERARCHY_H
@@ -0,0 +1,147 @@
+#ifndef JVM__CLASS_SHARDER_H
+#define JVM__CLASS_SHARDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jvm
+{
+    class Class;
+    class ConstantMethodref;
+    class DescriptorMethod;
+    class Method;
+
+    /**
+     * @brief Spreads the static methods of a generated class over sibling classes, so that no constant pool overflows.
+     *
+     * Methods are created in the last class, called a shard, until its constant pool count reaches
+     * the limit of the sharder; the next method opens a new shard named @c <name>$Shard<N> with the same superclass.
+     * The slots above the limit take the constants of the method being emitted and the ones added by finalization
+     * (attribute names, classes of stack map frames), so the limit must leave room for the largest method.
+     *
+     * Calls between the methods are emitted with @c invokestatic on @ref getMethodref, which refers to the shard
+     * holding the method. A method referenced before it is created is declared in the last shard, where a generator
+     * emitting its methods in call order creates it next. If that shard reached the limit in between, the method
+     * is created in the last shard instead and the declared one forwards the calls to it, for two or three slots.
+     * Shards call each other within their package, so the methods must not be private.
+     *
+     * @code
+     * ClassSharder sharder("gen/Table", "java/lang/Object");
+     * DescriptorMethod rowDescriptor(DescriptorField(Descriptor::Int), {DescriptorField(Descriptor::Int)});
+     * for (std::size_t i = 0; i < rowCount; ++i)
+     * {
+     *     Method* row = sharder.createMethod("row" + std::to_string(i), rowDescriptor);
+     *     AttributeCode* code = row->getCodeAttribute();
+     *     code->LoadInt(0);
+     *     code->InvokeStatic(sharder.getMethodref(*row->getOwner(), "row" + std::to_string(i + 1), rowDescriptor));
+     *     code->ReturnInt();
+     * }
+     * Class::writeAll(sharder.getClasses(), sink);
+     * @endcode
+     */
+    class ClassSharder
+    {
+    public:
+        /**
+         * @brief Called with each new shard, including the first one, e.g. to set its flags, hierarchy or finalizer.
+         */
+        using ShardSetup = std::function<void(Class&)>;
+
+        /**
+         * @brief Default shard limit, leaving 5535 slots for the method being emitted and finalization.
+         */
+        static constexpr uint16_t defaultConstantLimit = 60000;
+
+        /**
+         * @brief Create a sharder with its first shard.
+         *
+         * @param className Internal name of the first shard; the others are named @c <className>$Shard<N>.
+         * @param parentName Internal name of the superclass of all shards.
+         * @param setup Called with each new shard, may be empty.
+         * @param constantLimit Constant pool count from which a shard takes no new method.
+         * @throws std::invalid_argument If @p constantLimit is 0 or above @ref Class::maxConstantPoolCount.
+         */
+        ClassSharder(std::string className, std::string parentName, ShardSetup setup = {},
+                     uint16_t constantLimit = defaultConstantLimit);
+
+        ~ClassSharder();
+
+        ClassSharder(const ClassSharder&) = delete;
+        ClassSharder& operator=(const ClassSharder&) = delete;
+
+        /**
+         * @brief Get a static method of the sharded class, or create it in the last shard.
+         *
+         * A new shard is opened first if the pool of the last one reached the limit. A method declared
+         * by @ref getMethodref is created in its shard if the pool is still below the limit.
+         *
+         * @param name Method name.
+         * @param descriptor Method descriptor.
+         * @return Method with the @c ACC_STATIC flag, owned by its shard.
+         */
+        Method* createMethod(const std::string& name, const DescriptorMethod& descriptor);
+
+        /**
+         * @brief Get a reference to a static method of the sharded class, to be called with @c invokestatic.
+         *
+         * @param caller Class of the call, a shard or any other class; the reference is in its constant pool.
+         * @param name Method name.
+         * @param descriptor Method descriptor.
+         * @return Methodref of the shard holding or declaring the method.
+         */
+        ConstantMethodref* getMethodref(Class& caller, const std::string& name, const DescriptorMethod& descriptor);
+
+        /**
+         * @return Shards, the first one first, e.g. for @ref Class::writeAll.
+         */
+        [[nodiscard]] std::span<const Class* const> getClasses() const noexcept;
+
+        /**
+         * @return Number of shards.
+         */
+        [[nodiscard]] std::size_t getShardCount() const noexcept;
+
+        /**
+         * @param index Shard index, 0 for the first one.
+         * @return Shard.
+         * @throws std::out_of_range If there is no shard @p index.
+         */
+        [[nodiscard]] Class* getShard(std::size_t index) const;
+
+    private:
+        /**
+         * @brief Open a new shard and make it the last one.
+         */
+        void addShard();
+
+        /**
+         * @brief Open a new shard if the pool of the last one reached the limit.
+         *
+         * @return Index of the last shard.
+         */
+        std::size_t getOpenShard();
+
+        /**
+         * @brief Emit the code of a declared method forwarding the calls to the same method of another shard.
+         */
+        void createForwarder(Method& forwarder, std::size_t shard);
+
+        std::string className_; ///< Name of the first shard.
+        std::string parentName_; ///< Superclass of all shards.
+        ShardSetup setup_; ///< Called with each new shard.
+        uint16_t constantLimit_; ///< Constant pool count from which a shard takes no new method.
+        std::vector<std::unique_ptr<Class>> shards_{}; ///< Owned shards.
+        std::vector<const Class*> classes_{}; ///< Shards as exposed by @ref getClasses.
+        std::unordered_map<std::string, std::size_t> methodShards_{}; ///< Shard of each method, by name and descriptor.
+        std::unordered_set<std::string> declaredMethods_{}; ///< Methods referenced but not created yet.
+    };
+} // jvm
+
+#endif //JVM__CLASS_SHARDER_H
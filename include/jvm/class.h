@@ -2,11 +2,16 @@
 #define JVM__CLASS_H
 
 #include <cstdint>
+#include <functional>
+#include <memory_resource>
 #include <set>
 #include <span>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "method-size-limits.h"
 #include "serializable.h"
 
 namespace jvm
@@ -27,6 +32,8 @@ namespace jvm
     class Field;
     class Method;
     class Attribute;
+    class ClassHierarchy;
+    class ClassFinalizer;
     class Descriptor;
     class DescriptorField;
     class DescriptorMethod;
@@ -58,6 +65,11 @@ namespace jvm
         static MajorVersion majorVersion;
 
     public:
+        /**
+         * @brief Largest @c constant_pool_count of a class file, the field being a u2.
+         */
+        static constexpr uint16_t maxConstantPoolCount = UINT16_MAX;
+
         enum AccessFlag
         {
             ACC_PUBLIC = 0x0001, // Declared public; may be accessed from outside its package.
@@ -71,7 +83,29 @@ namespace jvm
             ACC_MODULE = 0x8000, // Is a module, not a class or interface.
         };
 
-        Class(const std::string& className, const std::string& parentName);
+        /**
+         * @brief Create a class.
+         *
+         * All elements of the class (constants, fields, methods, code attributes, instructions, labels and
+         * exception handlers) are allocated in a monotonic arena owned by the class: creating one is a pointer
+         * bump, and the memory is released at once when the class is destroyed.
+         *
+         * @param className Internal name of the class.
+         * @param parentName Internal name of the superclass.
+         * @param upstream Memory resource the arena takes its blocks from. Not owned, must outlive the class.
+         */
+        Class(const std::string& className, const std::string& parentName,
+              std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+
+        /**
+         * @brief Destroy the class and all its elements.
+         */
+        ~Class() override;
+
+        /**
+         * @return Arena owning the elements of this class. It may be used for data sharing the class lifetime.
+         */
+        [[nodiscard]] std::pmr::memory_resource* getMemoryResource() noexcept;
 
         //region GET OR CREATE CLASS CONSTANT
         /**
@@ -500,6 +534,15 @@ namespace jvm
 
         std::span<Constant*> constants();
 
+        /**
+         * @brief Get the @c constant_pool_count of the class file: the slots used so far plus one.
+         *
+         * @c long and @c double constants take two slots. The count is at most @ref maxConstantPoolCount.
+         *
+         * @return Constant pool count.
+         */
+        [[nodiscard]] uint16_t getConstantPoolCount() const noexcept;
+
         /**
          * Add access flag to class.
          * @param flag Access flag.
@@ -512,23 +555,200 @@ namespace jvm
          */
         void removeFlag(AccessFlag flag);
 
+        /**
+         * @return Internal name of this class (e.g. "java/lang/String").
+         */
+        [[nodiscard]] std::string getName() const;
+
+        /**
+         * @brief Set the class hierarchy used to compute stack map frames natively.
+         *
+         * Used by finalizers with @ref ClassFinalizer::Frames analysis. Selecting a hierarchy also makes
+         * @ref ClassFinalizer::nativeFrames the default finalizer of the class, see @ref getFinalizer.
+         *
+         * @param hierarchy Class hierarchy, or @c nullptr. Not owned, must outlive the class.
+         * @note Must be set before code attributes are finalized.
+         */
+        void setClassHierarchy(const ClassHierarchy* hierarchy);
+
+        /**
+         * @return Class hierarchy used to compute stack map frames, or @c nullptr.
+         */
+        [[nodiscard]] const ClassHierarchy* getClassHierarchy() const;
+
+        /**
+         * @brief Select how code attributes are completed when the class is written.
+         *
+         * @param finalizer Finalizer, or @c nullptr for the default. Not owned, must outlive the class.
+         * @note Must be set before code attributes are finalized.
+         */
+        void setFinalizer(const ClassFinalizer* finalizer);
+
+        /**
+         * @return Selected finalizer; if none is selected, @ref ClassFinalizer::nativeFrames when a class
+         * hierarchy is set and @ref ClassFinalizer::platformDefault otherwise.
+         */
+        [[nodiscard]] const ClassFinalizer& getFinalizer() const;
+
+        /**
+         * @brief Set the JIT compiler limits that method sizes are reported and checked against.
+         *
+         * @param limits Limits, copied.
+         * @note Must be set before code attributes are finalized to be checked.
+         */
+        void setMethodSizeLimits(const MethodSizeLimits& limits);
+
+        /**
+         * @return JIT compiler limits of method sizes, the HotSpot defaults unless set.
+         */
+        [[nodiscard]] const MethodSizeLimits& getMethodSizeLimits() const noexcept;
+
+        /**
+         * @brief Report the code size of all methods against @ref getMethodSizeLimits.
+         *
+         * Finalizes code attributes with the analysis of @ref getFinalizer first.
+         *
+         * @return Summary of the methods with code.
+         * @throws std::runtime_error If the code of a method is above @ref MethodSizeLimits::strictCategory.
+         */
+        [[nodiscard]] MethodSizeSummary getMethodSizeSummary() const;
+
+        /**
+         * @brief Write the class file to a stream.
+         *
+         * Finalizes code attributes with the analysis of @ref getFinalizer and writes the class through it.
+         *
+         * @param os Output stream.
+         */
         void writeTo(std::ostream& os) const override;
 
+        /**
+         * @brief Write the class file structure as is, without fixing code attributes.
+         *
+         * @param writer Byte writer.
+         */
+        void writeTo(ByteWriter& writer) const override;
+
         /**
          * @return Access flags set.
          */
         [[nodiscard]] const std::set<AccessFlag>* getAccessFlags() const;
 
+        /**
+         * @brief Get the exact size of the class file structure written by @ref writeTo(ByteWriter&) const.
+         *
+         * The constant pool size is tracked incrementally, so the cost does not depend on the pool size.
+         *
+         * @note Finalizes code attributes of all methods.
+         * @return Size in bytes.
+         */
         [[nodiscard]] std::size_t getByteSize() const override;
 
+        /**
+         * @brief Write the class file structure in place into a caller-provided buffer.
+         *
+         * Code attributes are not fixed, see @ref writeTo(ByteWriter&) const.
+         *
+         * @param buffer Destination buffer of at least @ref getByteSize bytes.
+         * @return Number of bytes written.
+         * @throws std::out_of_range If the buffer is too small.
+         */
+        std::size_t serializeInto(std::span<std::byte> buffer) const;
+
+        /**
+         * @brief Write the class file structure into a buffer allocated once at the exact size.
+         *
+         * Code attributes are not fixed, see @ref writeTo(ByteWriter&) const.
+         *
+         * @return Class file bytes.
+         */
+        [[nodiscard]] std::vector<std::byte> toBytes() const;
+
+        /**
+         * @brief Called by @ref writeAll with a class and its fixed class file.
+         *
+         * The bytes are valid only during the call.
+         */
+        using ClassSink = std::function<void(const Class&, std::span<const std::byte>)>;
+
+        /**
+         * @brief Write several class files, fixing all of them at once.
+         *
+         * Classes sharing a finalizer are written in a single batch, e.g. the embedded JVM fixes
+         * them in one JNI call instead of a round trip and a pair of Java arrays per class.
+         * Batches are written in the order of their first class.
+         *
+         * @param classes Classes to write.
+         * @param sink Receives each fixed class file, batch by batch, in the order of @p classes within a batch.
+         */
+        static void writeAll(std::span<const Class* const> classes, const ClassSink& sink);
+
+        /**
+         * @brief Write several class files with one finalizer, regardless of the ones selected per class.
+         *
+         * @param classes Classes to write.
+         * @param sink Receives each fixed class file, in the order of @p classes.
+         * @param finalizer Finalizer of the batch.
+         */
+        static void writeAll(std::span<const Class* const> classes, const ClassSink& sink,
+                             const ClassFinalizer& finalizer);
+
     private:
+        /**
+         * @brief Lookup key of a non-UTF-8 constant pool entry.
+         *
+         * Combines the constant tag with its payload: the numeric bit pattern for Integer/Float/Long/Double,
+         * or the constant pool indices of the referenced entries for Class, String, NameAndType and member
+         * reference constants.
+         */
+        struct ConstantKey
+        {
+            uint8_t tag; ///< Constant tag.
+            uint64_t value; ///< Constant payload.
+
+            bool operator==(const ConstantKey&) const = default;
+        };
+
+        /**
+         * @brief Hash function for @ref ConstantKey.
+         */
+        struct ConstantKeyHash
+        {
+            std::size_t operator()(const ConstantKey& key) const noexcept;
+        };
+
         /**
          * @brief Add a constant to the constant pool.
-         * Add a constant to constant pool and set index to the constant.
+         * Add a constant to constant pool, set index to the constant and register it in the lookup index.
          * @param constant New constant.
+         * @throws std::length_error If the constant doesn't fit in the pool; it is destroyed.
          */
         void addNewConstant(Constant* constant);
 
+        /**
+         * @brief Find a non-UTF-8 constant in the lookup index.
+         * @param key Constant key.
+         * @return Existing constant or @c nullptr.
+         */
+        [[nodiscard]] Constant* findConstant(const ConstantKey& key) const;
+
+        /**
+         * @brief Build a key of a constant that references two other constant pool entries.
+         * @param tag Constant tag.
+         * @param firstIndex Index of the first referenced entry.
+         * @param secondIndex Index of the second referenced entry.
+         * @return Constant key.
+         */
+        static ConstantKey makeConstantKey(uint8_t tag, uint16_t firstIndex, uint16_t secondIndex);
+
+        /**
+         * @brief Build a key of an existing non-UTF-8 constant.
+         * @param constant Constant.
+         * @return Constant key.
+         * @throws std::invalid_argument If constants with this tag are not supported.
+         */
+        static ConstantKey makeConstantKey(const Constant* constant);
+
         /**
          * @brief Validates JVM class access flags for logical consistency.
          *
@@ -555,15 +775,34 @@ namespace jvm
         static void validateFlags(uint16_t flags);
 
         /**
-         * Fix class (code attributes) using java project.
-         * @note Run JVM in this method.
-         * @param os Output stream.
-         * @param data @c Class in binary format.
+         * @brief Finalize code attributes of all methods not finalized yet with the analysis of @ref getFinalizer.
+         *
+         * Finalization may add constants (e.g. classes of stack map frames),
+         * so it must be done before the constant pool is sized or written.
+         * Code already finalized, e.g. by the finalizer of a @ref writeAll batch, is kept whatever its analysis.
          */
-        static void fixClassBinary(std::ostream& os, const std::span<const unsigned char>& data);
+        void finalizeMethods() const;
+
+        /**
+         * @brief Finalize code attributes of all methods with the analysis of @p finalizer.
+         */
+        void finalizeMethods(const ClassFinalizer& finalizer) const;
+
+        /**
+         * @brief Construct an element of this class in its arena.
+         */
+        template <typename T, typename... Args>
+        T* create(Args&&... args)
+        {
+            return new(arena_.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        }
 
+        std::pmr::monotonic_buffer_resource arena_; ///< Memory of all elements, declared first to be released last.
         std::vector<Constant*> constants_{};
         uint16_t nextCpIndex = 1; // 0 index is not available for writing
+        std::size_t constantsByteSize_ = 0; ///< Size of all constant pool entries in bytes.
+        std::unordered_map<std::string, ConstantUtf8Info*> utf8Constants_{}; ///< UTF-8 constants by value.
+        std::unordered_map<ConstantKey, Constant*, ConstantKeyHash> constantsIndex_{}; ///< Other constants by key.
         std::set<AccessFlag> accessFlags_{};
         Constant* thisClassConstant_ = nullptr;
         Constant* superClassConstant_ = nullptr;
@@ -571,6 +810,9 @@ namespace jvm
         std::set<Field*> fields_;
         std::set<Method*> methods_;
         std::set<Attribute*> attributes_;
+        const ClassHierarchy* classHierarchy_ = nullptr; ///< Class hierarchy for stack map frames, not owned.
+        const ClassFinalizer* finalizer_ = nullptr; ///< Selected finalizer, not owned; @c nullptr for the default.
+        MethodSizeLimits methodSizeLimits_{}; ///< JIT compiler limits of method sizes.
     };
 }
 #endif //JVM__CLASS_H
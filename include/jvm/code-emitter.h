@@ -0,0 +1,432 @@
+#ifndef JVM__CODE_EMITTER_H
+#define JVM__CODE_EMITTER_H
+
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "attribute.h"
+#include "class-file-element.h"
+#include "class-finalizer.h"
+#include "instruction.h"
+
+namespace jvm
+{
+    class ConstantClass;
+    class ConstantFieldref;
+    class ConstantInterfaceMethodref;
+    class ConstantMethodref;
+    class Method;
+
+    /**
+     * @brief Code attribute written while instructions are emitted.
+     *
+     * A streaming alternative to @ref AttributeCode for generators that never inspect or rewrite their code:
+     * every emit call appends the opcode and its operands straight into a byte buffer, so no instruction
+     * objects are created and a method body is laid out in a single pass.
+     *
+     * - Constant pool indices are written immediately, and the shortest encoding is selected on the spot
+     *   (@c iconst_n, @c bipush, @c sipush or @c ldc for integers, @c xload_n for locals, @c wide for large
+     *   local indices).
+     * - Jumps to bound labels are resolved immediately. Jumps to labels bound later are recorded in a patch
+     *   list of the label and written when it is bound.
+     * - @c max_stack and @c max_locals are tracked while emitting, whatever the finalizer of the class.
+     *   Every label has a single stack size, set by the first jump to it or by its binding; code following
+     *   an unconditional transfer of control is entered only through labels, with an empty stack if no jump
+     *   reached the label yet.
+     *
+     * Stack map frames are not computed. Code with jumps or exception handlers therefore needs
+     * a JVM finalizer (@ref ClassFinalizer::embeddedJvm or @ref ClassFinalizer::externalHelperProcess)
+     * or a class version without frames.
+     *
+     * The emitter is created by @ref Method::getCodeEmitter, lives in the arena of the owning @ref Class
+     * and excludes the @ref AttributeCode of the same method.
+     * @code
+     * auto& code = *method->getCodeEmitter();
+     * auto loop = code.newLabel();
+     * code.emitPushInt(0).emitLocal(Instruction::INSTRUCTION_istore, 1)
+     *     .bind(loop)
+     *     .emitIncrement(1, 1)
+     *     .emitLocal(Instruction::INSTRUCTION_iload, 1)
+     *     .emitPushInt(100)
+     *     .emitJump(Instruction::INSTRUCTION_if_icmplt, loop)
+     *     .emit(Instruction::INSTRUCTION_return);
+     * @endcode
+     */
+    class CodeEmitter final : public Attribute, public ClassFileElement<Method>
+    {
+        friend class Method;
+
+    public:
+        /**
+         * @brief Position in the code of a @ref CodeEmitter, created by @ref newLabel.
+         *
+         * A plain handle: copy it freely. It must only be used with the emitter that created it.
+         */
+        class Label
+        {
+            friend class CodeEmitter;
+
+        public:
+            Label() = default;
+
+        private:
+            explicit Label(uint32_t id) : id_(id)
+            {
+            }
+
+            uint32_t id_ = UINT32_MAX; ///< Index in the labels of the emitter.
+        };
+
+        ~CodeEmitter() override = default;
+
+        // region LABELS
+        /**
+         * @brief Create a new label, not bound to a position yet.
+         *
+         * @return Label of this emitter.
+         */
+        [[nodiscard]] Label newLabel();
+
+        /**
+         * @brief Bind a label to the current position and resolve the jumps emitted to it so far.
+         *
+         * @param label Label created by @ref newLabel.
+         * @return This instance.
+         * @throws std::logic_error If the label is already bound, or the stack size differs from the one
+         * of the jumps to the label.
+         * @throws std::out_of_range If a jump offset doesn't fit its operand.
+         */
+        CodeEmitter& bind(Label label);
+        // endregion
+
+        // region INSTRUCTIONS
+        /**
+         * @brief Emit an instruction without operands, such as @c iadd, @c dup, @c athrow or @c return.
+         *
+         * @param command Instruction opcode.
+         * @return This instance.
+         * @throws std::invalid_argument If the instruction has operands.
+         * @throws std::logic_error If the operand stack underflows.
+         */
+        CodeEmitter& emit(Instruction::Command command);
+
+        /**
+         * @brief Push an @b integer value with the shortest instruction.
+         *
+         * Emits @c iconst_n, @c bipush, @c sipush, or @c ldc / @c ldc_w with a new @ref ConstantInteger
+         * if needed.
+         *
+         * @param value Integer value.
+         * @return This instance.
+         */
+        CodeEmitter& emitPushInt(int32_t value);
+
+        /**
+         * @brief Push a @b long value with the shortest instruction.
+         *
+         * Emits @c lconst_0, @c lconst_1, or @c ldc2_w with a new @ref ConstantLong if needed.
+         *
+         * @param value Long value.
+         * @return This instance.
+         */
+        CodeEmitter& emitPushLong(int64_t value);
+
+        /**
+         * @brief Push a constant from the constant pool.
+         *
+         * Emits @c ldc2_w for @c long and @c double constants, otherwise @c ldc or @c ldc_w depending on the
+         * constant index.
+         *
+         * @param constant Loadable constant of the owning class.
+         * @return This instance.
+         * @throws std::invalid_argument If the constant can't be loaded or belongs to another class.
+         */
+        CodeEmitter& emitLdc(Constant* constant);
+
+        /**
+         * @brief Emit a load or store of a local variable with the shortest encoding.
+         *
+         * Emits @c xload_n / @c xstore_n for indices up to 3, and a @c wide instruction for indices above 255.
+         *
+         * @param command One of @c iload, @c lload, @c fload, @c dload, @c aload, @c istore, @c lstore,
+         * @c fstore, @c dstore or @c astore.
+         * @param index Local variable index.
+         * @return This instance.
+         * @throws std::invalid_argument If @p command is not a load or store with an index operand.
+         */
+        CodeEmitter& emitLocal(Instruction::Command command, uint16_t index);
+
+        /**
+         * @brief Increment a local @b integer variable, as @c iinc or @c wide @c iinc.
+         *
+         * @param index Local variable index.
+         * @param value Increment.
+         * @return This instance.
+         */
+        CodeEmitter& emitIncrement(uint16_t index, int16_t value);
+
+        /**
+         * @brief Emit @c newarray for a primitive element type.
+         *
+         * @param type Element type.
+         * @return This instance.
+         */
+        CodeEmitter& emitNewArray(Instruction::Type type);
+
+        /**
+         * @brief Emit an instruction with a class operand.
+         *
+         * @param command One of @c new, @c anewarray, @c checkcast or @c instanceof.
+         * @param classConstant Class constant of the owning class.
+         * @return This instance.
+         * @throws std::invalid_argument If @p command has no class operand or the constant belongs to another class.
+         */
+        CodeEmitter& emitType(Instruction::Command command, ConstantClass* classConstant);
+
+        /**
+         * @brief Emit @c multianewarray.
+         *
+         * @param classConstant Array class constant of the owning class.
+         * @param dimensions Number of dimensions to create, at least 1.
+         * @return This instance.
+         * @throws std::invalid_argument If @p dimensions is 0 or the constant belongs to another class.
+         */
+        CodeEmitter& emitMultiNewArray(ConstantClass* classConstant, uint8_t dimensions);
+
+        /**
+         * @brief Emit a field access.
+         *
+         * @param command One of @c getstatic, @c putstatic, @c getfield or @c putfield.
+         * @param field Field reference of the owning class.
+         * @return This instance.
+         * @throws std::invalid_argument If @p command doesn't access a field or the constant belongs to another class.
+         */
+        CodeEmitter& emitField(Instruction::Command command, ConstantFieldref* field);
+
+        /**
+         * @brief Emit an invocation of a class method.
+         *
+         * @param command One of @c invokevirtual, @c invokespecial or @c invokestatic.
+         * @param method Method reference of the owning class.
+         * @return This instance.
+         * @throws std::invalid_argument If @p command is not one of the above or the constant belongs to another class.
+         */
+        CodeEmitter& emitInvoke(Instruction::Command command, ConstantMethodref* method);
+
+        /**
+         * @brief Emit an invocation of an interface method.
+         *
+         * The @c count operand of @c invokeinterface is computed from the descriptor.
+         *
+         * @param command One of @c invokeinterface, @c invokespecial or @c invokestatic.
+         * @param method Interface method reference of the owning class.
+         * @return This instance.
+         * @throws std::invalid_argument If @p command is not one of the above or the constant belongs to another class.
+         */
+        CodeEmitter& emitInvoke(Instruction::Command command, ConstantInterfaceMethodref* method);
+
+        /**
+         * @brief Emit a jump to a label.
+         *
+         * The offset is written immediately if the label is bound, otherwise when it is.
+         *
+         * @param command Conditional jump, @c goto or @c goto_w.
+         * @param target Label of this emitter.
+         * @return This instance.
+         * @throws std::invalid_argument If @p command is not a jump, or is a @c jsr.
+         * @throws std::logic_error If the stack size differs from the one of the label.
+         * @throws std::out_of_range If the offset to a bound label doesn't fit the operand.
+         */
+        CodeEmitter& emitJump(Instruction::Command command, Label target);
+        // endregion
+
+        // region EXCEPTION HANDLER
+        /**
+         * @brief Register an exception_table entry.
+         *
+         * The handler is entered with the exception on the stack, so register it before @p handler is bound.
+         *
+         * @param start Label of the first protected instruction.
+         * @param end Label after the last protected instruction (end-exclusive).
+         * @param handler Label of the handler.
+         * @param catchClass Exception class to catch, @c nullptr to catch any throwable.
+         * @return This instance.
+         * @throws std::logic_error If @p handler is already bound or reached by a jump.
+         */
+        CodeEmitter& addTryCatch(Label start, Label end, Label handler, ConstantClass* catchClass = nullptr);
+        // endregion
+
+        // region FINALIZATION
+        /**
+         * @brief Override the tracked @c max_stack and @c max_locals.
+         *
+         * @param maxStack Max stack size.
+         * @param maxLocals Max locals size.
+         * @return This instance.
+         */
+        CodeEmitter& setMaxs(uint16_t maxStack, uint16_t maxLocals);
+
+        /**
+         * @brief Check whether the code is finalized.
+         *
+         * @return @c true if finalized; otherwise @c false.
+         */
+        [[nodiscard]] bool isFinalized() const noexcept { return isFinalized_; }
+
+        /**
+         * @brief Finalize the code with the analysis of the owning class finalizer.
+         *
+         * @see finalize(ClassFinalizer::Analysis), Class::getFinalizer
+         */
+        void finalize();
+
+        /**
+         * @brief Finalize the code: check that every label is bound and the code fits JVM limits.
+         *
+         * @param analysis Analysis requested by the class finalizer. Max stack and locals are always known;
+         * @ref ClassFinalizer::Frames is only supported for code without jumps and exception handlers.
+         * @throws std::logic_error If the code is empty, a used label is not bound,
+         * or frames are requested for code that needs them.
+         * @throws std::runtime_error If the code or its max locals exceed JVM limits.
+         *
+         * @note Safe to call multiple times. No instruction can be emitted after finalization.
+         */
+        void finalize(ClassFinalizer::Analysis analysis);
+
+        /**
+         * @return Max stack size tracked so far, or set by @ref setMaxs.
+         */
+        [[nodiscard]] uint16_t getMaxStack() const;
+
+        /**
+         * @return Max locals size, including @c this and method arguments, or set by @ref setMaxs.
+         */
+        [[nodiscard]] uint16_t getMaxLocals() const;
+
+        /**
+         * @return Bytecode emitted so far; jumps to unbound labels have a zero offset.
+         */
+        [[nodiscard]] std::span<const std::byte> getBytecode() const noexcept;
+        // endregion
+
+        [[nodiscard]] bool isMethodAttribute() const noexcept override { return true; }
+
+        [[nodiscard]] std::size_t getByteSize() const override;
+
+    protected:
+        using Attribute::writeTo;
+
+        /**
+         * @pre The code must be finalized via @ref finalize.
+         * @throws std::logic_error If called before finalization.
+         */
+        void writeTo(ByteWriter& writer) const override;
+
+        /**
+         * @pre The code must be finalized via @ref finalize.
+         * @throws std::logic_error If called before finalization.
+         */
+        [[nodiscard]] size_t getContentSizeInBytes() const override;
+
+    private:
+        /// Stack size of unreachable code and of labels that are not reached yet.
+        static constexpr int32_t unknownStack = -1;
+
+        /**
+         * @brief Construct an emitter allocating from the arena of the owning class.
+         *
+         * @param methodOwner Owning method.
+         */
+        explicit CodeEmitter(Method* methodOwner);
+
+        /**
+         * @brief Position and stack size of a label, and the jumps waiting for it.
+         */
+        struct LabelState
+        {
+            int32_t offset = -1; ///< Bound position, -1 if not bound.
+            int32_t stack = unknownStack; ///< Stack size at the label.
+            uint32_t firstPatch = UINT32_MAX; ///< First jump waiting for the label in @ref patches_.
+        };
+
+        /**
+         * @brief Jump operand waiting for its label to be bound.
+         */
+        struct Patch
+        {
+            uint32_t offset; ///< Position of the operand.
+            uint32_t source; ///< Position of the jump instruction, the offset is relative to it.
+            bool isWide; ///< Four-byte operand, otherwise two bytes.
+            uint32_t next; ///< Next jump waiting for the same label.
+        };
+
+        /**
+         * @brief Registered exception_table entry.
+         */
+        struct Handler
+        {
+            Label start; ///< First protected instruction.
+            Label end; ///< End of the protected range.
+            Label handler; ///< Handler entry.
+            const ConstantClass* catchClass; ///< Caught class, @c nullptr for any.
+        };
+
+        /**
+         * @brief Append an opcode and apply its stack change.
+         *
+         * @throws std::logic_error If finalized or the operand stack underflows.
+         */
+        void writeOpcode(Instruction::Command command, int32_t stackDelta);
+
+        void writeU1(uint8_t value);
+
+        void writeU2(uint16_t value);
+
+        void writeU4(uint32_t value);
+
+        /**
+         * @brief Check that a constant belongs to the owning class, before anything is written.
+         *
+         * @throws std::invalid_argument If the constant belongs to another class.
+         */
+        void checkConstant(const Constant* constant) const;
+
+        /**
+         * @brief Get the state of a label of this emitter.
+         *
+         * @throws std::invalid_argument If the label was not created by this emitter.
+         */
+        LabelState& getLabelState(Label label);
+
+        /**
+         * @brief Set the stack size at a label, or check it against the known one.
+         *
+         * @throws std::logic_error If it differs from the known one.
+         */
+        static void mergeStack(LabelState& state, int32_t stack);
+
+        /**
+         * @brief Write a jump offset into the bytecode.
+         *
+         * @throws std::out_of_range If the offset doesn't fit a two-byte operand.
+         */
+        void writeJumpOffset(uint32_t offset, uint32_t source, bool isWide, int32_t target);
+
+        std::pmr::memory_resource* memoryResource_; ///< Arena of the owning class.
+        std::pmr::vector<std::byte> bytecode_; ///< Emitted code.
+        std::pmr::vector<LabelState> labels_; ///< Labels by id.
+        std::pmr::vector<Patch> patches_; ///< Jumps to labels not bound when emitted.
+        std::pmr::vector<Handler> handlers_; ///< Exception table.
+        int32_t stack_ = 0; ///< Current stack size, @ref unknownStack in unreachable code.
+        uint16_t maxStack_ = 0; ///< Max stack size so far.
+        uint32_t localsEnd_ = 0; ///< End of the local variable slots accessed so far.
+        bool hasJumps_ = false; ///< Jumps were emitted.
+        bool isMaxsSet_ = false; ///< Max stack and locals are set by @ref setMaxs.
+        uint16_t maxLocals_ = 0; ///< Max locals set by @ref setMaxs.
+        bool isFinalized_ = false; ///< No more instructions can be emitted.
+    };
+} // jvm
+
+#endif //JVM__CODE_EMITTER_H
@@ -16,7 +16,8 @@ namespace jvm
         [[nodiscard]] float getValue() const;
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Constant::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
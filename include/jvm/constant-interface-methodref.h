@@ -24,7 +24,8 @@ namespace jvm
         [[nodiscard]] ConstantNameAndType* getNameAndType() const;
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Constant::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
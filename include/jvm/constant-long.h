@@ -21,7 +21,8 @@ namespace jvm
         [[nodiscard]] uint16_t getOccupiedSlots() const override;
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Constant::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
@@ -26,7 +26,8 @@ namespace jvm
         [[nodiscard]] ConstantUtf8Info* getDescriptor() const;
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Constant::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
@@ -20,7 +20,8 @@ namespace jvm
         [[nodiscard]] ConstantUtf8Info* getString();
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Constant::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
@@ -30,7 +30,8 @@ namespace jvm
         ConstantUtf8Info(std::string string, Class* classOwner);
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Constant::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
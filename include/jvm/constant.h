@@ -63,7 +63,8 @@ namespace jvm
          */
         explicit Constant(Tag tag, Class* classOwner);
 
-        void writeTo(std::ostream& os) const override;
+        using Serializable::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override { return 1; };
 
@@ -0,0 +1,129 @@
+#ifndef JVM__CONTROL_FLOW_GRAPH_H
+#define JVM__CONTROL_FLOW_GRAPH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jvm
+{
+    class AttributeCode;
+
+    /**
+     * @brief Basic blocks of a code attribute and the edges between them.
+     *
+     * A block is a run of instructions entered only at its first one and left only after its last one.
+     * Blocks start at the first instruction, at jump and switch targets, at exception range boundaries and
+     * handlers, and after jumps, switches, returns and @c athrow.
+     *
+     * Edges are stored in contiguous arrays indexed by block:
+     * - normal successors: jump and switch targets, and the next block unless the last instruction
+     *   never falls through. A @c jsr continues at its target and after itself; a @c ret has none;
+     * - exception successors: handlers of the ranges covering the block, in exception table order;
+     * - predecessors: the blocks having the block as a normal or exception successor.
+     *
+     * The graph is a snapshot: it is built once and shared by analyses as long as the code is not changed.
+     *
+     * @code
+     * ControlFlowGraph graph(*code);
+     * for (auto block : graph.getReversePostorder())
+     * {
+     *     for (auto successor : graph.getSuccessors(block)) { ... }
+     * }
+     * @endcode
+     */
+    class ControlFlowGraph
+    {
+    public:
+        /**
+         * @brief Range of instruction positions, as indices in @ref AttributeCode::getInstructions.
+         */
+        struct Block
+        {
+            uint32_t start; ///< Position of the first instruction.
+            uint32_t end; ///< Position after the last instruction.
+        };
+
+        /**
+         * @brief Build the graph of a code attribute, finalized or not.
+         *
+         * @param code Code attribute. Only read while building.
+         * @throws std::logic_error If a target label or an exception range is not bound to an instruction
+         * of @p code.
+         */
+        explicit ControlFlowGraph(const AttributeCode& code);
+
+        /**
+         * @return Blocks in code order. Block 0 is the entry, if the code is not empty.
+         */
+        [[nodiscard]] std::span<const Block> getBlocks() const noexcept
+        {
+            return blocks_;
+        }
+
+        /**
+         * @return Blocks reached from the end of @p block, in ascending order.
+         */
+        [[nodiscard]] std::span<const uint32_t> getSuccessors(uint32_t block) const;
+
+        /**
+         * @return Handler blocks of the exception ranges covering @p block.
+         */
+        [[nodiscard]] std::span<const uint32_t> getExceptionSuccessors(uint32_t block) const;
+
+        /**
+         * @return Blocks with a normal or exception edge to @p block, in ascending order.
+         */
+        [[nodiscard]] std::span<const uint32_t> getPredecessors(uint32_t block) const;
+
+        /**
+         * @brief Get the reachable blocks, each one before its successors except along back edges.
+         *
+         * @return Blocks reachable from the entry by normal and exception edges, in reverse postorder.
+         */
+        [[nodiscard]] std::span<const uint32_t> getReversePostorder() const noexcept
+        {
+            return reversePostorder_;
+        }
+
+        /**
+         * @brief Check whether a block is reachable from the entry.
+         */
+        [[nodiscard]] bool isReachable(uint32_t block) const;
+
+        /**
+         * @brief Get the block containing an instruction.
+         *
+         * @param position Position of the instruction in @ref AttributeCode::getInstructions.
+         * @throws std::out_of_range If @p position is not in the code.
+         */
+        [[nodiscard]] uint32_t getBlockAt(std::size_t position) const;
+
+    private:
+        /**
+         * @brief Fill the predecessors from the normal and exception successors.
+         */
+        void buildPredecessors();
+
+        /**
+         * @brief Order the blocks reachable from the entry by a depth-first search.
+         */
+        void buildReversePostorder();
+
+        std::vector<Block> blocks_{}; ///< Blocks in code order.
+        std::vector<uint32_t> blockAt_{}; ///< Block of each instruction position.
+
+        std::vector<uint32_t> successorStarts_{}; ///< Start of the successors of each block, then the end.
+        std::vector<uint32_t> successors_{}; ///< Normal successors of all blocks.
+        std::vector<uint32_t> exceptionSuccessorStarts_{}; ///< Start of the handlers of each block, then the end.
+        std::vector<uint32_t> exceptionSuccessors_{}; ///< Exception successors of all blocks.
+        std::vector<uint32_t> predecessorStarts_{}; ///< Start of the predecessors of each block, then the end.
+        std::vector<uint32_t> predecessors_{}; ///< Predecessors of all blocks.
+
+        std::vector<uint32_t> reversePostorder_{}; ///< Reachable blocks in reverse postorder.
+        std::vector<bool> isReachable_{}; ///< Reachability of each block.
+    };
+} // jvm
+
+#endif //JVM__CONTROL_FLOW_GRAPH_H
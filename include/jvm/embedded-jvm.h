@@ -0,0 +1,142 @@
+#ifndef JVM__EMBEDDED_JVM_H
+#define JVM__EMBEDDED_JVM_H
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace jvm
+{
+    /**
+     * @brief Process-wide JVM embedded via JNI and used to fix generated classes.
+     *
+     * Creating a JVM takes hundreds of milliseconds, and HotSpot does not allow creating a new JVM
+     * in a process after the previous one was destroyed. So a single JVM is shared by all writes:
+     * it is started once and stays alive while it is referenced.
+     *
+     * References are taken either explicitly, with @ref startup / @ref shutdown, or by keeping
+     * an @ref EmbeddedJvm object alive. If a class is written while no reference is held, the JVM
+     * is started lazily and stays alive until the process exits.
+     *
+     * The @c FixClass class and its @c fix method are resolved once per JVM.
+     * If the process already hosts a JVM, that JVM is used and never destroyed.
+     *
+     * Any thread may call @ref fix: it is attached to the JVM as a daemon thread on first use
+     * and detached when it exits. Calls from different threads run concurrently.
+     *
+     * @note All functions are thread-safe.
+     */
+    class EmbeddedJvm
+    {
+    public:
+        /**
+         * @brief Several classes in binary format packed into one buffer.
+         */
+        struct Batch
+        {
+            std::vector<unsigned char> data{}; ///< Classes one after another.
+            std::vector<std::size_t> offsets{}; ///< Start of each class in @c data, followed by @c data.size().
+        };
+
+        /**
+         * @brief Take a reference to the JVM for the lifetime of this object.
+         *
+         * @throws std::runtime_error If the JVM can't be started.
+         * @throws std::logic_error If the JVM was already shut down.
+         */
+        EmbeddedJvm();
+
+        /**
+         * @brief Release the reference taken by the constructor.
+         */
+        ~EmbeddedJvm();
+
+        EmbeddedJvm(const EmbeddedJvm&) = delete;
+        EmbeddedJvm& operator=(const EmbeddedJvm&) = delete;
+
+        /**
+         * @brief Take a reference to the JVM, starting it if needed.
+         *
+         * Every call must be paired with a @ref shutdown call.
+         *
+         * @throws std::runtime_error If the JVM can't be started.
+         * @throws std::logic_error If the JVM was already shut down, it can't be restarted.
+         */
+        static void startup();
+
+        /**
+         * @brief Release a reference taken by @ref startup.
+         *
+         * The JVM is destroyed when the last reference is released,
+         * unless it was started lazily or is not owned by this library.
+         *
+         * @throws std::logic_error If no reference is held.
+         */
+        static void shutdown();
+
+        /**
+         * @return True if the JVM is running.
+         */
+        [[nodiscard]] static bool isRunning();
+
+        /**
+         * @brief Compute max stack, max locals and stack map frames of a class using @c FixClass.fix.
+         *
+         * Starts the JVM lazily if it is not running.
+         *
+         * @param data Class in binary format.
+         * @return Fixed class in binary format.
+         * @throws std::runtime_error If the JVM can't be started, the current thread can't be attached
+         * or @c FixClass.fix throws.
+         * @throws std::logic_error If the JVM was already shut down or @c FixClass is not found.
+         */
+        [[nodiscard]] static std::vector<unsigned char> fix(std::span<const unsigned char> data);
+
+        /**
+         * @brief Writes a class in binary format into the given buffer.
+         */
+        using Serializer = std::function<void(std::span<unsigned char>)>;
+
+        /**
+         * @brief Receives a fixed class in binary format.
+         */
+        using Consumer = std::function<void(std::span<const unsigned char>)>;
+
+        /**
+         * @brief Fix a class without native copies of its input and output.
+         *
+         * @p serialize writes the class straight into the Java array passed to @c FixClass.fix,
+         * and @p consume reads the fixed class straight from the returned Java array.
+         * Both arrays are accessed as critical arrays, so garbage collection may be blocked
+         * while the callbacks run: they must be short and must not call into the JVM.
+         *
+         * @param size Exact size of the class in bytes.
+         * @param serialize Writes the class, called once.
+         * @param consume Receives the fixed class, called once.
+         * @throws std::invalid_argument If the class exceeds the Java array size limit.
+         * @throws std::runtime_error If the JVM can't be started, the current thread can't be attached,
+         * the arrays can't be accessed or @c FixClass.fix throws.
+         * @throws std::logic_error If the JVM was already shut down or @c FixClass is not found.
+         */
+        static void fix(std::size_t size, const Serializer& serialize, const Consumer& consume);
+
+        /**
+         * @brief Fix several classes with a single call to @c FixClass.fixAll.
+         *
+         * Each direction copies one array, instead of one array per class.
+         *
+         * @param data Classes in binary format, one after another.
+         * @param offsets Start of each class in @p data, followed by @c data.size(). The first one is 0.
+         * @return Fixed classes in the same order.
+         * @throws std::invalid_argument If @p offsets don't ascend from 0 to @c data.size(),
+         * or the batch exceeds the Java array size limit.
+         * @throws std::runtime_error If the JVM can't be started, the current thread can't be attached
+         * or @c FixClass.fixAll throws.
+         * @throws std::logic_error If the JVM was already shut down or @c FixClass is not found.
+         */
+        [[nodiscard]] static Batch fixAll(std::span<const unsigned char> data, std::span<const std::size_t> offsets);
+    };
+} // jvm
+
+#endif //JVM__EMBEDDED_JVM_H
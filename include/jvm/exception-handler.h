@@ -12,6 +12,11 @@ namespace jvm
     class ConstantClass;
     class Label;
 
+    namespace internal
+    {
+        class MethodOutliner;
+    }
+
     /**
      * @brief Exception table entry of a JVM Code attribute.
      *
@@ -30,6 +35,7 @@ namespace jvm
     class ExceptionHandler final : public ClassFileElement<AttributeCode>
     {
         friend class AttributeCode;
+        friend class internal::MethodOutliner;
 
     public:
         static constexpr size_t sizeInBytes = 8;
@@ -55,11 +61,13 @@ namespace jvm
         [[nodiscard]] ConstantClass* getCatchClass() const;
 
     protected:
+        using Serializable::writeTo;
+
         /**
          * @throws std::logic_error If any required label is not bound to an instruction
          *                          or if instruction positions are not finalized.
          */
-        void writeTo(std::ostream& os) const override;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
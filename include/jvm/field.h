@@ -77,7 +77,8 @@ namespace jvm
         [[nodiscard]] Class* getClass() const;
 
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Serializable::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
@@ -0,0 +1,67 @@
+#ifndef JVM__HELPER_PROCESS_POOL_H
+#define JVM__HELPER_PROCESS_POOL_H
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace jvm
+{
+    /**
+     * @brief Process-wide pool of @c java processes running @c FixClass in serving mode.
+     *
+     * Each process is started once with @c "java -jar fix_code_attribute.jar --serve" and fixes any number
+     * of classes sent over its standard input and output: a request is a big-endian @c u4 length followed
+     * by a class file, a response is a status byte, a big-endian @c u4 length and either the fixed class
+     * or an error message.
+     *
+     * Processes are started lazily, up to @ref getMaxProcesses, and reused. A thread that fixes a class
+     * while all processes are busy and the limit is reached waits for one to be released.
+     * A process that crashes or breaks the protocol is discarded and replaced on the next call,
+     * so a JVM failure never takes down this process.
+     *
+     * The @c java executable is taken from the @c JAVA_HOME environment variable.
+     *
+     * @note All functions are thread-safe.
+     */
+    class HelperProcessPool
+    {
+    public:
+        HelperProcessPool() = delete;
+
+        /**
+         * @brief Compute max stack, max locals and stack map frames of a class in a helper process.
+         *
+         * @param data Class in binary format.
+         * @return Fixed class in binary format.
+         * @throws std::invalid_argument If the class exceeds the protocol size limit.
+         * @throws std::runtime_error If @c JAVA_HOME is not set, a process can't be started or exits
+         * unexpectedly, or @c FixClass fails to fix the class.
+         */
+        [[nodiscard]] static std::vector<unsigned char> fix(std::span<const unsigned char> data);
+
+        /**
+         * @brief Set the maximum number of helper processes.
+         *
+         * Extra processes are stopped when they are released.
+         *
+         * @param count Maximum number of processes.
+         * @throws std::invalid_argument If @p count is 0.
+         */
+        static void setMaxProcesses(std::size_t count);
+
+        /**
+         * @return Maximum number of helper processes, the number of hardware threads by default.
+         */
+        [[nodiscard]] static std::size_t getMaxProcesses();
+
+        /**
+         * @brief Stop all idle helper processes.
+         *
+         * Busy processes keep running and return to the pool. Processes are started again on demand.
+         */
+        static void shutdown();
+    };
+} // jvm
+
+#endif //JVM__HELPER_PROCESS_POOL_H
@@ -6,6 +6,12 @@
 
 namespace jvm
 {
+    namespace internal
+    {
+        class JumpThreader;
+        class MethodOutliner;
+    }
+
     /**
      * @brief Branch instruction that transfers control to a target @ref Label.
      *
@@ -14,11 +20,17 @@ namespace jvm
      * The target is specified symbolically via a @ref Label. During serialization the label must
      * already be bound to a concrete target instruction; otherwise the instruction cannot be encoded.
      *
+     * A jump whose target is out of the 2-byte range is widened when the code attribute is finalized:
+     * @c goto and @c jsr become @c goto_w and @c jsr_w, and a conditional jump is encoded as the inverted
+     * condition branching over a @c goto_w to the target.
+     *
      * @note Instances are created by @ref AttributeCode.
      */
     class InstructionJump : public Instruction
     {
         friend class AttributeCode;
+        friend class internal::JumpThreader;
+        friend class internal::MethodOutliner;
 
     public:
         /**
@@ -28,7 +40,21 @@ namespace jvm
          */
         [[nodiscard]] Label* getJumpLabel() const;
 
+        /**
+         * @brief Check whether the jump was widened to reach a target out of the 2-byte range.
+         *
+         * @return @c true if the offset to the target is encoded with 4 bytes.
+         */
+        [[nodiscard]] bool isWide() const noexcept
+        {
+            return byteSize_ != shortSize;
+        }
+
     protected:
+        static constexpr uint8_t shortSize = 3; ///< Opcode and 2-byte offset.
+        static constexpr uint8_t wideSize = 5; ///< @c goto_w or @c jsr_w, opcode and 4-byte offset.
+        static constexpr uint8_t wideConditionalSize = shortSize + wideSize; ///< Inverted jump over a @c goto_w.
+
         /**
          * @brief Construct a 2-byte branch instruction.
          *
@@ -38,12 +64,26 @@ namespace jvm
          */
         InstructionJump(AttributeCode* attributeCode, Command command, Label* label);
 
+        using Instruction::writeTo;
+
         /**
          * @throws std::logic_error If the target label is not bound to any instruction.
          */
-        void writeTo(std::ostream& os) const override;
+        void writeTo(ByteWriter& writer) const override;
+
+        /**
+         * @brief Switch to the encoding with a 4-byte offset.
+         *
+         * @throws std::logic_error If the opcode has no wide form.
+         */
+        void widen();
 
-        [[nodiscard]] size_t getByteSize() const override;
+        /**
+         * @brief Invert the condition of a conditional jump, for example @c ifeq to @c ifne.
+         *
+         * @throws std::invalid_argument If the jump is unconditional.
+         */
+        void invert();
 
         Label* label_; ///< Target label (non-owning).
     };
@@ -0,0 +1,129 @@
+#ifndef JVM__INSTRUCTION_SWITCH_H
+#define JVM__INSTRUCTION_SWITCH_H
+
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "instruction.h"
+#include "label.h"
+
+namespace jvm
+{
+    namespace internal
+    {
+        class JumpThreader;
+        class MethodOutliner;
+    }
+
+    /**
+     * @brief Instruction "tableswitch" or "lookupswitch". Jump to a target @ref Label selected by an int key.
+     *
+     * Layout after the opcode:
+     * - 0 to 3 padding bytes, so that the operands start at a multiple of 4 from the start of the code;
+     * - 4-byte offset of the default target;
+     * - @c tableswitch: 4-byte @c low and @c high keys, then one 4-byte offset per key in [low, high];
+     * - @c lookupswitch: 4-byte pair count, then pairs of a 4-byte key and a 4-byte offset, sorted by key.
+     *
+     * The padding depends on the position of the instruction, so the size is only known after layout.
+     * Offsets are relative to the opcode of the switch.
+     *
+     * @note Instances are created by @ref AttributeCode.
+     */
+    class InstructionSwitch final : public Instruction
+    {
+        friend class AttributeCode;
+        friend class internal::JumpThreader;
+        friend class internal::MethodOutliner;
+
+    public:
+        /**
+         * @return Target for keys without a case.
+         */
+        [[nodiscard]] Label* getDefaultLabel() const noexcept
+        {
+            return defaultLabel_;
+        }
+
+        /**
+         * @return Case targets, in ascending order of their keys.
+         */
+        [[nodiscard]] std::span<Label* const> getLabels() const noexcept
+        {
+            return labels_;
+        }
+
+        /**
+         * @brief Get the key of a case.
+         *
+         * @param caseIndex Index of the case in @ref getLabels.
+         * @return Key jumping to the target at @p caseIndex.
+         */
+        [[nodiscard]] int32_t getKey(std::size_t caseIndex) const;
+
+    private:
+        /// Opcode, default offset and, for @c tableswitch, low and high keys.
+        static constexpr uint32_t tableFixedSize = 1 + 3 * 4;
+        /// Opcode, default offset and pair count of @c lookupswitch.
+        static constexpr uint32_t lookupFixedSize = 1 + 2 * 4;
+        /// Largest padding before the operands.
+        static constexpr uint32_t maxPadding = 3;
+        /// Most cases of a @c tableswitch fitting the code of a method.
+        static constexpr std::size_t maxTableCases = (UINT16_MAX - tableFixedSize - maxPadding) / 4;
+        /// Most cases of a @c lookupswitch fitting the code of a method.
+        static constexpr std::size_t maxLookupCases = (UINT16_MAX - lookupFixedSize - maxPadding) / 8;
+
+        /**
+         * @brief Construct a @c tableswitch.
+         *
+         * @param attributeCode Owning code attribute.
+         * @param defaultLabel Target for keys out of the range.
+         * @param low Key of the first case.
+         * @param labels Targets of the keys from @p low, allocated in the arena of the class.
+         */
+        InstructionSwitch(AttributeCode* attributeCode, Label* defaultLabel, int32_t low,
+                          std::pmr::vector<Label*> labels);
+
+        /**
+         * @brief Construct a @c lookupswitch.
+         *
+         * @param attributeCode Owning code attribute.
+         * @param defaultLabel Target for keys without a case.
+         * @param keys Ascending keys, allocated in the arena of the class.
+         * @param labels Targets of @p keys, allocated in the arena of the class.
+         */
+        InstructionSwitch(AttributeCode* attributeCode, Label* defaultLabel, std::pmr::vector<int32_t> keys,
+                          std::pmr::vector<Label*> labels);
+
+        /**
+         * @brief Get the encoded size of a switch with the given number of cases, without padding.
+         */
+        [[nodiscard]] static uint32_t getUnpaddedSize(Command command, std::size_t caseCount) noexcept;
+
+        /**
+         * @brief Update the size of the instruction for the padding it needs at its position.
+         *
+         * @pre The position is set.
+         */
+        void updatePadding();
+
+        /**
+         * @return Number of padding bytes after the opcode at the current position.
+         */
+        [[nodiscard]] uint32_t getPadding() const;
+
+        using Instruction::writeTo;
+
+        /**
+         * @throws std::logic_error If a target label is not bound to any instruction.
+         */
+        void writeTo(ByteWriter& writer) const override;
+
+        Label* defaultLabel_; ///< Target for keys without a case (non-owning).
+        int32_t low_ = 0; ///< Key of the first case of a @c tableswitch.
+        std::pmr::vector<int32_t> keys_; ///< Keys of a @c lookupswitch, empty for a @c tableswitch.
+        std::pmr::vector<Label*> labels_; ///< Case targets (non-owning).
+    };
+} // jvm
+
+#endif //JVM__INSTRUCTION_SWITCH_H
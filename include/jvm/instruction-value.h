@@ -1,12 +1,13 @@
 #ifndef JVM__INSTRUCTION_VALUE_H
 #define JVM__INSTRUCTION_VALUE_H
 
+#include <cassert>
 #include <concepts>
+#include <span>
 #include <tuple>
 
 #include "jvm/instruction.h"
 #include "jvm/class-file-element.h"
-#include "jvm/internal/utils.h"
 
 namespace jvm
 {
@@ -20,8 +21,8 @@ namespace jvm
     /**
      * @brief Bytecode instruction with inline encoded operand values.
      *
-     * Stores a fixed set of operand values (template parameters) and serializes them
-     * after the opcode in big-endian order.
+     * Stores a fixed set of operand values (template parameters). They are encoded in big-endian order into
+     * the immediate operands of @ref Instruction on construction, and serialized after the opcode.
      *
      * @tparam Args Operand value types written after the opcode.
      * @note Instances are created by @ref AttributeCode.
@@ -32,26 +33,6 @@ namespace jvm
         friend class AttributeCode;
 
     public:
-        [[nodiscard]] size_t getByteSize() const override
-        {
-            static_assert(
-                (sizeof(Args) + ...) <= UINT8_MAX,
-                "InstructionValue is too large."
-            );
-
-            return Instruction::getByteSize() + (sizeof(Args) + ...);
-        }
-
-        void writeTo(std::ostream& os) const override
-        {
-            Instruction::writeTo(os);
-
-            std::apply([&os](auto&&... xs)
-            {
-                (internal::Utils::writeBigEndian(os, xs), ...);
-            }, values_);
-        }
-
         /**
          * @brief Get the operand value by index.
          *
@@ -107,8 +88,28 @@ namespace jvm
          * @param values Operand values to be serialized after the opcode.
          */
         InstructionValue(AttributeCode* attributeCode, Command command, Args... values)
-            : Instruction(attributeCode, command), values_(values...)
+            : InstructionValue(attributeCode, command, OPERAND_value, values...)
+        {
+        }
+
+        /**
+         * @brief Construct an instruction with inline operand values and the given encoding.
+         *
+         * @param attributeCode Owning code attribute.
+         * @param command Opcode of the instruction.
+         * @param operandKind @ref OPERAND_value, or @ref OPERAND_wide to prefix the opcode with @c wide.
+         * @param values Operand values to be serialized after the opcode.
+         */
+        InstructionValue(AttributeCode* attributeCode, Command command, OperandKind operandKind, Args... values)
+            : Instruction(attributeCode, command, operandKind,
+                          (operandKind == OPERAND_wide ? 2 : 1) + (sizeof(Args) + ...)),
+              values_(values...)
         {
+            static_assert((sizeof(Args) + ...) <= maxImmediateSize, "InstructionValue is too large.");
+            assert(operandKind == OPERAND_value || operandKind == OPERAND_wide);
+
+            ByteWriter writer(std::span<std::byte>(immediates_).first((sizeof(Args) + ...)));
+            (writer.writeBigEndian(values), ...);
         }
 
         std::tuple<Args...> values_; ///< Stored operand values.
@@ -66,12 +66,12 @@ namespace jvm
          */
         virtual void update();
 
+        using Instruction::writeTo;
+
         /**
          * @throws std::out_of_range If the reference size is 1 byte and the constant index does not fit.
          */
-        void writeTo(std::ostream& os) const override;
-
-        [[nodiscard]] std::size_t getByteSize() const override;
+        void writeTo(ByteWriter& writer) const override;
 
     private:
         Constant* constant_; ///< Referenced constant pool entry.
@@ -1,6 +1,8 @@
 #ifndef JVM__INSTRUCTION_H
 #define JVM__INSTRUCTION_H
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <iosfwd>
 
@@ -17,6 +19,8 @@ namespace jvm
      * @ref AttributeCode instance.
      *
      * The code attribute assigns a bytecode position (index) to each instruction during code layout.
+     * Every instruction carries its @ref OperandKind and encoded size, so layout and encoding dispatch on
+     * the kind instead of on the dynamic type. Immediate operands are encoded when the instruction is created.
      *
      * @note Instances are created and managed by @ref AttributeCode.
      */
@@ -472,12 +476,35 @@ namespace jvm
             INSTRUCTION_breakpoint = 0xca,
         };
 
+        /**
+         * @brief Kind of the operands following the opcode.
+         *
+         * Identifies the concrete instruction class without RTTI.
+         */
+        enum OperandKind : uint8_t
+        {
+            OPERAND_none, ///< Opcode only, @ref Instruction.
+            OPERAND_value, ///< Immediate values, @ref InstructionValue.
+            OPERAND_constant, ///< Constant pool index, @ref InstructionWithConstant.
+            OPERAND_jump, ///< Branch offset to a label, @ref InstructionJump.
+            OPERAND_switch, ///< Padded jump table, @ref InstructionSwitch.
+            OPERAND_wide, ///< Immediate values with 2-byte local variable index, after a @c wide prefix, @ref InstructionValue.
+        };
+
+        /// Largest immediate operands of an instruction: 2-byte index and increment of @c wide @c iinc.
+        static constexpr std::size_t maxImmediateSize = 4;
+
         /**
          * @brief Get the opcode of this instruction.
          *
          * @return Opcode value.
          */
-        [[nodiscard]] Command getCommandCode() const;
+        [[nodiscard]] Command getCommandCode() const { return command_; }
+
+        /**
+         * @return Kind of the operands of this instruction.
+         */
+        [[nodiscard]] OperandKind getOperandKind() const noexcept { return operandKind_; }
 
         /**
          * @brief Check whether a bytecode position has been assigned to this instruction.
@@ -505,6 +532,16 @@ namespace jvm
          */
         Instruction(AttributeCode* attributeCode, Command command);
 
+        /**
+         * @brief Construct an instruction with operands.
+         *
+         * @param attributeCode Owning code attribute.
+         * @param command Instruction opcode.
+         * @param operandKind Kind of the operands.
+         * @param byteSize Encoded size, opcode included.
+         */
+        Instruction(AttributeCode* attributeCode, Command command, OperandKind operandKind, uint16_t byteSize);
+
         /**
          * @brief Update the opcode of this instruction.
          *
@@ -516,14 +553,25 @@ namespace jvm
          * @brief Compute a relative branch displacement to the target instruction.
          *
          * @param target Target instruction.
-         * @return Relative displacement.
+         * @return Signed displacement from this instruction to @p target, in bytes.
          * @throws std::logic_error If the source or target instruction position is not set.
          */
-        [[nodiscard]] uint16_t calculateShift(Instruction* target) const;
+        [[nodiscard]] int32_t calculateShift(Instruction* target) const;
+
+        /**
+         * @return Encoded size of the instruction, known without a virtual call.
+         */
+        [[nodiscard]] std::size_t getByteSize() const final;
 
-        [[nodiscard]] std::size_t getByteSize() const override;
+        using Serializable::writeTo;
 
-        void writeTo(std::ostream& os) const override;
+        /**
+         * @brief Write the opcode and the immediate operands.
+         */
+        void writeTo(ByteWriter& writer) const override;
+
+        uint16_t byteSize_ = 1; ///< Encoded size, opcode included.
+        std::array<std::byte, maxImmediateSize> immediates_{}; ///< Encoded immediate operands.
 
     private:
         /**
@@ -533,7 +581,11 @@ namespace jvm
          *
          * @param index Bytecode position.
          */
-        void setIndex(uint16_t index);
+        void setIndex(uint16_t index)
+        {
+            index_ = index;
+            isIndexSet_ = true;
+        }
 
         /**
          * @brief Reset the assigned bytecode position.
@@ -541,8 +593,9 @@ namespace jvm
         void resetIndex();
 
         Command command_; ///< Opcode of this instruction.
-        uint16_t index_ = 0; ///< Bytecode position assigned during layout.
+        OperandKind operandKind_ = OPERAND_none; ///< Kind of the operands.
         bool isIndexSet_ = false; ///< True if @ref index_ is valid.
+        uint16_t index_ = 0; ///< Bytecode position assigned during layout.
     };
 } // jvm
 
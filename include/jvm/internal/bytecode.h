@@ -0,0 +1,131 @@
+#ifndef JVM__BYTECODE_H
+#define JVM__BYTECODE_H
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "jvm/instruction.h"
+
+namespace jvm::internal
+{
+    /**
+     * @brief Static properties of bytecode instructions and descriptors used by code analysis.
+     */
+    class Bytecode
+    {
+    public:
+        /// Returned by @ref getStackDelta for instructions whose effect depends on their operands.
+        static constexpr int8_t variableStackDelta = INT8_MIN;
+
+        /**
+         * @brief Get the change of the operand stack size (in slots) made by an instruction.
+         *
+         * @param command Instruction opcode.
+         * @return Stack size change, or @ref variableStackDelta for field access, invocations,
+         * @c multianewarray and @c wide.
+         */
+        static int8_t getStackDelta(Instruction::Command command);
+
+        /**
+         * @brief Get the change of the operand stack size made by a field access or an invocation.
+         *
+         * @param command @c getstatic, @c putstatic, @c getfield, @c putfield or an @c invoke* opcode.
+         * @param descriptor Field descriptor for field access, method descriptor for invocations.
+         * @return Stack size change in slots, including the object reference of instance members.
+         * @throws std::invalid_argument If @p command doesn't access a class member or the descriptor is malformed.
+         */
+        static int32_t getMemberStackDelta(Instruction::Command command, std::string_view descriptor);
+
+        /// Returned by @ref getOperandSize for instructions whose operands have a variable size.
+        static constexpr int8_t variableOperandSize = -1;
+
+        /**
+         * @brief Get the size of the operands following an opcode.
+         *
+         * @param command Instruction opcode.
+         * @return Operand size in bytes, or @ref variableOperandSize for switches and @c wide.
+         */
+        static int8_t getOperandSize(Instruction::Command command);
+
+        /**
+         * @brief Get the number of local variable slots accessed by a load, store, @c iinc or @c ret instruction.
+         *
+         * @param command Instruction opcode.
+         * @return 2 for @c long and @c double accesses, 1 for other accesses, 0 if no local variable is accessed.
+         */
+        static uint8_t getLocalSlots(Instruction::Command command);
+
+        /**
+         * @brief Get the local variable index encoded in the opcode of @c xload_n and @c xstore_n instructions.
+         *
+         * @param command Instruction opcode.
+         * @return Local variable index, or -1 if the index is an operand.
+         */
+        static int8_t getImplicitLocalIndex(Instruction::Command command);
+
+        /**
+         * @brief Check whether execution never continues with the next instruction.
+         *
+         * @param command Instruction opcode.
+         * @return @c true for returns, @c athrow, unconditional jumps, switches and @c ret.
+         */
+        static bool isTerminal(Instruction::Command command);
+
+        /**
+         * @brief Get the conditional jump taken exactly when the given one is not.
+         *
+         * @param command Conditional jump opcode, @c if<cond>, @c if_icmp<cond>, @c if_acmp<cond>,
+         * @c ifnull or @c ifnonnull.
+         * @return Opcode with the negated condition.
+         * @throws std::invalid_argument If @p command is not a conditional jump.
+         */
+        static Instruction::Command getInvertedJump(Instruction::Command command);
+
+        /**
+         * @brief Get the number of stack slots taken by a value of a field type.
+         *
+         * @param descriptor Field descriptor (e.g. "J", "Ljava/lang/String;"), or "V".
+         * @return 2 for @c long and @c double, 0 for @c void, 1 otherwise.
+         */
+        static uint8_t getSlots(std::string_view descriptor);
+
+        /**
+         * @brief Get the number of stack slots taken by the arguments of a method.
+         *
+         * @param methodDescriptor Method descriptor (e.g. "(IJ)V").
+         * @return Argument slots, without @c this.
+         * @throws std::invalid_argument If the descriptor is malformed.
+         */
+        static uint16_t getArgumentSlots(std::string_view methodDescriptor);
+
+        /**
+         * @brief Get the number of stack slots taken by the return value of a method.
+         *
+         * @param methodDescriptor Method descriptor (e.g. "(IJ)V").
+         * @return Return value slots.
+         * @throws std::invalid_argument If the descriptor is malformed.
+         */
+        static uint8_t getReturnSlots(std::string_view methodDescriptor);
+
+        /**
+         * @brief Split the arguments of a method descriptor into field types.
+         *
+         * @param methodDescriptor Method descriptor (e.g. "(IJ)V").
+         * @return Argument field types (e.g. "I", "J"), viewing @p methodDescriptor.
+         * @throws std::invalid_argument If the descriptor is malformed.
+         */
+        static std::vector<std::string_view> getArgumentTypes(std::string_view methodDescriptor);
+
+        /**
+         * @brief Get the return type of a method descriptor.
+         *
+         * @param methodDescriptor Method descriptor (e.g. "(IJ)V").
+         * @return Return field type or "V", viewing @p methodDescriptor.
+         * @throws std::invalid_argument If the descriptor is malformed.
+         */
+        static std::string_view getReturnType(std::string_view methodDescriptor);
+    };
+} // jvm::internal
+
+#endif //JVM__BYTECODE_H
@@ -0,0 +1,44 @@
+#ifndef JVM__DEAD_CODE_ELIMINATOR_H
+#define JVM__DEAD_CODE_ELIMINATOR_H
+
+#include <cstddef>
+
+namespace jvm
+{
+    class AttributeCode;
+}
+
+namespace jvm::internal
+{
+    /**
+     * @brief Removes the instructions of a code attribute that can't be reached from its entry.
+     *
+     * Reachability follows jumps, switches, fall-through and exception handlers of reachable code,
+     * see @ref ControlFlowGraph. Labels bound to removed instructions move to the next kept instruction,
+     * so exception ranges keep covering the same reachable instructions; a range left empty is dropped.
+     * Unreachable code at the end of the method has no next instruction: labels bound to it are unbound,
+     * unless an exception range of reachable code ends there, then the code is replaced with a single @c athrow.
+     */
+    class DeadCodeEliminator
+    {
+    public:
+        /**
+         * @brief Prepare elimination of dead code in a code attribute.
+         *
+         * @param code Code attribute, not finalized. Must outlive the eliminator.
+         */
+        explicit DeadCodeEliminator(AttributeCode& code);
+
+        /**
+         * @brief Remove the unreachable instructions.
+         *
+         * @return Number of removed bytes, counted before layout: without switch padding and with short jumps.
+         */
+        std::size_t run();
+
+    private:
+        AttributeCode& code_; ///< Optimized code.
+    };
+} // jvm::internal
+
+#endif //JVM__DEAD_CODE_ELIMINATOR_H
@@ -0,0 +1,169 @@
+#ifndef JVM__FRAME_ANALYZER_H
+#define JVM__FRAME_ANALYZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jvm
+{
+    class AttributeCode;
+    class ClassHierarchy;
+    class Instruction;
+}
+
+namespace jvm::internal
+{
+    /**
+     * @brief Infers the types of local variables and operand stack entries of a code attribute.
+     *
+     * Runs a dataflow analysis over basic blocks: each block is executed on its entry types, and
+     * the resulting types are merged into the entry types of its successors and exception handlers
+     * until nothing changes. Reference types are merged to their common superclass using
+     * a @ref ClassHierarchy.
+     *
+     * Types are tracked per slot: @c long and @c double take two slots, the second one is @c Top.
+     */
+    class FrameAnalyzer
+    {
+    public:
+        /**
+         * @brief Verification type of one slot.
+         */
+        struct Type
+        {
+            /**
+             * @brief Type kinds, numbered as verification type tags.
+             */
+            enum Kind : uint8_t
+            {
+                Top = 0,
+                Integer = 1,
+                Float = 2,
+                Double = 3,
+                Long = 4,
+                Null = 5,
+                UninitializedThis = 6,
+                Object = 7,
+                Uninitialized = 8,
+            };
+
+            Kind kind = Top; ///< Type kind.
+            std::string className{}; ///< Internal name or array descriptor of an @ref Object.
+            const Instruction* newInstruction = nullptr; ///< @c new instruction of an @ref Uninitialized.
+
+            bool operator==(const Type&) const = default;
+        };
+
+        /**
+         * @brief Types of all slots at the start of an instruction.
+         */
+        struct Frame
+        {
+            std::vector<Type> locals{}; ///< Local variable slots.
+            std::vector<Type> stack{}; ///< Operand stack slots, from bottom to top.
+        };
+
+        /**
+         * @brief Prepare analysis of a code attribute.
+         *
+         * @param code Code attribute with bound labels. Must outlive the analyzer.
+         * @param hierarchy Class hierarchy used to merge reference types. Must outlive the analyzer.
+         */
+        FrameAnalyzer(const AttributeCode& code, const ClassHierarchy& hierarchy);
+
+        /**
+         * @brief Run the analysis.
+         *
+         * @param framePositions Instructions that get a frame in addition to the ones requiring one,
+         * e.g. all basic block starts.
+         * @throws std::logic_error If the operand stack underflows, has different sizes or incompatible types
+         * on merging paths, execution falls off the end of the code, or the code uses @c jsr / @c ret.
+         * @throws std::invalid_argument If a referenced descriptor is malformed.
+         */
+        void analyze(std::span<const uint32_t> framePositions = {});
+
+        /**
+         * @return Types at method entry.
+         */
+        [[nodiscard]] const Frame& getInitialFrame() const;
+
+        /**
+         * @brief Get the types at an instruction that requires a stack map frame.
+         *
+         * Frames are required at jump targets, exception handlers and after unconditional control transfers,
+         * and requested at the positions given to @ref analyze.
+         *
+         * @param position Position of the instruction in the code.
+         * @return Frame, or empty if the instruction requires no frame or is unreachable.
+         */
+        [[nodiscard]] const std::optional<Frame>& getFrame(std::size_t position) const;
+
+        /**
+         * @param position Position of the instruction in the code.
+         * @return True if the instruction can be executed.
+         */
+        [[nodiscard]] bool isReachable(std::size_t position) const;
+
+    private:
+        /**
+         * @brief Protected range of an exception handler, as instruction positions.
+         */
+        struct HandlerRange
+        {
+            std::size_t start;
+            std::size_t end;
+            std::size_t handler;
+            std::string catchType; ///< Internal name of the caught class.
+        };
+
+        [[nodiscard]] std::size_t getPosition(const Instruction* instruction) const;
+
+        /**
+         * @brief Execute the basic block starting at @p position on its entry types.
+         */
+        void executeBlock(std::size_t position);
+
+        /**
+         * @brief Apply an instruction to @p frame and merge the result into jump targets.
+         */
+        void execute(std::size_t position, Frame& frame);
+
+        /**
+         * @brief Replace an uninitialized type with the initialized one after its constructor call.
+         */
+        void initialize(Frame& frame, const Type& uninitialized) const;
+
+        /**
+         * @brief Merge types into the entry frame of an instruction, queueing it if the frame changed.
+         */
+        void merge(std::size_t position, const Frame& frame);
+
+        /**
+         * @brief Merge local variable types into the entry frame of an exception handler.
+         */
+        void mergeHandler(const HandlerRange& range, const std::vector<Type>& locals);
+
+        [[nodiscard]] Type mergeTypes(const Type& first, const Type& second) const;
+
+        [[nodiscard]] std::string getCommonSuperClass(const std::string& first, const std::string& second) const;
+
+        const AttributeCode& code_; ///< Analyzed code.
+        const ClassHierarchy& hierarchy_; ///< Class hierarchy.
+        std::string className_{}; ///< Internal name of the class owning the code.
+        std::unordered_map<const Instruction*, std::size_t> positions_{}; ///< Instruction positions.
+        std::vector<HandlerRange> handlers_{}; ///< Exception handlers.
+        Frame initialFrame_{}; ///< Types at method entry.
+        std::vector<bool> needsFrame_{}; ///< Instructions that start basic blocks requiring a frame.
+        std::vector<std::optional<Frame>> frames_{}; ///< Entry frames of basic blocks.
+        std::vector<bool> isReachable_{}; ///< Executed instructions.
+        std::vector<std::size_t> worklist_{}; ///< Basic blocks with changed entry frames.
+        std::vector<bool> isQueued_{}; ///< Basic blocks in the worklist.
+    };
+} // jvm::internal
+
+#endif //JVM__FRAME_ANALYZER_H
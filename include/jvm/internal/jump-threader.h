@@ -0,0 +1,72 @@
+#ifndef JVM__JUMP_THREADER_H
+#define JVM__JUMP_THREADER_H
+
+#include <cstddef>
+
+namespace jvm
+{
+    class AttributeCode;
+    class Label;
+}
+
+namespace jvm::internal
+{
+    /**
+     * @brief Shortens chains of jumps in a code attribute.
+     *
+     * Rewrites, applied until none matches:
+     * | Code | Rewrite |
+     * |------|---------|
+     * | jump or switch to @c L, @c L: @c goto @c M | jump or switch to @c M |
+     * | @c goto to the next instruction | removed |
+     * | conditional jump to @c L, @c goto @c M, @c L: | inverted conditional jump to @c M, @c L: |
+     *
+     * Runs before layout, so shorter jumps are less likely to need widening to @c goto_w.
+     * A @c goto left only as a hop of a chain becomes unreachable, see @ref DeadCodeEliminator.
+     * Labels bound to a removed @c goto move to the next instruction; a @c goto can't throw,
+     * so exception ranges cover the same throwing instructions.
+     */
+    class JumpThreader
+    {
+    public:
+        /**
+         * @brief Prepare jump threading in a code attribute.
+         *
+         * @param code Code attribute, not finalized. Must outlive the threader.
+         */
+        explicit JumpThreader(AttributeCode& code);
+
+        /**
+         * @brief Rewrite the jumps until no rule matches.
+         *
+         * @return Number of retargeted, inverted and removed jumps.
+         */
+        std::size_t run();
+
+    private:
+        /**
+         * @brief Point jumps and switches to the end of the @c goto chains they target.
+         *
+         * @return Number of retargeted labels.
+         */
+        std::size_t retarget();
+
+        /**
+         * @brief Remove @c goto to the next instruction and invert conditional jumps over a @c goto.
+         *
+         * @return Number of removed @c goto.
+         */
+        std::size_t collapse();
+
+        /**
+         * @brief Get the last label of the @c goto chain starting at @p label.
+         *
+         * @return Label of the first instruction that isn't a @c goto, or @p label if the chain is a cycle.
+         */
+        [[nodiscard]] Label* getFinalLabel(Label* label) const;
+
+        AttributeCode& code_; ///< Optimized code.
+    };
+} // jvm::internal
+
+#endif //JVM__JUMP_THREADER_H
@@ -0,0 +1,162 @@
+#ifndef JVM__METHOD_OUTLINER_H
+#define JVM__METHOD_OUTLINER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "frame-analyzer.h"
+
+namespace jvm
+{
+    class AttributeCode;
+    class ControlFlowGraph;
+    class ExceptionHandler;
+    class Instruction;
+    class Label;
+    class Method;
+}
+
+namespace jvm::internal
+{
+    /**
+     * @brief Moves regions of a code attribute into private static methods of the same class.
+     *
+     * A region is a run of basic blocks in code order that:
+     * - is entered only at its first instruction, with an empty operand stack;
+     * - continues at a single instruction after it, with an empty operand stack, or always returns or throws;
+     * - doesn't use @c monitorenter / @c monitorexit, nor store fields in an initializer;
+     * - holds whole exception ranges with their handlers, or lies in or out of the other ranges;
+     * - writes at most one local variable read elsewhere in the method, and none at all if it lies
+     *   in an exception range, whose handler may read it.
+     *
+     * The new method takes the local variables up to the last one the region reads in the same slots,
+     * so the moved instructions are kept as is: slots it doesn't read get a zero. It returns
+     * the written local variable, or the result of the method if the region always returns.
+     * The region is replaced with loads of the arguments, an @c invokestatic, then a store of the result
+     * and a @c goto to the continuation, or a return.
+     *
+     * Types come from @ref FrameAnalyzer, with the class hierarchy of the class, which is required: argument types
+     * must be exact for the new method to verify on its own.
+     */
+    class MethodOutliner
+    {
+    public:
+        /**
+         * @brief Prepare outlining of a code attribute.
+         *
+         * @param code Code attribute, not finalized. Must outlive the outliner.
+         * @param maxSize Size to reach, counted before layout.
+         */
+        MethodOutliner(AttributeCode& code, std::size_t maxSize);
+
+        /**
+         * @brief Move regions, the largest first, until the code fits in the size or no region is left.
+         *
+         * @return Created methods.
+         * @throws std::logic_error If the class is an interface, has no class hierarchy, or types can't be inferred.
+         */
+        std::vector<Method*> run();
+
+    private:
+        /**
+         * @brief Region that can be moved, as blocks of a @ref ControlFlowGraph.
+         */
+        struct Region
+        {
+            uint32_t first = 0; ///< First block.
+            uint32_t end = 0; ///< Block after the last one.
+            std::optional<uint32_t> exit{}; ///< Block where the code continues, empty if the region returns or throws.
+            std::string descriptor{}; ///< Descriptor of the new method.
+            std::vector<FrameAnalyzer::Type> arguments{}; ///< Argument types, @c Top for an @c int.
+            std::vector<bool> isZero{}; ///< Argument passed as a zero of its type instead of the local variable.
+            std::optional<FrameAnalyzer::Type> result{}; ///< Type of the returned local variable.
+            uint16_t resultSlot = 0; ///< Slot of the returned local variable.
+            std::size_t size = 0; ///< Moved bytes.
+            std::size_t gain = 0; ///< Bytes saved by the move.
+        };
+
+        /**
+         * @brief Replacement of a region, prepared before any region of the round is moved.
+         */
+        struct Move
+        {
+            std::size_t first = 0; ///< Position of the first moved instruction.
+            std::size_t last = 0; ///< Position after the last moved instruction.
+            Method* method = nullptr; ///< New method.
+            AttributeCode* helper = nullptr; ///< Code of the new method.
+            Label* helperStart = nullptr; ///< Label of the first moved instruction in the new method.
+            Label* helperExit = nullptr; ///< Label of the return of the new method, @c nullptr if the region returns or throws.
+            std::vector<Instruction*> call{}; ///< Call of the new method.
+            std::vector<Instruction*> exit{}; ///< Return of the new method after the moved instructions.
+            std::vector<ExceptionHandler*> handlers{}; ///< Exception handlers moved with the region.
+        };
+
+        /**
+         * @brief Exception range as instruction positions.
+         */
+        struct HandlerRange
+        {
+            std::size_t start; ///< First protected instruction.
+            std::size_t end; ///< Instruction after the last protected one.
+            std::size_t handler; ///< First instruction of the handler.
+            ExceptionHandler* entry; ///< Exception table entry.
+        };
+
+        /**
+         * @brief Collect local variable accesses, block sizes and predecessor ranges for one round.
+         */
+        void prepare(const ControlFlowGraph& graph);
+
+        /**
+         * @brief Find the largest region starting at each block.
+         */
+        [[nodiscard]] std::vector<Region> findRegions(const ControlFlowGraph& graph, const FrameAnalyzer& analyzer) const;
+
+        /**
+         * @brief Check the conditions on exception handlers, fields, monitors and local variables of a region.
+         *
+         * @return Region with its signature, or empty if it can't be moved.
+         */
+        [[nodiscard]] std::optional<Region> checkRegion(const ControlFlowGraph& graph, const FrameAnalyzer& analyzer,
+                                                        uint32_t first, uint32_t end, std::optional<uint32_t> exit,
+                                                        std::size_t size) const;
+
+        /**
+         * @brief Create the method of a region and point the jumps of the region to its labels.
+         */
+        [[nodiscard]] Move prepareMove(const ControlFlowGraph& graph, const Region& region);
+
+        /**
+         * @brief Move the instructions of a region into its method and put the call in their place.
+         *
+         * @pre Regions after it are already moved, so positions before its end are unchanged.
+         */
+        void applyMove(const Move& move);
+
+        /**
+         * @brief Get a label of the outlined code bound to an instruction, creating one if needed.
+         */
+        [[nodiscard]] Label* getLabel(Instruction* instruction);
+
+        AttributeCode& code_; ///< Outlined code.
+        std::size_t maxSize_; ///< Size to reach.
+        std::size_t helperCount_ = 0; ///< Methods created so far, numbering their names.
+        std::unordered_map<const Instruction*, std::size_t> positions_{}; ///< Instruction positions.
+        std::vector<HandlerRange> handlers_{}; ///< Exception ranges.
+        std::vector<bool> isLabeled_{}; ///< Instruction with a bound label.
+        std::vector<int32_t> reads_{}; ///< Local variable slot read by each instruction, or -1.
+        std::vector<int32_t> writes_{}; ///< Local variable slot written by each instruction, or -1.
+        std::vector<std::size_t> firstReads_{}; ///< Position of the first read of each slot.
+        std::vector<std::size_t> lastReads_{}; ///< Position of the last read of each slot.
+        std::vector<std::size_t> blockSizes_{}; ///< Size of each block before layout.
+        std::vector<uint32_t> firstPredecessors_{}; ///< Smallest predecessor of each block.
+        std::vector<uint32_t> lastPredecessors_{}; ///< Largest predecessor of each block.
+        std::vector<bool> isReturn_{}; ///< Block ending with a return instruction.
+    };
+} // jvm::internal
+
+#endif //JVM__METHOD_OUTLINER_H
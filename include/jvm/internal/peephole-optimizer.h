@@ -0,0 +1,97 @@
+#ifndef JVM__PEEPHOLE_OPTIMIZER_H
+#define JVM__PEEPHOLE_OPTIMIZER_H
+
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace jvm
+{
+    class AttributeCode;
+    class Instruction;
+}
+
+namespace jvm::internal
+{
+    /**
+     * @brief Rewrites short instruction sequences of a code attribute into smaller equivalent ones.
+     *
+     * Rules, applied until none matches:
+     * | Sequence | Rewrite |
+     * |----------|---------|
+     * | push or load without side effects, @c pop / @c pop2 of its size | removed |
+     * | @c iconst_0 / @c lconst_0, add, subtract, or, xor or shift | removed |
+     * | @c iconst_1 / @c lconst_1, multiply or divide | removed |
+     * | @c xload @c x, @c xstore @c x | removed |
+     * | @c xstore @c x, @c xload @c x | @c dup / @c dup2, @c xstore @c x |
+     * | @c iload @c x, int constant @c c, @c iadd / @c isub, @c istore @c x | @c iinc @c x @c ±c |
+     * | @c goto to the next instruction | removed |
+     * | conditional jump to the next instruction | @c pop / @c pop2 of its operands |
+     *
+     * A sequence matches only if no label is bound to an instruction after its first one, so it never
+     * straddles a branch target or an exception range boundary. Labels bound to the first instruction
+     * move to the rewrite, or to the next instruction if the sequence is removed. Removed sequences never
+     * throw, so exception ranges cover the same throwing instructions; a range left empty is dropped.
+     */
+    class PeepholeOptimizer
+    {
+    public:
+        /**
+         * @brief Prepare optimization of a code attribute.
+         *
+         * @param code Code attribute, not finalized. Must outlive the optimizer.
+         */
+        explicit PeepholeOptimizer(AttributeCode& code);
+
+        /**
+         * @brief Rewrite the code until no rule matches.
+         *
+         * @return Number of rewritten sequences.
+         */
+        std::size_t run();
+
+    private:
+        /**
+         * @brief Replacement of the instructions at the matched position.
+         */
+        struct Rewrite
+        {
+            std::size_t length; ///< Number of replaced instructions.
+            std::vector<Instruction*> replacement{}; ///< New instructions, may reuse replaced ones.
+        };
+
+        /**
+         * @brief Apply the rules once from the start to the end of the code.
+         *
+         * @return Number of rewritten sequences.
+         */
+        std::size_t rewriteOnce();
+
+        /**
+         * @brief Find a rule matching at @p position.
+         *
+         * @param position Position of the first instruction of the sequence.
+         * @return Rewrite of the sequence, or empty if no rule matches.
+         */
+        [[nodiscard]] std::optional<Rewrite> match(std::size_t position);
+
+        /**
+         * @brief Check that the @p length instructions from @p position can be rewritten together.
+         */
+        [[nodiscard]] bool isSequence(std::size_t position, std::size_t length) const;
+
+        /**
+         * @brief Get the local variable of a load or store of the code.
+         *
+         * @return Index of the first slot accessed.
+         */
+        [[nodiscard]] std::size_t getLocalIndex(const Instruction* instruction) const;
+
+        AttributeCode& code_; ///< Optimized code.
+        std::unordered_set<const Instruction*> labeled_{}; ///< Instructions with a bound label.
+    };
+} // jvm::internal
+
+#endif //JVM__PEEPHOLE_OPTIMIZER_H
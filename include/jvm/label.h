@@ -7,6 +7,14 @@ namespace jvm
 {
     class AttributeCode;
 
+    namespace internal
+    {
+        class DeadCodeEliminator;
+        class JumpThreader;
+        class MethodOutliner;
+        class PeepholeOptimizer;
+    }
+
     /**
      * @brief Symbolic position marker used for control-flow targets and exception table ranges.
      *
@@ -22,6 +30,10 @@ namespace jvm
     class Label : public OwnerAware<AttributeCode>
     {
         friend class AttributeCode;
+        friend class internal::DeadCodeEliminator;
+        friend class internal::JumpThreader;
+        friend class internal::MethodOutliner;
+        friend class internal::PeepholeOptimizer;
 
     public:
         /**
@@ -0,0 +1,88 @@
+#ifndef JVM__METHOD_SIZE_LIMITS_H
+#define JVM__METHOD_SIZE_LIMITS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace jvm
+{
+    class Method;
+    struct MethodSizeReport;
+
+    /**
+     * @brief Bytecode sizes above which the HotSpot JIT compilers treat a method differently.
+     *
+     * Defaults are the HotSpot defaults; set them to the flags of the target JVM with @ref Class::setMethodSizeLimits.
+     *
+     * @code
+     * MethodSizeLimits limits;
+     * limits.strictCategory = MethodSizeLimits::CATEGORY_compilable; // fail the build instead of interpreting
+     * generatedClass.setMethodSizeLimits(limits);
+     * @endcode
+     */
+    struct MethodSizeLimits
+    {
+        /**
+         * @brief Treatment of a method by its code length, from the smallest to the largest.
+         */
+        enum Category : uint8_t
+        {
+            CATEGORY_inlinable = 0, ///< At most @ref maxInlineSize: inlined at any call site.
+            CATEGORY_hot_inlinable = 1, ///< At most @ref freqInlineSize: inlined only at frequent call sites.
+            CATEGORY_compilable = 2, ///< At most @ref hugeMethodLimit: compiled, never inlined.
+            CATEGORY_huge = 3, ///< Above @ref hugeMethodLimit: not compiled, left to the interpreter.
+        };
+
+        static constexpr std::size_t categoryCount = CATEGORY_huge + 1; ///< Number of @ref Category values.
+
+        uint32_t maxInlineSize = 35; ///< HotSpot @c -XX:MaxInlineSize.
+        uint32_t freqInlineSize = 325; ///< HotSpot @c -XX:FreqInlineSize.
+        uint32_t hugeMethodLimit = 8000; ///< HotSpot @c -XX:HugeMethodLimit, applied with @c -XX:+DontCompileHugeMethods.
+        Category strictCategory = CATEGORY_huge; ///< Largest category accepted on finalization; all by default.
+
+        /**
+         * @brief Get the category of a code length.
+         */
+        [[nodiscard]] Category getCategory(std::size_t codeLength) const noexcept;
+
+        /**
+         * @brief Build the size report of a method.
+         *
+         * @param method Method, not owned.
+         * @param codeLength Length of the bytecode of @p method.
+         */
+        [[nodiscard]] MethodSizeReport report(const Method* method, std::size_t codeLength) const noexcept;
+
+        /**
+         * @brief Check a finalized method against @ref strictCategory.
+         *
+         * @throws std::runtime_error If the category of @p codeLength is above @ref strictCategory.
+         */
+        void check(const Method* method, std::size_t codeLength) const;
+    };
+
+    /**
+     * @brief Size of the code of one method against @ref MethodSizeLimits.
+     */
+    struct MethodSizeReport
+    {
+        const Method* method; ///< Reported method, not owned.
+        std::size_t codeLength; ///< Length of the bytecode.
+        MethodSizeLimits::Category category; ///< Treatment by the JIT compilers.
+        std::size_t excess; ///< Bytes above the largest exceeded limit, 0 for @ref MethodSizeLimits::CATEGORY_inlinable.
+    };
+
+    /**
+     * @brief Sizes of the code of all methods of a class.
+     */
+    struct MethodSizeSummary
+    {
+        std::array<std::size_t, MethodSizeLimits::categoryCount> counts{}; ///< Number of methods per category.
+        std::size_t totalCodeLength = 0; ///< Bytecode length of all methods.
+        std::vector<MethodSizeReport> methods{}; ///< Methods with code, the largest first.
+    };
+} // jvm
+
+#endif //JVM__METHOD_SIZE_LIMITS_H
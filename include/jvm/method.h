@@ -2,6 +2,7 @@
 #define JVM__METHOD_H
 
 #include "attribute-code.h"
+#include "code-emitter.h"
 #include "constant-utf-8-info.h"
 
 namespace jvm
@@ -28,6 +29,11 @@ namespace jvm
             ACC_SYNTHETIC = 0x1000, ///< Declared synthetic; not present in the source code.
         };
 
+        /**
+         * @brief Destroy the method and its code attribute or emitter.
+         */
+        ~Method() override;
+
         /**
          * Add access flag to method.
          * @param flag Access flag.
@@ -78,11 +84,23 @@ namespace jvm
          * In first call create @ref AttributeCode for this method.
          *
          * @return Code attribute for this method.
+         * @throws std::logic_error If the method has a @ref CodeEmitter.
          */
         AttributeCode* getCodeAttribute();
 
+        /**
+         * @brief Get the streaming code emitter.
+         *
+         * In first call create @ref CodeEmitter for this method.
+         *
+         * @return Code emitter for this method.
+         * @throws std::logic_error If the method has an @ref AttributeCode.
+         */
+        CodeEmitter* getCodeEmitter();
+
     protected:
-        void writeTo(std::ostream& os) const override;
+        using Serializable::writeTo;
+        void writeTo(ByteWriter& writer) const override;
 
         [[nodiscard]] std::size_t getByteSize() const override;
 
@@ -138,6 +156,7 @@ namespace jvm
         ConstantUtf8Info* descriptor_ = nullptr; ///< String constant with method descriptor.
         std::set<Attribute*> attributes_{}; ///< Attributes.
         AttributeCode* codeAttribute_ = nullptr; ///< Pointer to code attribute.
+        CodeEmitter* codeEmitter_ = nullptr; ///< Pointer to code emitter.
     };
 } // jvm
 
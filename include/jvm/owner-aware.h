@@ -36,6 +36,18 @@ namespace jvm
          */
         [[nodiscard]] Owner* getOwner() const { return owner_; }
 
+    protected:
+        /**
+         * @brief Give the object to another owner.
+         *
+         * @param owner Pointer to the new owning object.
+         */
+        void setOwner(Owner* owner)
+        {
+            assert(owner != nullptr);
+            owner_ = owner;
+        }
+
     private:
         Owner* owner_;
     };
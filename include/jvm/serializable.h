@@ -4,16 +4,18 @@
 #include <cstddef>
 #include <iosfwd>
 
+#include "byte-writer.h"
+
 namespace jvm
 {
     /**
      * @brief Interface for binary-serializable objects.
      *
-     * Represents an object that can be written to a binary output stream
+     * Represents an object that can be written to a binary output
      * and can report its serialized size in bytes.
      *
-     * Implementations must ensure that @ref writeTo writes exactly
-     * @ref getByteSize bytes to the output stream.
+     * Implementations write themselves into a contiguous @ref ByteWriter and must ensure
+     * that @ref writeTo writes exactly @ref getByteSize bytes.
      *
      * This interface is used as a common abstraction for JVM class-file
      * structures (attributes, instructions, constants, etc.).
@@ -27,13 +29,22 @@ namespace jvm
         virtual ~Serializable() = default;
 
         /**
-         * @brief Write the object to a binary output stream.
+         * @brief Write the object to a byte writer.
          *
          * The object is serialized in its binary JVM class-file representation.
          *
+         * @param writer Byte writer to write to.
+         */
+        virtual void writeTo(ByteWriter& writer) const = 0;
+
+        /**
+         * @brief Write the object to a binary output stream.
+         *
+         * Serializes the object into a @ref ByteWriter and writes the result to the stream in one call.
+         *
          * @param os Output stream to write to.
          */
-        virtual void writeTo(std::ostream& os) const = 0;
+        virtual void writeTo(std::ostream& os) const;
 
         /**
          * @brief Get the size of the serialized object in bytes.
@@ -63,6 +74,27 @@ namespace jvm
     {
         return os << *obj;
     }
+
+    /**
+     * @brief Write a Serializable object to a byte writer.
+     *
+     * Calls @ref Serializable::writeTo.
+     */
+    inline ByteWriter& operator<<(ByteWriter& writer, const Serializable& obj)
+    {
+        obj.writeTo(writer);
+        return writer;
+    }
+
+    /**
+     * @brief Write a Serializable object pointer to a byte writer.
+     *
+     * Equivalent to dereferencing the pointer and calling the reference overload.
+     */
+    inline ByteWriter& operator<<(ByteWriter& writer, const Serializable* obj)
+    {
+        return writer << *obj;
+    }
 } //jvm
 
 #endif //JVM__SERIALIZABLE_H
@@ -2,7 +2,14 @@ package compilator.fix;
 
 import org.objectweb.asm.*;
 
+import java.io.BufferedInputStream;
+import java.io.BufferedOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
 import java.nio.file.Path;
 
@@ -42,10 +49,45 @@ import static org.objectweb.asm.ClassWriter.COMPUTE_MAXS;
  * 2. Run this tool on the generated file
  * 3. Obtain a valid, JVM-verifiable .class file
  * </pre>
+ *
+ * <p>
+ * Run with {@code --serve} to fix any number of classes in one process, see {@link #serve}.
+ * </p>
  */
 public class FixClass {
     public static byte[] fix(byte[] input) {
-        ClassReader cr = new ClassReader(input);
+        return fix(input, 0, input.length);
+    }
+
+    /**
+     * Fixes a batch of classes passed in one array, so the whole batch costs a single call.
+     *
+     * @param classes class files, one after another
+     * @param offsets start of each class in {@code classes}, followed by the end of the last one
+     * @return lengths of the fixed classes as big-endian {@code int}s, followed by the fixed classes
+     * one after another
+     */
+    public static byte[] fixAll(byte[] classes, int[] offsets) {
+        int count = offsets.length - 1;
+        byte[][] fixed = new byte[count][];
+        int size = Integer.BYTES * count;
+        for (int i = 0; i < count; i++) {
+            fixed[i] = fix(classes, offsets[i], offsets[i + 1] - offsets[i]);
+            size += fixed[i].length;
+        }
+
+        ByteBuffer result = ByteBuffer.allocate(size);
+        for (byte[] fixedClass : fixed) {
+            result.putInt(fixedClass.length);
+        }
+        for (byte[] fixedClass : fixed) {
+            result.put(fixedClass);
+        }
+        return result.array();
+    }
+
+    private static byte[] fix(byte[] input, int offset, int length) {
+        ClassReader cr = new ClassReader(input, offset, length);
 
         ClassWriter cw = new ClassWriter(ClassWriter.COMPUTE_FRAMES | ClassWriter.COMPUTE_MAXS);
 
@@ -54,9 +96,70 @@ public class FixClass {
         return cw.toByteArray();
     }
 
+    /**
+     * Status of a response that carries a fixed class.
+     */
+    public static final int STATUS_OK = 0;
+
+    /**
+     * Status of a response that carries a UTF-8 error message.
+     */
+    public static final int STATUS_ERROR = 1;
+
+    /**
+     * Fixes classes sent to {@code input} until it is closed.
+     *
+     * <p>
+     * Every request is a big-endian {@code int} length followed by a class file.
+     * Every response is a status byte, a big-endian {@code int} length and the payload:
+     * the fixed class file for {@link #STATUS_OK}, or an error message for {@link #STATUS_ERROR}.
+     * A class that can't be fixed does not stop the loop.
+     * </p>
+     *
+     * @param input requests
+     * @param output responses, flushed after each one
+     */
+    public static void serve(DataInputStream input, DataOutputStream output) throws IOException {
+        while (true) {
+            int length;
+            try {
+                length = input.readInt();
+            } catch (EOFException e) {
+                return;
+            }
+            if (length < 0) {
+                throw new IOException("Negative class length: " + length);
+            }
+
+            byte[] inputBytes = new byte[length];
+            input.readFully(inputBytes);
+
+            byte[] payload;
+            int status;
+            try {
+                payload = fix(inputBytes);
+                status = STATUS_OK;
+            } catch (RuntimeException e) {
+                payload = String.valueOf(e).getBytes(StandardCharsets.UTF_8);
+                status = STATUS_ERROR;
+            }
+
+            output.writeByte(status);
+            output.writeInt(payload.length);
+            output.write(payload);
+            output.flush();
+        }
+    }
+
     public static void main(String[] args) throws Exception {
+            if (args.length == 1 && args[0].equals("--serve")) {
+                serve(new DataInputStream(new BufferedInputStream(System.in)),
+                        new DataOutputStream(new BufferedOutputStream(System.out)));
+                return;
+            }
+
             if (args.length != 2) {
-                System.err.println("Usage: FixClass <input> <output>");
+                System.err.println("Usage: FixClass <input> <output> | FixClass --serve");
                 System.exit(2);
             }
 
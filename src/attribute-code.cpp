@@ -1,8 +1,19 @@
 #include "jvm/attribute-code.h"
 
+#include <algorithm>
 #include <cassert>
+#include <memory>
+#include <optional>
+#include <set>
 #include <stdexcept>
-
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "jvm/class.h"
+#include "jvm/class-hierarchy.h"
+#include "jvm/constant-class.h"
 #include "jvm/constant-double.h"
 #include "jvm/constant-fieldref.h"
 #include "jvm/constant-methodref.h"
@@ -10,11 +21,19 @@
 #include "jvm/constant-float.h"
 #include "jvm/constant-integer.h"
 #include "jvm/constant-long.h"
+#include "jvm/constant-name-and-type.h"
 #include "jvm/constant-string.h"
+#include "jvm/constant-utf-8-info.h"
 #include "jvm/instruction-ldc.h"
 #include "jvm/instruction-value.h"
 #include "jvm/instruction-with-constant.h"
 #include "jvm/method.h"
+#include "jvm/internal/bytecode.h"
+#include "jvm/internal/dead-code-eliminator.h"
+#include "jvm/internal/frame-analyzer.h"
+#include "jvm/internal/jump-threader.h"
+#include "jvm/internal/method-outliner.h"
+#include "jvm/internal/peephole-optimizer.h"
 
 
 using namespace jvm;
@@ -24,38 +43,117 @@ if (!isFinalized()) { \
     throw std::logic_error("CodeAttribute is not finalized"); \
 }
 
+namespace
+{
+    /**
+     * @return Whether the opcode is one of the ldc family, selected by @ref InstructionLdc::update.
+     */
+    bool isLdc(Instruction::Command command)
+    {
+        return command == Instruction::INSTRUCTION_ldc || command == Instruction::INSTRUCTION_ldc_w
+            || command == Instruction::INSTRUCTION_ldc2_w;
+    }
+
+    /**
+     * @brief Get the descriptor of a field or method referenced by a constant.
+     * @return Descriptor, or an empty string if the constant does not reference a class member.
+     */
+    std::string getMemberDescriptor(const Constant* constant)
+    {
+        const ConstantNameAndType* nameAndType = nullptr;
+        switch (constant->getTag())
+        {
+        case Constant::CONSTANT_Fieldref:
+            nameAndType = static_cast<const ConstantFieldref*>(constant)->getNameAndType();
+            break;
+        case Constant::CONSTANT_Methodref:
+            nameAndType = static_cast<const ConstantMethodref*>(constant)->getNameAndType();
+            break;
+        case Constant::CONSTANT_InterfaceMethodref:
+            nameAndType = static_cast<const ConstantInterfaceMethodref*>(constant)->getNameAndType();
+            break;
+        default:
+            return {};
+        }
+        return nameAndType->getDescriptor()->getString();
+    }
+
+    /**
+     * @brief Convert inferred slot types to verification types, creating class constants as needed.
+     *
+     * @param owner Class owning the constant pool.
+     * @param slots Slot types; @c long and @c double are followed by a @c Top slot.
+     * @param trimTops Drop trailing @c Top types, as done for local variables.
+     * @return One verification type per value.
+     */
+    std::vector<AttributeStackMapTable::VerificationType> toVerificationTypes(
+        Class* owner, const std::vector<internal::FrameAnalyzer::Type>& slots, bool trimTops)
+    {
+        using VerificationType = AttributeStackMapTable::VerificationType;
+        using Type = internal::FrameAnalyzer::Type;
+
+        std::vector<VerificationType> types;
+        types.reserve(slots.size());
+        for (std::size_t i = 0; i < slots.size(); ++i)
+        {
+            const auto& slot = slots[i];
+            VerificationType type{static_cast<VerificationType::Tag>(slot.kind)};
+            if (slot.kind == Type::Object)
+            {
+                type.classConstant = owner->getOrCreateClassConstant(slot.className);
+            }
+            else if (slot.kind == Type::Uninitialized)
+            {
+                type.newInstruction = slot.newInstruction;
+            }
+            else if (slot.kind == Type::Long || slot.kind == Type::Double)
+            {
+                ++i; // second slot
+            }
+            types.push_back(type);
+        }
+
+        while (trimTops && !types.empty() && types.back().tag == VerificationType::ITEM_Top)
+        {
+            types.pop_back();
+        }
+        return types;
+    }
+}
+
 
 AttributeCode::~AttributeCode()
 {
+    // memory is released with the arena of the class
     for (auto* instruction : code_)
     {
-        delete instruction;
+        std::destroy_at(instruction);
     }
 
     for (auto* handler : exceptionHandlers_)
     {
-        delete handler;
+        std::destroy_at(handler);
     }
 
     for (auto* label : allRegisteredLabels_)
     {
-        delete label;
+        std::destroy_at(label);
     }
 
     for (auto* attribute : attributes_)
     {
-        delete attribute;
+        std::destroy_at(attribute);
     }
 }
 
 Instruction* AttributeCode::Nop()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_nop);
+    return create<Instruction>(this, Instruction::INSTRUCTION_nop);
 }
 
 Instruction* AttributeCode::PushNull()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_aconst_null);
+    return create<Instruction>(this, Instruction::INSTRUCTION_aconst_null);
 }
 
 Instruction* AttributeCode::PushInt(int32_t value)
@@ -63,33 +161,33 @@ Instruction* AttributeCode::PushInt(int32_t value)
     switch (value)
     {
     case -1:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_m1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_m1);
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_3);
     case 4:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_4);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_4);
     case 5:
-        return new Instruction(this, Instruction::INSTRUCTION_iconst_5);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iconst_5);
     default:
         {
             if (INT8_MIN <= value && value <= INT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_bipush, static_cast<int8_t>(value));
+                return create<InstructionValue<int8_t>>(this, Instruction::INSTRUCTION_bipush, static_cast<int8_t>(value));
             }
             if (INT16_MIN <= value && value <= INT16_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_sipush, static_cast<int16_t>(value));
+                return create<InstructionValue<int16_t>>(this, Instruction::INSTRUCTION_sipush, static_cast<int16_t>(value));
             }
             if (INT32_MIN <= value && value <= INT32_MAX)
             {
                 auto* integerConstant = getOwner()->getOwner()->getOrCreateIntegerConstant(value);
-                return new InstructionLdc(this, integerConstant);
+                return create<InstructionLdc>(this, integerConstant);
             }
             throw std::runtime_error("Unsupported integer value.");
         }
@@ -101,12 +199,12 @@ Instruction* AttributeCode::PushLong(int64_t value)
     switch (value)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_lconst_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lconst_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_lconst_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lconst_1);
     default:
         auto* longConstant = getOwner()->getOwner()->getOrCreateLongConstant(value);
-        return new InstructionLdc(this, longConstant);
+        return create<InstructionLdc>(this, longConstant);
     }
 }
 
@@ -114,37 +212,37 @@ Instruction* AttributeCode::PushFloat(float value)
 {
     if (value == 0)
     {
-        return new Instruction(this, Instruction::INSTRUCTION_fconst_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fconst_0);
     }
     if (value == 1)
     {
-        return new Instruction(this, Instruction::INSTRUCTION_fconst_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fconst_1);
     }
     if (value == 2)
     {
-        return new Instruction(this, Instruction::INSTRUCTION_fconst_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fconst_2);
     }
     auto* floatConstant = getOwner()->getOwner()->getOrCreateFloatConstant(value);
-    return new InstructionLdc(this, floatConstant);
+    return create<InstructionLdc>(this, floatConstant);
 }
 
 Instruction* AttributeCode::PushDouble(double value)
 {
     if (value == 0)
     {
-        return new Instruction(this, Instruction::INSTRUCTION_dconst_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dconst_0);
     }
     if (value == 1)
     {
-        return new Instruction(this, Instruction::INSTRUCTION_dconst_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dconst_1);
     }
     auto* doubleConstant = getOwner()->getOwner()->getOrCreateDoubleConstant(value);
-    return new InstructionLdc(this, doubleConstant);
+    return create<InstructionLdc>(this, doubleConstant);
 }
 
 Instruction* AttributeCode::PushString(ConstantString* stringConstant)
 {
-    return new InstructionLdc(this, stringConstant);
+    return create<InstructionLdc>(this, stringConstant);
 }
 
 Instruction* AttributeCode::PushString(const std::string& value)
@@ -158,22 +256,20 @@ Instruction* AttributeCode::LoadInt(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_iload_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iload_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_iload_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iload_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_iload_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iload_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_iload_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_iload_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_iload, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_iload, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_iload, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -183,22 +279,20 @@ Instruction* AttributeCode::LoadLong(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_lload_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lload_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_lload_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lload_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_lload_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lload_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_lload_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lload_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_lload, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_lload, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_lload, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -208,22 +302,20 @@ Instruction* AttributeCode::LoadFloat(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_fload_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fload_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_fload_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fload_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_fload_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fload_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_fload_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fload_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_fload, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_fload, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_fload, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -233,22 +325,20 @@ Instruction* AttributeCode::LoadDouble(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_dload_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dload_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_dload_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dload_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_dload_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dload_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_dload_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dload_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_dload, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_dload, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_dload, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -258,69 +348,67 @@ Instruction* AttributeCode::LoadReference(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_aload_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_aload_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_aload_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_aload_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_aload_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_aload_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_aload_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_aload_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_aload, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_aload, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_aload, Instruction::OPERAND_wide, index);
         }
     }
 }
 
 Instruction* AttributeCode::LoadBooleanFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_baload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_baload);
 }
 
 Instruction* AttributeCode::LoadByteFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_baload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_baload);
 }
 
 Instruction* AttributeCode::LoadCharFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_caload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_caload);
 }
 
 Instruction* AttributeCode::LoadShortFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_saload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_saload);
 }
 
 Instruction* AttributeCode::LoadIntFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_iaload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_iaload);
 }
 
 Instruction* AttributeCode::LoadLongFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_laload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_laload);
 }
 
 Instruction* AttributeCode::LoadFloatFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_faload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_faload);
 }
 
 Instruction* AttributeCode::LoadDoubleFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_daload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_daload);
 }
 
 Instruction* AttributeCode::LoadReferenceFromArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_aaload);
+    return create<Instruction>(this, Instruction::INSTRUCTION_aaload);
 }
 
 Instruction* AttributeCode::StoreInt(uint16_t index)
@@ -328,22 +416,20 @@ Instruction* AttributeCode::StoreInt(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_istore_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_istore_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_istore_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_istore_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_istore_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_istore_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_istore_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_istore_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_istore, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_istore, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_istore, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -353,22 +439,20 @@ Instruction* AttributeCode::StoreLong(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_lstore_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lstore_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_lstore_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lstore_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_lstore_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lstore_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_lstore_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_lstore_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_lstore, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_lstore, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_lstore, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -378,22 +462,20 @@ Instruction* AttributeCode::StoreFloat(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_fstore_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fstore_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_fstore_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fstore_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_fstore_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fstore_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_fstore_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fstore_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_fstore, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_fstore, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_fstore, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -403,22 +485,20 @@ Instruction* AttributeCode::StoreDouble(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_dstore_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dstore_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_dstore_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dstore_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_dstore_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dstore_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_dstore_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dstore_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_dstore, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_dstore, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_dstore, Instruction::OPERAND_wide, index);
         }
     }
 }
@@ -428,390 +508,387 @@ Instruction* AttributeCode::StoreReference(uint16_t index)
     switch (index)
     {
     case 0:
-        return new Instruction(this, Instruction::INSTRUCTION_astore_0);
+        return create<Instruction>(this, Instruction::INSTRUCTION_astore_0);
     case 1:
-        return new Instruction(this, Instruction::INSTRUCTION_astore_1);
+        return create<Instruction>(this, Instruction::INSTRUCTION_astore_1);
     case 2:
-        return new Instruction(this, Instruction::INSTRUCTION_astore_2);
+        return create<Instruction>(this, Instruction::INSTRUCTION_astore_2);
     case 3:
-        return new Instruction(this, Instruction::INSTRUCTION_astore_3);
+        return create<Instruction>(this, Instruction::INSTRUCTION_astore_3);
     default:
         {
             if (index <= UINT8_MAX)
             {
-                return new InstructionValue(this, Instruction::INSTRUCTION_astore, static_cast<uint8_t>(index));
+                return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_astore, static_cast<uint8_t>(index));
             }
-            // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-            throw std::logic_error("\"wide\" instruction not implemented yet.");
-            return new Instruction(this, Instruction::INSTRUCTION_wide);
+            return create<InstructionValue<uint16_t>>(this, Instruction::INSTRUCTION_astore, Instruction::OPERAND_wide, index);
         }
     }
 }
 
 Instruction* AttributeCode::StoreIntToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_iastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_iastore);
 }
 
 Instruction* AttributeCode::StoreLongToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lastore);
 }
 
 Instruction* AttributeCode::StoreFloatToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_fastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_fastore);
 }
 
 Instruction* AttributeCode::StoreDoubleToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dastore);
 }
 
 Instruction* AttributeCode::StoreReferenceToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_aastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_aastore);
 }
 
 Instruction* AttributeCode::StoreBooleanToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_bastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_bastore);
 }
 
 Instruction* AttributeCode::StoreByteToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_bastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_bastore);
 }
 
 Instruction* AttributeCode::StoreCharToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_castore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_castore);
 }
 
 Instruction* AttributeCode::StoreShortToArray()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_sastore);
+    return create<Instruction>(this, Instruction::INSTRUCTION_sastore);
 }
 
 Instruction* AttributeCode::PopOne()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_pop);
+    return create<Instruction>(this, Instruction::INSTRUCTION_pop);
 }
 
 Instruction* AttributeCode::PopTwo()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_pop2);
+    return create<Instruction>(this, Instruction::INSTRUCTION_pop2);
 }
 
 Instruction* AttributeCode::Duplicate()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dup);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dup);
 }
 
 Instruction* AttributeCode::DuplicateBeforeOne()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dup_x1);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dup_x1);
 }
 
 Instruction* AttributeCode::DuplicateBeforeTwo()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dup_x2);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dup_x2);
 }
 
 Instruction* AttributeCode::DuplicateDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dup2);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dup2);
 }
 
 Instruction* AttributeCode::DuplicateDoubleBeforeOne()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dup2_x1);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dup2_x1);
 }
 
 Instruction* AttributeCode::DuplicateDoubleBeforeTwo()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dup2_x2);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dup2_x2);
 }
 
 Instruction* AttributeCode::Swap()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_swap);
+    return create<Instruction>(this, Instruction::INSTRUCTION_swap);
 }
 
 Instruction* AttributeCode::AddInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_iadd);
+    return create<Instruction>(this, Instruction::INSTRUCTION_iadd);
 }
 
 Instruction* AttributeCode::AddLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ladd);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ladd);
 }
 
 Instruction* AttributeCode::AddFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_fadd);
+    return create<Instruction>(this, Instruction::INSTRUCTION_fadd);
 }
 
 Instruction* AttributeCode::AddDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dadd);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dadd);
 }
 
 Instruction* AttributeCode::SubInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_isub);
+    return create<Instruction>(this, Instruction::INSTRUCTION_isub);
 }
 
 Instruction* AttributeCode::SubLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lsub);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lsub);
 }
 
 Instruction* AttributeCode::SubFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_fsub);
+    return create<Instruction>(this, Instruction::INSTRUCTION_fsub);
 }
 
 Instruction* AttributeCode::SubDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dsub);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dsub);
 }
 
 Instruction* AttributeCode::MulInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_imul);
+    return create<Instruction>(this, Instruction::INSTRUCTION_imul);
 }
 
 Instruction* AttributeCode::MulLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lmul);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lmul);
 }
 
 Instruction* AttributeCode::MulFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_fmul);
+    return create<Instruction>(this, Instruction::INSTRUCTION_fmul);
 }
 
 Instruction* AttributeCode::MulDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dmul);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dmul);
 }
 
 Instruction* AttributeCode::DivInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_idiv);
+    return create<Instruction>(this, Instruction::INSTRUCTION_idiv);
 }
 
 Instruction* AttributeCode::DivLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ldiv);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ldiv);
 }
 
 Instruction* AttributeCode::DivFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_fdiv);
+    return create<Instruction>(this, Instruction::INSTRUCTION_fdiv);
 }
 
 Instruction* AttributeCode::DivDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ddiv);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ddiv);
 }
 
 Instruction* AttributeCode::RemInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_irem);
+    return create<Instruction>(this, Instruction::INSTRUCTION_irem);
 }
 
 Instruction* AttributeCode::RemLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lrem);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lrem);
 }
 
 Instruction* AttributeCode::RemFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_frem);
+    return create<Instruction>(this, Instruction::INSTRUCTION_frem);
 }
 
 Instruction* AttributeCode::RemDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_drem);
+    return create<Instruction>(this, Instruction::INSTRUCTION_drem);
 }
 
 Instruction* AttributeCode::NegInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ineg);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ineg);
 }
 
 Instruction* AttributeCode::NegLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lneg);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lneg);
 }
 
 Instruction* AttributeCode::NegFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_fneg);
+    return create<Instruction>(this, Instruction::INSTRUCTION_fneg);
 }
 
 Instruction* AttributeCode::NegDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dneg);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dneg);
 }
 
 Instruction* AttributeCode::LeftShiftInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ishl);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ishl);
 }
 
 Instruction* AttributeCode::RightArithmeticShiftInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ishr);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ishr);
 }
 
 Instruction* AttributeCode::RightLogicShiftInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_iushr);
+    return create<Instruction>(this, Instruction::INSTRUCTION_iushr);
 }
 
 Instruction* AttributeCode::LeftShiftLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lshl);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lshl);
 }
 
 Instruction* AttributeCode::RightArithmeticShiftLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lshr);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lshr);
 }
 
 Instruction* AttributeCode::RightLogicShiftLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lushr);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lushr);
 }
 
 Instruction* AttributeCode::BitwiseAndInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_iand);
+    return create<Instruction>(this, Instruction::INSTRUCTION_iand);
 }
 
 Instruction* AttributeCode::BitwiseAndLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_land);
+    return create<Instruction>(this, Instruction::INSTRUCTION_land);
 }
 
 Instruction* AttributeCode::BitwiseOrInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ior);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ior);
 }
 
 Instruction* AttributeCode::BitwiseOrLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lor);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lor);
 }
 
 Instruction* AttributeCode::BitwiseXorInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ixor);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ixor);
 }
 
 Instruction* AttributeCode::BitwiseXorLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lxor);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lxor);
 }
 
 Instruction* AttributeCode::IncrementLocalVariable(uint16_t index, int16_t value)
 {
     if (index <= UINT8_MAX && INT8_MIN <= value && value <= INT8_MAX)
     {
-        return new InstructionValue(
+        return create<InstructionValue<uint8_t, int8_t>>(
             this,
             Instruction::INSTRUCTION_iinc,
             static_cast<uint8_t>(index),
             static_cast<int8_t>(value)
         );
     }
-    // ToDo: Implement support for the "INSTRUCTION_wide" instruction
-    throw std::logic_error("\"wide\" instruction not implemented yet.");
-    return new Instruction(this, Instruction::INSTRUCTION_wide);
+    return create<InstructionValue<uint16_t, int16_t>>(this, Instruction::INSTRUCTION_iinc, Instruction::OPERAND_wide,
+                                                       index, value);
 }
 
 Instruction* AttributeCode::IntToLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_i2l);
+    return create<Instruction>(this, Instruction::INSTRUCTION_i2l);
 }
 
 Instruction* AttributeCode::IntToFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_i2f);
+    return create<Instruction>(this, Instruction::INSTRUCTION_i2f);
 }
 
 Instruction* AttributeCode::IntToDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_i2d);
+    return create<Instruction>(this, Instruction::INSTRUCTION_i2d);
 }
 
 Instruction* AttributeCode::LongToInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_l2i);
+    return create<Instruction>(this, Instruction::INSTRUCTION_l2i);
 }
 
 Instruction* AttributeCode::LongToFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_l2f);
+    return create<Instruction>(this, Instruction::INSTRUCTION_l2f);
 }
 
 Instruction* AttributeCode::LongToDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_l2d);
+    return create<Instruction>(this, Instruction::INSTRUCTION_l2d);
 }
 
 Instruction* AttributeCode::FloatToInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_f2i);
+    return create<Instruction>(this, Instruction::INSTRUCTION_f2i);
 }
 
 Instruction* AttributeCode::FloatToLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_f2l);
+    return create<Instruction>(this, Instruction::INSTRUCTION_f2l);
 }
 
 Instruction* AttributeCode::FloatToDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_f2d);
+    return create<Instruction>(this, Instruction::INSTRUCTION_f2d);
 }
 
 Instruction* AttributeCode::DoubleToInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_d2i);
+    return create<Instruction>(this, Instruction::INSTRUCTION_d2i);
 }
 
 Instruction* AttributeCode::DoubleToLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_d2l);
+    return create<Instruction>(this, Instruction::INSTRUCTION_d2l);
 }
 
 Instruction* AttributeCode::DoubleToFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_d2f);
+    return create<Instruction>(this, Instruction::INSTRUCTION_d2f);
 }
 
 Instruction* AttributeCode::IntToByte()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_i2b);
+    return create<Instruction>(this, Instruction::INSTRUCTION_i2b);
 }
 
 Instruction* AttributeCode::IntToChar()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_i2c);
+    return create<Instruction>(this, Instruction::INSTRUCTION_i2c);
 }
 
 Instruction* AttributeCode::IntToShort()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_i2s);
+    return create<Instruction>(this, Instruction::INSTRUCTION_i2s);
 }
 
 Instruction* AttributeCode::CompareLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lcmp);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lcmp);
 }
 
 Instruction* AttributeCode::CompareFloat(Instruction::StrictCompare nanResult)
@@ -819,9 +896,9 @@ Instruction* AttributeCode::CompareFloat(Instruction::StrictCompare nanResult)
     switch (nanResult)
     {
     case Instruction::Greater:
-        return new Instruction(this, Instruction::INSTRUCTION_fcmpg);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fcmpg);
     case Instruction::Less:
-        return new Instruction(this, Instruction::INSTRUCTION_fcmpl);
+        return create<Instruction>(this, Instruction::INSTRUCTION_fcmpl);
     default:
         throw std::runtime_error("Unknown instruction type");
     }
@@ -832,9 +909,9 @@ Instruction* AttributeCode::CompareDouble(Instruction::StrictCompare nanResult)
     switch (nanResult)
     {
     case Instruction::Greater:
-        return new Instruction(this, Instruction::INSTRUCTION_dcmpg);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dcmpg);
     case Instruction::Less:
-        return new Instruction(this, Instruction::INSTRUCTION_dcmpl);
+        return create<Instruction>(this, Instruction::INSTRUCTION_dcmpl);
     default:
         throw std::runtime_error("Unknown instruction type");
     }
@@ -845,17 +922,17 @@ InstructionJump* AttributeCode::If(Instruction::Compare operation, Label* label)
     switch (operation)
     {
     case Instruction::Equal:
-        return new InstructionJump(this, Instruction::INSTRUCTION_ifeq, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_ifeq, label);
     case Instruction::NotEqual:
-        return new InstructionJump(this, Instruction::INSTRUCTION_ifne, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_ifne, label);
     case Instruction::LessThan:
-        return new InstructionJump(this, Instruction::INSTRUCTION_iflt, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_iflt, label);
     case Instruction::GreaterThan:
-        return new InstructionJump(this, Instruction::INSTRUCTION_ifgt, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_ifgt, label);
     case Instruction::LessEqual:
-        return new InstructionJump(this, Instruction::INSTRUCTION_ifle, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_ifle, label);
     case Instruction::GreaterEqual:
-        return new InstructionJump(this, Instruction::INSTRUCTION_ifge, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_ifge, label);
     default:
         throw std::runtime_error("Unknown compare type.");
     }
@@ -866,17 +943,17 @@ InstructionJump* AttributeCode::IfWithCompare(Instruction::Compare operation, La
     switch (operation)
     {
     case Instruction::Equal:
-        return new InstructionJump(this, Instruction::INSTRUCTION_if_icmpeq, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_if_icmpeq, label);
     case Instruction::NotEqual:
-        return new InstructionJump(this, Instruction::INSTRUCTION_if_icmpne, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_if_icmpne, label);
     case Instruction::LessThan:
-        return new InstructionJump(this, Instruction::INSTRUCTION_if_icmplt, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_if_icmplt, label);
     case Instruction::GreaterThan:
-        return new InstructionJump(this, Instruction::INSTRUCTION_if_icmpgt, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_if_icmpgt, label);
     case Instruction::LessEqual:
-        return new InstructionJump(this, Instruction::INSTRUCTION_if_icmple, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_if_icmple, label);
     case Instruction::GreaterEqual:
-        return new InstructionJump(this, Instruction::INSTRUCTION_if_icmpge, label);
+        return create<InstructionJump>(this, Instruction::INSTRUCTION_if_icmpge, label);
     default:
         throw std::runtime_error("Unknown compare type.");
     }
@@ -884,87 +961,140 @@ InstructionJump* AttributeCode::IfWithCompare(Instruction::Compare operation, La
 
 InstructionJump* AttributeCode::IfReferenceEqual(Label* label)
 {
-    return new InstructionJump(this, Instruction::INSTRUCTION_if_acmpeq, label);
+    return create<InstructionJump>(this, Instruction::INSTRUCTION_if_acmpeq, label);
 }
 
 InstructionJump* AttributeCode::IfReferenceNotEqual(Label* label)
 {
-    return new InstructionJump(this, Instruction::INSTRUCTION_if_acmpne, label);
+    return create<InstructionJump>(this, Instruction::INSTRUCTION_if_acmpne, label);
 }
 
 InstructionJump* AttributeCode::GoTo(Label* label)
 {
-    // ToDo: Implement support for the "goto_w" instruction
-    return new InstructionJump(this, Instruction::INSTRUCTION_goto, label);
+    return create<InstructionJump>(this, Instruction::INSTRUCTION_goto, label);
 }
 
-Instruction* AttributeCode::Switch(int32_t low, int32_t high, Label* defaultLabel, const std::vector<Label*>& labels)
+InstructionSwitch* AttributeCode::Switch(int32_t low, int32_t high, Label* defaultLabel, const std::vector<Label*>& labels)
 {
-    // ToDo: Implement support for the "tableswitch" instruction
-    throw std::logic_error("Switch() not implemented yet.");
-    return new Instruction(this, Instruction::INSTRUCTION_tableswitch);
+    if (low > high || labels.size() != static_cast<uint64_t>(static_cast<int64_t>(high) - low + 1))
+    {
+        throw std::invalid_argument("Switch labels don't match the key range.");
+    }
+    if (defaultLabel == nullptr || std::find(labels.begin(), labels.end(), nullptr) != labels.end())
+    {
+        throw std::invalid_argument("Switch label is null.");
+    }
+    if (labels.size() > InstructionSwitch::maxTableCases)
+    {
+        throw std::invalid_argument("Too many switch cases.");
+    }
+
+    std::pmr::vector<Label*> tableLabels(labels.begin(), labels.end(), memoryResource_);
+    return create<InstructionSwitch>(this, defaultLabel, low, std::move(tableLabels));
 }
 
-Instruction* AttributeCode::Switch(Label* defaultLabel, const std::map<int32_t, Label*>& labels)
+InstructionSwitch* AttributeCode::Switch(Label* defaultLabel, const std::map<int32_t, Label*>& labels)
 {
-    // ToDo: Implement support for the "lookupswitch" instruction
-    throw std::logic_error("Switch() not implemented yet.");
-    return new Instruction(this, Instruction::INSTRUCTION_lookupswitch);
+    if (defaultLabel == nullptr)
+    {
+        throw std::invalid_argument("Switch label is null.");
+    }
+
+    // javac cost model: a table is dense, but pays for missing keys
+    if (!labels.empty())
+    {
+        int64_t low = labels.begin()->first;
+        int64_t high = labels.rbegin()->first;
+        auto caseCount = static_cast<int64_t>(labels.size());
+        int64_t tableSpaceCost = 4 + (high - low + 1);
+        int64_t tableTimeCost = 3;
+        int64_t lookupSpaceCost = 3 + 2 * caseCount;
+        int64_t lookupTimeCost = caseCount;
+        bool isTableEncodable = high - low + 1 <= static_cast<int64_t>(InstructionSwitch::maxTableCases);
+        if (isTableEncodable && tableSpaceCost + 3 * tableTimeCost <= lookupSpaceCost + 3 * lookupTimeCost)
+        {
+            std::vector<Label*> tableLabels(static_cast<std::size_t>(high - low + 1), defaultLabel);
+            for (const auto& [key, label] : labels)
+            {
+                tableLabels[static_cast<std::size_t>(key - low)] = label;
+            }
+            return Switch(static_cast<int32_t>(low), static_cast<int32_t>(high), defaultLabel, tableLabels);
+        }
+    }
+
+    if (labels.size() > InstructionSwitch::maxLookupCases)
+    {
+        throw std::invalid_argument("Too many switch cases.");
+    }
+    std::pmr::vector<int32_t> keys(memoryResource_);
+    std::pmr::vector<Label*> lookupLabels(memoryResource_);
+    keys.reserve(labels.size());
+    lookupLabels.reserve(labels.size());
+    for (const auto& [key, label] : labels)
+    {
+        if (label == nullptr)
+        {
+            throw std::invalid_argument("Switch label is null.");
+        }
+        keys.push_back(key);
+        lookupLabels.push_back(label);
+    }
+    return create<InstructionSwitch>(this, defaultLabel, std::move(keys), std::move(lookupLabels));
 }
 
 Instruction* AttributeCode::ReturnBoolean()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ireturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ireturn);
 }
 
 Instruction* AttributeCode::ReturnByte()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ireturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ireturn);
 }
 
 Instruction* AttributeCode::ReturnChar()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ireturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ireturn);
 }
 
 Instruction* AttributeCode::ReturnShort()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ireturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ireturn);
 }
 
 Instruction* AttributeCode::ReturnInt()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_ireturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_ireturn);
 }
 
 Instruction* AttributeCode::ReturnLong()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_lreturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_lreturn);
 }
 
 Instruction* AttributeCode::ReturnFloat()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_freturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_freturn);
 }
 
 Instruction* AttributeCode::ReturnDouble()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_dreturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_dreturn);
 }
 
 Instruction* AttributeCode::ReturnReference()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_areturn);
+    return create<Instruction>(this, Instruction::INSTRUCTION_areturn);
 }
 
 Instruction* AttributeCode::ReturnVoid()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_return);
+    return create<Instruction>(this, Instruction::INSTRUCTION_return);
 }
 
 Instruction* AttributeCode::GetStatic(ConstantFieldref* field)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_getstatic,
         field,
@@ -974,7 +1104,7 @@ Instruction* AttributeCode::GetStatic(ConstantFieldref* field)
 
 Instruction* AttributeCode::PutStatic(ConstantFieldref* field)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_putstatic,
         field,
@@ -984,7 +1114,7 @@ Instruction* AttributeCode::PutStatic(ConstantFieldref* field)
 
 Instruction* AttributeCode::GetField(ConstantFieldref* field)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_getfield,
         field,
@@ -994,7 +1124,7 @@ Instruction* AttributeCode::GetField(ConstantFieldref* field)
 
 Instruction* AttributeCode::PutField(ConstantFieldref* field)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_putfield,
         field,
@@ -1004,7 +1134,7 @@ Instruction* AttributeCode::PutField(ConstantFieldref* field)
 
 Instruction* AttributeCode::InvokeVirtual(ConstantMethodref* method)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_invokevirtual,
         method,
@@ -1014,7 +1144,7 @@ Instruction* AttributeCode::InvokeVirtual(ConstantMethodref* method)
 
 Instruction* AttributeCode::InvokeSpecial(ConstantMethodref* method)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_invokespecial,
         method,
@@ -1024,7 +1154,7 @@ Instruction* AttributeCode::InvokeSpecial(ConstantMethodref* method)
 
 Instruction* AttributeCode::InvokeStatic(ConstantMethodref* method)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_invokestatic,
         method,
@@ -1034,7 +1164,7 @@ Instruction* AttributeCode::InvokeStatic(ConstantMethodref* method)
 
 Instruction* AttributeCode::InvokeInterface(ConstantInterfaceMethodref* method)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_invokeinterface,
         method,
@@ -1044,7 +1174,7 @@ Instruction* AttributeCode::InvokeInterface(ConstantInterfaceMethodref* method)
 
 Instruction* AttributeCode::New(ConstantClass* classConstant)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_new,
         classConstant,
@@ -1054,12 +1184,12 @@ Instruction* AttributeCode::New(ConstantClass* classConstant)
 
 Instruction* AttributeCode::NewArray(Instruction::Type type)
 {
-    return new InstructionValue(this, Instruction::INSTRUCTION_newarray, static_cast<uint8_t>(type));
+    return create<InstructionValue<uint8_t>>(this, Instruction::INSTRUCTION_newarray, static_cast<uint8_t>(type));
 }
 
 Instruction* AttributeCode::NewArray(ConstantClass* classConstant)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_anewarray,
         classConstant,
@@ -1069,17 +1199,17 @@ Instruction* AttributeCode::NewArray(ConstantClass* classConstant)
 
 Instruction* AttributeCode::ArrayLength()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_arraylength);
+    return create<Instruction>(this, Instruction::INSTRUCTION_arraylength);
 }
 
 Instruction* AttributeCode::Throw()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_athrow);
+    return create<Instruction>(this, Instruction::INSTRUCTION_athrow);
 }
 
 Instruction* AttributeCode::CheckCast(ConstantClass* classConstant)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_checkcast,
         classConstant,
@@ -1089,7 +1219,7 @@ Instruction* AttributeCode::CheckCast(ConstantClass* classConstant)
 
 Instruction* AttributeCode::InstanceOf(ConstantClass* classConstant)
 {
-    return new InstructionWithConstant(
+    return create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_instanceof,
         classConstant,
@@ -1099,12 +1229,12 @@ Instruction* AttributeCode::InstanceOf(ConstantClass* classConstant)
 
 Instruction* AttributeCode::MonitorEnter()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_monitorenter);
+    return create<Instruction>(this, Instruction::INSTRUCTION_monitorenter);
 }
 
 Instruction* AttributeCode::MonitorExit()
 {
-    return new Instruction(this, Instruction::INSTRUCTION_monitorexit);
+    return create<Instruction>(this, Instruction::INSTRUCTION_monitorexit);
 }
 
 Instruction* AttributeCode::MultiNewArray(ConstantClass* classConstant, uint8_t dimensions)
@@ -1114,7 +1244,7 @@ Instruction* AttributeCode::MultiNewArray(ConstantClass* classConstant, uint8_t
         throw std::invalid_argument("Dimensions count must be greater than zero.");
     }
 
-    auto* instruction = new InstructionWithConstant(
+    auto* instruction = create<InstructionWithConstant>(
         this,
         Instruction::INSTRUCTION_multianewarray,
         classConstant,
@@ -1127,12 +1257,12 @@ Instruction* AttributeCode::MultiNewArray(ConstantClass* classConstant, uint8_t
 
 InstructionJump* AttributeCode::IfNull(Label* label)
 {
-    return new InstructionJump(this, Instruction::INSTRUCTION_ifnull, label);
+    return create<InstructionJump>(this, Instruction::INSTRUCTION_ifnull, label);
 }
 
 InstructionJump* AttributeCode::IfNotNull(Label* label)
 {
-    return new InstructionJump(this, Instruction::INSTRUCTION_ifnonnull, label);
+    return create<InstructionJump>(this, Instruction::INSTRUCTION_ifnonnull, label);
 }
 
 AttributeCode& AttributeCode::addInstruction(Instruction* instruction)
@@ -1154,7 +1284,7 @@ AttributeCode& AttributeCode::addInstruction(Instruction* instruction)
 
 Label* AttributeCode::CodeLabel()
 {
-    return new Label(this);
+    return create<Label>(this);
 }
 
 AttributeCode& AttributeCode::addLabel(Label* label)
@@ -1179,48 +1309,45 @@ AttributeCode& AttributeCode::addLabel(Label* label)
 ExceptionHandler* AttributeCode::addTryCatch(Label* tryStartLabel, Label* tryFinishLabel, Label* catchStartLabel,
                                              ConstantClass* catchClass)
 {
-    auto* handler = new ExceptionHandler(tryStartLabel, tryFinishLabel, catchStartLabel, catchClass, this);
+    auto* handler = create<ExceptionHandler>(tryStartLabel, tryFinishLabel, catchStartLabel, catchClass, this);
     exceptionHandlers_.insert(handler);
     return handler;
 }
 
-void AttributeCode::writeTo(std::ostream& os) const
+void AttributeCode::writeTo(ByteWriter& writer) const
 {
     REQUIRE_FINALIZED();
 
-    Attribute::writeTo(os);
+    Attribute::writeTo(writer);
 
     // u2 max_stack;
-    internal::Utils::writeBigEndian(os, static_cast<uint16_t>(maxStack_));
+    writer.writeBigEndian(static_cast<uint16_t>(maxStack_));
 
     // u2 max_locals;
-    internal::Utils::writeBigEndian(os, static_cast<uint16_t>(maxLocals_));
+    writer.writeBigEndian(static_cast<uint16_t>(maxLocals_));
 
     // u4 code_length;
-    internal::Utils::writeBigEndian(os, static_cast<uint32_t>(instructionsByteSize_));
+    writer.writeBigEndian(static_cast<uint32_t>(instructionsByteSize_));
 
     // u1 code[code_length];
-    for (auto* instruction : code_)
-    {
-        os << *instruction;
-    }
+    writer.writeBytes(bytecode_.data(), bytecode_.size());
 
     // u2 exception_table_length;
-    internal::Utils::writeBigEndian(os, static_cast<uint16_t>(exceptionHandlers_.size()));
+    writer.writeBigEndian(static_cast<uint16_t>(exceptionHandlers_.size()));
 
     // exception_table[exception_table_length];
     for (auto* handler : exceptionHandlers_)
     {
-        os << *handler;
+        writer << *handler;
     }
 
     // u2 attributes_count;
-    internal::Utils::writeBigEndian(os, static_cast<uint16_t>(attributes_.size()));
+    writer.writeBigEndian(static_cast<uint16_t>(attributes_.size()));
 
     // attribute_info attributes[attributes_count];
     for (auto* attribute : attributes_)
     {
-        os << *attribute;
+        writer << *attribute;
     }
 }
 
@@ -1264,7 +1391,11 @@ size_t AttributeCode::getContentSizeInBytes() const
 
 AttributeCode::AttributeCode(Method* methodOwner) :
     Attribute(methodOwner->getOwner()->getOrCreateUtf8Constant("Code")),
-    ClassFileElement(methodOwner)
+    ClassFileElement(methodOwner),
+    memoryResource_(methodOwner->getOwner()->getMemoryResource()),
+    bytecode_(memoryResource_),
+    constantFixups_(memoryResource_),
+    labelFixups_(memoryResource_)
 {
 }
 
@@ -1273,15 +1404,60 @@ std::size_t AttributeCode::getByteSize() const
     return Attribute::getByteSize();
 }
 
+std::size_t AttributeCode::optimize(OptLevel level)
+{
+    if (isFinalized())
+    {
+        throw std::logic_error("Attribute code has already finished. It cannot be optimized.");
+    }
+
+    std::size_t size = getUnlaidSize();
+    if (level >= OPT_jumps)
+    {
+        internal::JumpThreader(*this).run();
+    }
+    if (level >= OPT_unreachable)
+    {
+        internal::DeadCodeEliminator(*this).run();
+    }
+    if (level >= OPT_peephole)
+    {
+        internal::PeepholeOptimizer(*this).run();
+    }
+    return size - getUnlaidSize();
+}
+
+std::vector<Method*> AttributeCode::outline(std::size_t maxSize)
+{
+    if (isFinalized())
+    {
+        throw std::logic_error("Attribute code has already finished. It cannot be outlined.");
+    }
+
+    return internal::MethodOutliner(*this, maxSize).run();
+}
+
 bool AttributeCode::isFinalized() const
 {
     return isFinalized_;
 }
 
 void AttributeCode::finalize()
+{
+    finalize(getOwner()->getOwner()->getFinalizer().getAnalysis());
+}
+
+void AttributeCode::finalize(ClassFinalizer::Analysis analysis)
 {
     // return if already finalized
-    if (isFinalized()) { return; }
+    if (isFinalized())
+    {
+        if (analysis > analysis_)
+        {
+            throw std::logic_error("CodeAttribute is already finalized with a weaker analysis.");
+        }
+        return;
+    }
 
     // check for unlinked labels
     if (!labelsOnCurrentStep_.empty())
@@ -1290,29 +1466,52 @@ void AttributeCode::finalize()
             "The most recently added labels do not have instructions after them. The class cannot complete initialization.");
     }
 
-    // update instructions with constants from constant pool
+    // select ldc or ldc_w from constant indices, other constant instructions don't depend on them
     for (auto* instruction : code_)
     {
-        auto* constantInstruction = dynamic_cast<InstructionWithConstant*>(instruction);
-        if (constantInstruction != nullptr)
+        if (instruction->operandKind_ == Instruction::OPERAND_constant && isLdc(instruction->command_))
         {
-            constantInstruction->update();
+            static_cast<InstructionLdc*>(instruction)->update();
         }
     }
 
+    // compute stack map frames, merging references to java/lang/Object without a class hierarchy
+    std::optional<StackMap> stackMap;
+    if (analysis >= ClassFinalizer::Frames)
+    {
+        static const SimpleClassHierarchy objectHierarchy;
+        const ClassHierarchy* hierarchy = getOwner()->getOwner()->getClassHierarchy();
+        // code after a widened conditional jump is a branch target that needs a frame;
+        // replacing unreachable code shrinks it, so with room for switch padding no other jump is widened afterward
+        layOutInstructions(true);
+        stackMap = computeStackMap(hierarchy != nullptr ? *hierarchy : objectHierarchy);
+    }
+
     // set index to all instructions
-    // calculate size of all instructions
-    instructionsByteSize_ = 0;
-    for (auto* instruction : code_)
+    layOutInstructions();
+
+    // check against the JIT limits before max stack, bytecode and attributes are set, so a caught error leaves
+    // the attribute unfinalized; the code only differs by unreachable runs replaced for frames
+    getOwner()->getOwner()->getMethodSizeLimits().check(getOwner(), instructionsByteSize_);
+
+    // calculate max stack and max locals
+    if (analysis >= ClassFinalizer::Maxs)
     {
-        instruction->setIndex(instructionsByteSize_);
-        instructionsByteSize_ += instruction->getByteSize();
+        computeMaxStackAndLocals();
     }
 
-    // check code size
-    if (instructionsByteSize_ > UINT16_MAX)
+    // pack instructions into contiguous bytecode
+    encodeBytecode();
+
+    // encode stack map frames at their offsets
+    if (stackMap && !stackMap->frames.empty())
     {
-        throw std::runtime_error("Too large instructions size.");
+        if (stackMap->hasReplacedCode)
+        {
+            // athrow replacing unreachable code has the exception on the stack
+            maxStack_ = std::max<uint16_t>(maxStack_, 1);
+        }
+        attributes_.insert(create<AttributeStackMapTable>(this, stackMap->initialLocals, stackMap->frames));
     }
 
     // calculate size of all exceptions handlers
@@ -1325,5 +1524,630 @@ void AttributeCode::finalize()
     }
 
     // finalize code attribute
+    analysis_ = analysis;
     isFinalized_ = true;
 }
+
+AttributeCode::StackMap AttributeCode::computeStackMap(const ClassHierarchy& hierarchy)
+{
+    using VerificationType = AttributeStackMapTable::VerificationType;
+
+    internal::FrameAnalyzer analyzer(*this, hierarchy);
+    analyzer.analyze();
+
+    Class* owner = getOwner()->getOwner();
+    StackMap stackMap;
+    stackMap.initialLocals = toVerificationTypes(owner, analyzer.getInitialFrame().locals, true);
+
+    // keep reachable instructions, replace each unreachable run with athrow
+    std::vector<Instruction*> code;
+    code.reserve(code_.size());
+    std::vector<Instruction*> unreachable;
+    std::unordered_map<const Instruction*, Instruction*> replacements;
+    std::unordered_set<const Instruction*> throws;
+    for (std::size_t i = 0; i < code_.size(); ++i)
+    {
+        Instruction* instruction = code_[i];
+        if (analyzer.isReachable(i))
+        {
+            code.push_back(instruction);
+            if (const auto& frame = analyzer.getFrame(i))
+            {
+                stackMap.frames.push_back({
+                    instruction,
+                    toVerificationTypes(owner, frame->locals, true),
+                    toVerificationTypes(owner, frame->stack, false)
+                });
+            }
+            continue;
+        }
+
+        if (i == 0 || analyzer.isReachable(i - 1))
+        {
+            Instruction* replacement = Throw();
+            code.push_back(replacement);
+            throws.insert(replacement);
+            stackMap.frames.push_back({
+                replacement,
+                {},
+                {{VerificationType::ITEM_Object, owner->getOrCreateClassConstant("java/lang/Throwable")}}
+            });
+        }
+        replacements.emplace(instruction, code.back());
+        unreachable.push_back(instruction);
+    }
+    if (unreachable.empty())
+    {
+        return stackMap;
+    }
+    stackMap.hasReplacedCode = true;
+
+    for (auto* label : allRegisteredLabels_)
+    {
+        auto replacement = replacements.find(label->instruction_);
+        if (replacement != replacements.end())
+        {
+            label->instruction_ = replacement->second;
+        }
+    }
+    for (auto* instruction : unreachable)
+    {
+        std::destroy_at(instruction);
+    }
+    code_ = std::move(code);
+
+    // exclude athrow replacements from exception handler ranges
+    std::unordered_map<const Instruction*, std::size_t> positions;
+    positions.reserve(code_.size());
+    for (std::size_t i = 0; i < code_.size(); ++i)
+    {
+        positions.emplace(code_[i], i);
+    }
+    auto createLabel = [this](std::size_t position)
+    {
+        auto* label = create<Label>(this);
+        label->instruction_ = code_[position];
+        allRegisteredLabels_.insert(label);
+        return label;
+    };
+
+    std::set<ExceptionHandler*> handlers;
+    for (auto* handler : exceptionHandlers_)
+    {
+        // the handler is unreachable if it protects only unreachable code
+        if (throws.contains(handler->getCatchStartLabel()->getInstruction()))
+        {
+            std::destroy_at(handler);
+            continue;
+        }
+
+        std::size_t start = positions.at(handler->getTryStartLabel()->getInstruction());
+        std::size_t end = positions.at(handler->getTryFinishLabel()->getInstruction());
+        bool isSplit = false;
+        std::size_t pieceStart = start;
+        for (std::size_t i = start; i <= end; ++i)
+        {
+            if (i < end && !throws.contains(code_[i]))
+            {
+                continue;
+            }
+            if (i < end)
+            {
+                isSplit = true;
+            }
+            if (isSplit && pieceStart < i)
+            {
+                handlers.insert(create<ExceptionHandler>(createLabel(pieceStart), createLabel(i),
+                                                     handler->getCatchStartLabel(), handler->getCatchClass(), this));
+            }
+            pieceStart = i + 1;
+        }
+
+        if (isSplit)
+        {
+            std::destroy_at(handler);
+        }
+        else
+        {
+            handlers.insert(handler);
+        }
+    }
+    exceptionHandlers_ = std::move(handlers);
+
+    return stackMap;
+}
+
+uint16_t AttributeCode::getMaxStack() const
+{
+    REQUIRE_FINALIZED();
+    return maxStack_;
+}
+
+uint16_t AttributeCode::getMaxLocals() const
+{
+    REQUIRE_FINALIZED();
+    return maxLocals_;
+}
+
+std::span<const std::byte> AttributeCode::getBytecode() const
+{
+    REQUIRE_FINALIZED();
+    return bytecode_;
+}
+
+MethodSizeReport AttributeCode::getSizeReport() const
+{
+    REQUIRE_FINALIZED();
+    return getOwner()->getOwner()->getMethodSizeLimits().report(getOwner(), bytecode_.size());
+}
+
+std::span<Instruction* const> AttributeCode::getInstructions() const noexcept
+{
+    return code_;
+}
+
+void AttributeCode::layOutInstructions(bool isTentative)
+{
+    bool isWidened = true;
+    while (isWidened)
+    {
+        // set index to all instructions
+        // calculate size of all instructions
+        uint32_t codeSize = 0;
+        uint32_t switchCount = 0;
+        for (auto* instruction : code_)
+        {
+            instruction->setIndex(static_cast<uint16_t>(codeSize));
+            if (instruction->operandKind_ == Instruction::OPERAND_switch)
+            {
+                static_cast<InstructionSwitch*>(instruction)->updatePadding();
+                ++switchCount;
+            }
+            codeSize += instruction->byteSize_;
+        }
+
+        // check code size
+        if (codeSize > UINT16_MAX)
+        {
+            throw std::runtime_error("Too large instructions size.");
+        }
+        instructionsByteSize_ = static_cast<uint16_t>(codeSize);
+
+        // the padding of every switch may still grow when code before it shrinks
+        int32_t reserve = isTentative ? static_cast<int32_t>(InstructionSwitch::maxPadding * switchCount) : 0;
+
+        // widen jumps to targets out of range
+        isWidened = false;
+        for (auto* instruction : code_)
+        {
+            if (instruction->operandKind_ != Instruction::OPERAND_jump)
+            {
+                continue;
+            }
+            auto* jump = static_cast<InstructionJump*>(instruction);
+            const Instruction* target = jump->getJumpLabel()->getInstruction();
+            if (jump->isWide() || target == nullptr)
+            {
+                continue;
+            }
+            int32_t shift = static_cast<int32_t>(target->getIndex()) - jump->getIndex();
+            if (shift < INT16_MIN + reserve || shift > INT16_MAX - reserve)
+            {
+                jump->widen();
+                isWidened = true;
+            }
+        }
+    }
+}
+
+void AttributeCode::removeEmptyExceptionHandlers()
+{
+    for (auto it = exceptionHandlers_.begin(); it != exceptionHandlers_.end();)
+    {
+        auto* handler = *it;
+        if (handler->getTryStartLabel()->getInstruction() == handler->getTryFinishLabel()->getInstruction())
+        {
+            it = exceptionHandlers_.erase(it);
+            std::destroy_at(handler);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+std::size_t AttributeCode::getUnlaidSize() const
+{
+    return getUnlaidSize(0, code_.size());
+}
+
+std::size_t AttributeCode::getUnlaidSize(std::size_t first, std::size_t last) const
+{
+    std::size_t size = 0;
+    for (std::size_t i = first; i < last; ++i)
+    {
+        size += code_[i]->getByteSize();
+    }
+    return size;
+}
+
+void AttributeCode::moveTo(AttributeCode& target, std::size_t first, std::size_t last,
+                           std::span<ExceptionHandler* const> handlers)
+{
+    auto begin = code_.begin() + static_cast<std::ptrdiff_t>(first);
+    auto end = code_.begin() + static_cast<std::ptrdiff_t>(last);
+    std::unordered_set<const Instruction*> moved(begin, end);
+    for (auto it = begin; it != end; ++it)
+    {
+        (*it)->setOwner(&target);
+        target.code_.push_back(*it);
+    }
+    code_.erase(begin, end);
+
+    for (auto it = allRegisteredLabels_.begin(); it != allRegisteredLabels_.end();)
+    {
+        Label* label = *it;
+        if (moved.contains(label->getInstruction()))
+        {
+            label->setOwner(&target);
+            target.allRegisteredLabels_.insert(label);
+            it = allRegisteredLabels_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    for (auto* handler : handlers)
+    {
+        exceptionHandlers_.erase(handler);
+        handler->setOwner(&target);
+        target.exceptionHandlers_.insert(handler);
+    }
+}
+
+void AttributeCode::encodeBytecode()
+{
+    bytecode_.resize(instructionsByteSize_);
+    constantFixups_.clear();
+    labelFixups_.clear();
+
+    ByteWriter writer(bytecode_);
+    for (auto* instruction : code_)
+    {
+        writer.writeBigEndian(static_cast<uint8_t>(instruction->command_));
+        switch (instruction->operandKind_)
+        {
+        case Instruction::OPERAND_none:
+            break;
+        case Instruction::OPERAND_value:
+            writer.writeBytes(instruction->immediates_.data(), instruction->byteSize_ - 1);
+            break;
+        case Instruction::OPERAND_wide:
+            bytecode_[instruction->getIndex()] = static_cast<std::byte>(Instruction::INSTRUCTION_wide);
+            writer.writeBigEndian(static_cast<uint8_t>(instruction->command_));
+            writer.writeBytes(instruction->immediates_.data(), instruction->byteSize_ - 2);
+            break;
+        case Instruction::OPERAND_jump:
+            {
+                auto* jump = static_cast<InstructionJump*>(instruction);
+                uint16_t source = jump->getIndex();
+                if (jump->byteSize_ == InstructionJump::shortSize)
+                {
+                    labelFixups_.push_back({static_cast<uint32_t>(writer.size()), source, jump->getJumpLabel(), false});
+                    writer.writeBigEndian(static_cast<uint16_t>(0));
+                    break;
+                }
+                if (jump->byteSize_ == InstructionJump::wideConditionalSize)
+                {
+                    // inverted jump over a goto_w to the target
+                    bytecode_[source] = static_cast<std::byte>(internal::Bytecode::getInvertedJump(jump->command_));
+                    writer.writeBigEndian(static_cast<uint16_t>(InstructionJump::wideConditionalSize));
+                    writer.writeBigEndian(static_cast<uint8_t>(Instruction::INSTRUCTION_goto_w));
+                    source += InstructionJump::shortSize;
+                }
+                labelFixups_.push_back({static_cast<uint32_t>(writer.size()), source, jump->getJumpLabel(), true});
+                writer.writeBigEndian(static_cast<uint32_t>(0));
+                break;
+            }
+        case Instruction::OPERAND_constant:
+            {
+                auto* constantInstruction = static_cast<InstructionWithConstant*>(instruction);
+                bool isWide = constantInstruction->size_ == InstructionWithConstant::TwoByte;
+                constantFixups_.push_back({static_cast<uint32_t>(writer.size()), constantInstruction->getConstant(), isWide});
+                if (isWide)
+                {
+                    writer.writeBigEndian(static_cast<uint16_t>(0));
+                }
+                else
+                {
+                    writer.writeBigEndian(static_cast<uint8_t>(0));
+                }
+                if (constantInstruction->hasTrailingByte_)
+                {
+                    writer.writeBigEndian(constantInstruction->trailingByte_);
+                }
+                break;
+            }
+        case Instruction::OPERAND_switch:
+            {
+                // offsets are relative to the opcode
+                auto* switchInstruction = static_cast<InstructionSwitch*>(instruction);
+                uint16_t source = switchInstruction->getIndex();
+                auto addOffset = [this, &writer, source](const Label* label)
+                {
+                    labelFixups_.push_back({static_cast<uint32_t>(writer.size()), source, label, true});
+                    writer.writeBigEndian(static_cast<uint32_t>(0));
+                };
+
+                for (uint32_t i = 0; i < switchInstruction->getPadding(); ++i)
+                {
+                    writer.writeBigEndian(static_cast<uint8_t>(0));
+                }
+                addOffset(switchInstruction->getDefaultLabel());
+                auto labels = switchInstruction->getLabels();
+                if (switchInstruction->command_ == Instruction::INSTRUCTION_tableswitch)
+                {
+                    writer.writeBigEndian(static_cast<uint32_t>(switchInstruction->getKey(0)));
+                    writer.writeBigEndian(static_cast<uint32_t>(switchInstruction->getKey(labels.size() - 1)));
+                    for (const auto* label : labels)
+                    {
+                        addOffset(label);
+                    }
+                }
+                else
+                {
+                    writer.writeBigEndian(static_cast<uint32_t>(labels.size()));
+                    for (std::size_t i = 0; i < labels.size(); ++i)
+                    {
+                        writer.writeBigEndian(static_cast<uint32_t>(switchInstruction->getKey(i)));
+                        addOffset(labels[i]);
+                    }
+                }
+                break;
+            }
+        }
+    }
+    assert(writer.size() == bytecode_.size());
+
+    resolveFixups();
+}
+
+void AttributeCode::resolveFixups()
+{
+    auto writeU2 = [this](uint32_t offset, uint16_t value)
+    {
+        bytecode_[offset] = static_cast<std::byte>(value >> 8);
+        bytecode_[offset + 1] = static_cast<std::byte>(value);
+    };
+
+    for (const auto& fixup : constantFixups_)
+    {
+        uint16_t index = fixup.constant->getIndex();
+        if (fixup.isWide)
+        {
+            writeU2(fixup.offset, index);
+        }
+        else if (index <= UINT8_MAX)
+        {
+            bytecode_[fixup.offset] = static_cast<std::byte>(index);
+        }
+        else
+        {
+            throw std::out_of_range("Constant index bigger then available reference size.");
+        }
+    }
+
+    for (const auto& fixup : labelFixups_)
+    {
+        const Instruction* target = fixup.label->getInstruction();
+        if (target == nullptr)
+        {
+            throw std::logic_error("Jump label is not bound to any instruction.");
+        }
+        int32_t shift = static_cast<int32_t>(target->getIndex()) - fixup.source;
+        if (fixup.isWide)
+        {
+            writeU2(fixup.offset, static_cast<uint16_t>(static_cast<uint32_t>(shift) >> 16));
+            writeU2(fixup.offset + 2, static_cast<uint16_t>(shift));
+        }
+        else
+        {
+            assert(INT16_MIN <= shift && shift <= INT16_MAX);
+            writeU2(fixup.offset, static_cast<uint16_t>(shift));
+        }
+    }
+}
+
+int32_t AttributeCode::getStackDelta(const Instruction* instruction) const
+{
+    using internal::Bytecode;
+
+    auto command = instruction->getCommandCode();
+    int8_t delta = Bytecode::getStackDelta(command);
+    if (delta != Bytecode::variableStackDelta)
+    {
+        return delta;
+    }
+
+    if (instruction->operandKind_ != Instruction::OPERAND_constant)
+    {
+        throw std::logic_error("Unsupported instruction in code attribute.");
+    }
+    const auto* constantInstruction = static_cast<const InstructionWithConstant*>(instruction);
+
+    if (command == Instruction::INSTRUCTION_multianewarray)
+    {
+        // pop dimensions, push array
+        return 1 - static_cast<int32_t>(constantInstruction->trailingByte_);
+    }
+
+    return Bytecode::getMemberStackDelta(command, getMemberDescriptor(constantInstruction->getConstant()));
+}
+
+uint32_t AttributeCode::getLocalsEnd(const Instruction* instruction) const
+{
+    using internal::Bytecode;
+
+    auto command = instruction->getCommandCode();
+    uint8_t slots = Bytecode::getLocalSlots(command);
+    if (slots == 0)
+    {
+        return 0;
+    }
+
+    int8_t implicitIndex = Bytecode::getImplicitLocalIndex(command);
+    if (implicitIndex >= 0)
+    {
+        return implicitIndex + slots;
+    }
+
+    // the index is the first immediate operand of load, store, iinc and ret, two bytes after wide
+    switch (instruction->operandKind_)
+    {
+    case Instruction::OPERAND_value:
+        return std::to_integer<uint32_t>(instruction->immediates_[0]) + slots;
+    case Instruction::OPERAND_wide:
+        return (std::to_integer<uint32_t>(instruction->immediates_[0]) << 8
+                | std::to_integer<uint32_t>(instruction->immediates_[1])) + slots;
+    default:
+        throw std::logic_error("Unsupported local variable instruction in code attribute.");
+    }
+}
+
+void AttributeCode::computeMaxStackAndLocals()
+{
+    using internal::Bytecode;
+
+    // locals: this and arguments, then every accessed slot
+    const Method* method = getOwner();
+    bool isStatic = method->getAccessFlags()->contains(Method::ACC_STATIC);
+    uint32_t maxLocals = Bytecode::getArgumentSlots(method->getDescriptor()->getString()) + (isStatic ? 0 : 1);
+    for (const auto* instruction : code_)
+    {
+        maxLocals = std::max(maxLocals, getLocalsEnd(instruction));
+    }
+    if (maxLocals > UINT16_MAX)
+    {
+        throw std::runtime_error("Too many local variables.");
+    }
+    maxLocals_ = static_cast<uint16_t>(maxLocals);
+
+    // stack: propagate sizes along all execution paths, finding instructions by their offset
+    std::vector<uint32_t> positions(instructionsByteSize_);
+    for (std::size_t i = 0; i < code_.size(); ++i)
+    {
+        positions[code_[i]->getIndex()] = static_cast<uint32_t>(i);
+    }
+    auto positionOf = [this, &positions](const Label* label) -> std::size_t
+    {
+        const Instruction* target = label->getInstruction();
+        if (target == nullptr || !target->isIndexSet() || target->getIndex() >= positions.size()
+            || code_[positions[target->getIndex()]] != target)
+        {
+            throw std::logic_error("Label is not bound to an instruction of this code.");
+        }
+        return positions[target->getIndex()];
+    };
+
+    struct HandlerRange
+    {
+        std::size_t start;
+        std::size_t end;
+        std::size_t handler;
+    };
+    std::vector<HandlerRange> handlers;
+    handlers.reserve(exceptionHandlers_.size());
+    for (const auto* handler : exceptionHandlers_)
+    {
+        handlers.push_back({
+            positionOf(handler->getTryStartLabel()),
+            positionOf(handler->getTryFinishLabel()),
+            positionOf(handler->getCatchStartLabel())
+        });
+    }
+
+    constexpr int32_t unknown = -1;
+    std::vector<int32_t> stackBefore(code_.size(), unknown);
+    std::vector<std::size_t> worklist;
+    int32_t maxStack = 0;
+
+    auto reach = [&](std::size_t position, int32_t stackSize)
+    {
+        if (position >= code_.size())
+        {
+            throw std::logic_error("Execution falls off the end of the code.");
+        }
+        if (stackBefore[position] == unknown)
+        {
+            stackBefore[position] = stackSize;
+            worklist.push_back(position);
+        }
+        else if (stackBefore[position] != stackSize)
+        {
+            throw std::logic_error(
+                "Operand stack has different sizes on merging paths at instruction " + std::to_string(position) + ".");
+        }
+    };
+
+    if (!code_.empty())
+    {
+        reach(0, 0);
+    }
+    while (!worklist.empty())
+    {
+        std::size_t position = worklist.back();
+        worklist.pop_back();
+
+        const Instruction* instruction = code_[position];
+        auto command = instruction->getCommandCode();
+        int32_t stackAfter = stackBefore[position] + getStackDelta(instruction);
+        if (stackAfter < 0)
+        {
+            throw std::logic_error("Operand stack underflow at instruction " + std::to_string(position) + ".");
+        }
+        maxStack = std::max(maxStack, stackAfter);
+
+        // exception handlers start with the exception on the stack
+        for (const auto& range : handlers)
+        {
+            if (range.start <= position && position < range.end)
+            {
+                maxStack = std::max(maxStack, 1);
+                reach(range.handler, 1);
+            }
+        }
+
+        if (instruction->operandKind_ == Instruction::OPERAND_jump)
+        {
+            reach(positionOf(static_cast<const InstructionJump*>(instruction)->getJumpLabel()), stackAfter);
+        }
+        else if (instruction->operandKind_ == Instruction::OPERAND_switch)
+        {
+            const auto* switchInstruction = static_cast<const InstructionSwitch*>(instruction);
+            reach(positionOf(switchInstruction->getDefaultLabel()), stackAfter);
+            for (const auto* label : switchInstruction->getLabels())
+            {
+                reach(positionOf(label), stackAfter);
+            }
+        }
+
+        if (command == Instruction::INSTRUCTION_jsr || command == Instruction::INSTRUCTION_jsr_w)
+        {
+            // the subroutine consumes the return address
+            reach(position + 1, stackAfter - 1);
+        }
+        else if (!Bytecode::isTerminal(command))
+        {
+            reach(position + 1, stackAfter);
+        }
+    }
+
+    if (maxStack > UINT16_MAX)
+    {
+        throw std::runtime_error("Too large operand stack.");
+    }
+    maxStack_ = static_cast<uint16_t>(maxStack);
+}
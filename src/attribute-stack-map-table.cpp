@@ -0,0 +1,164 @@
+#include "jvm/attribute-stack-map-table.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "jvm/attribute-code.h"
+#include "jvm/byte-writer.h"
+#include "jvm/class.h"
+#include "jvm/constant-class.h"
+#include "jvm/instruction.h"
+#include "jvm/method.h"
+
+using namespace jvm;
+
+namespace
+{
+    using VerificationType = AttributeStackMapTable::VerificationType;
+
+    constexpr uint8_t sameFrameMax = 63;
+    constexpr uint8_t sameLocals1StackItemFrame = 64;
+    constexpr uint8_t sameLocals1StackItemFrameExtended = 247;
+    constexpr uint8_t chopFrame = 251; ///< Minus the number of chopped locals.
+    constexpr uint8_t sameFrameExtended = 251;
+    constexpr uint8_t appendFrame = 251; ///< Plus the number of appended locals.
+    constexpr uint8_t fullFrame = 255;
+    constexpr std::size_t maxChangedLocals = 3;
+
+    void writeType(ByteWriter& writer, const VerificationType& type)
+    {
+        writer.writeBigEndian(static_cast<uint8_t>(type.tag));
+        switch (type.tag)
+        {
+        case VerificationType::ITEM_Object:
+            writer.writeBigEndian(type.classConstant->getIndex());
+            break;
+        case VerificationType::ITEM_Uninitialized:
+            writer.writeBigEndian(type.newInstruction->getIndex());
+            break;
+        default:
+            break;
+        }
+    }
+
+    void writeTypes(ByteWriter& writer, const std::vector<VerificationType>& types)
+    {
+        writer.writeBigEndian(static_cast<uint16_t>(types.size()));
+        for (const auto& type : types)
+        {
+            writeType(writer, type);
+        }
+    }
+
+    /**
+     * @return True if @p prefix is a prefix of @p types.
+     */
+    bool startsWith(const std::vector<VerificationType>& types, const std::vector<VerificationType>& prefix)
+    {
+        return prefix.size() <= types.size() && std::equal(prefix.begin(), prefix.end(), types.begin());
+    }
+}
+
+AttributeStackMapTable::AttributeStackMapTable(AttributeCode* owner,
+                                               const std::vector<VerificationType>& initialLocals,
+                                               const std::vector<Frame>& frames) :
+    Attribute(owner->getOwner()->getOwner()->getOrCreateUtf8Constant("StackMapTable")),
+    ClassFileElement(owner)
+{
+    if (frames.size() > UINT16_MAX)
+    {
+        throw std::runtime_error("Too many stack map frames.");
+    }
+    numberOfEntries_ = static_cast<uint16_t>(frames.size());
+
+    ByteWriter writer;
+    const std::vector<VerificationType>* previousLocals = &initialLocals;
+    int32_t previousOffset = -1;
+    for (const auto& frame : frames)
+    {
+        int32_t offset = frame.instruction->getIndex();
+        if (offset <= previousOffset)
+        {
+            throw std::logic_error("Stack map frames must be ordered by offset.");
+        }
+        auto offsetDelta = static_cast<uint16_t>(offset - previousOffset - 1);
+        previousOffset = offset;
+
+        const auto& locals = frame.locals;
+        bool isSameLocals = locals == *previousLocals;
+        if (isSameLocals && frame.stack.empty())
+        {
+            if (offsetDelta <= sameFrameMax)
+            {
+                writer.writeBigEndian(static_cast<uint8_t>(offsetDelta));
+            }
+            else
+            {
+                writer.writeBigEndian(sameFrameExtended);
+                writer.writeBigEndian(offsetDelta);
+            }
+        }
+        else if (isSameLocals && frame.stack.size() == 1)
+        {
+            if (offsetDelta <= sameFrameMax)
+            {
+                writer.writeBigEndian(static_cast<uint8_t>(sameLocals1StackItemFrame + offsetDelta));
+            }
+            else
+            {
+                writer.writeBigEndian(sameLocals1StackItemFrameExtended);
+                writer.writeBigEndian(offsetDelta);
+            }
+            writeType(writer, frame.stack.front());
+        }
+        else if (frame.stack.empty() && locals.size() < previousLocals->size()
+            && previousLocals->size() - locals.size() <= maxChangedLocals && startsWith(*previousLocals, locals))
+        {
+            writer.writeBigEndian(static_cast<uint8_t>(chopFrame - (previousLocals->size() - locals.size())));
+            writer.writeBigEndian(offsetDelta);
+        }
+        else if (frame.stack.empty() && locals.size() > previousLocals->size()
+            && locals.size() - previousLocals->size() <= maxChangedLocals && startsWith(locals, *previousLocals))
+        {
+            writer.writeBigEndian(static_cast<uint8_t>(appendFrame + (locals.size() - previousLocals->size())));
+            writer.writeBigEndian(offsetDelta);
+            for (auto i = previousLocals->size(); i < locals.size(); ++i)
+            {
+                writeType(writer, locals[i]);
+            }
+        }
+        else
+        {
+            writer.writeBigEndian(fullFrame);
+            writer.writeBigEndian(offsetDelta);
+            writeTypes(writer, locals);
+            writeTypes(writer, frame.stack);
+        }
+
+        previousLocals = &locals;
+    }
+    entries_ = writer.release();
+}
+
+std::size_t AttributeStackMapTable::getByteSize() const
+{
+    return Attribute::getByteSize();
+}
+
+void AttributeStackMapTable::writeTo(ByteWriter& writer) const
+{
+    Attribute::writeTo(writer);
+
+    // u2 number_of_entries;
+    writer.writeBigEndian(numberOfEntries_);
+
+    // stack_map_frame entries[number_of_entries];
+    writer.writeBytes(entries_.data(), entries_.size());
+}
+
+size_t AttributeStackMapTable::getContentSizeInBytes() const
+{
+    // u2 number_of_entries;
+    // stack_map_frame entries[number_of_entries];
+    return 2 + entries_.size();
+}
@@ -1,9 +1,5 @@
 #include "jvm/attribute.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 Attribute::Attribute(ConstantUtf8Info* name) : name_(name)
@@ -11,15 +7,15 @@ Attribute::Attribute(ConstantUtf8Info* name) : name_(name)
     assert(name_ != nullptr);
 }
 
-void Attribute::writeTo(std::ostream& os) const
+void Attribute::writeTo(ByteWriter& writer) const
 {
     // u2 attribute_name_index;
     auto nameIndex = getName()->getIndex();
-    internal::Utils::writeBigEndian(os, static_cast<uint16_t>(nameIndex));
+    writer.writeBigEndian(static_cast<uint16_t>(nameIndex));
 
     // u4 attribute_length;
     auto length = getContentSizeInBytes();
-    internal::Utils::writeBigEndian(os, static_cast<uint32_t>(length));
+    writer.writeBigEndian(static_cast<uint32_t>(length));
 }
 
 size_t Attribute::getByteSize() const
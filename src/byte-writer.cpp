@@ -0,0 +1,50 @@
+#include "jvm/byte-writer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace jvm;
+
+ByteWriter::ByteWriter(std::size_t initialCapacity) : buffer_(initialCapacity)
+{
+    begin_ = buffer_.data();
+    cursor_ = begin_;
+    end_ = begin_ + buffer_.size();
+}
+
+ByteWriter::ByteWriter(std::span<std::byte> buffer) :
+    isGrowable_(false), begin_(buffer.data()), cursor_(buffer.data()), end_(buffer.data() + buffer.size())
+{
+}
+
+std::vector<std::byte> ByteWriter::release()
+{
+    if (!isGrowable_)
+    {
+        throw std::logic_error("ByteWriter over a caller-provided buffer can't release its bytes.");
+    }
+
+    buffer_.resize(size());
+    std::vector<std::byte> result = std::move(buffer_);
+
+    buffer_.clear();
+    begin_ = cursor_ = end_ = nullptr;
+    return result;
+}
+
+void ByteWriter::grow(std::size_t count)
+{
+    if (!isGrowable_)
+    {
+        throw std::out_of_range("Not enough space in the ByteWriter buffer.");
+    }
+
+    // grow geometrically to keep appends amortized O(1)
+    std::size_t written = size();
+    std::size_t newCapacity = std::max({buffer_.size() * 2, written + count, static_cast<std::size_t>(64)});
+    buffer_.resize(newCapacity);
+
+    begin_ = buffer_.data();
+    cursor_ = begin_ + written;
+    end_ = begin_ + buffer_.size();
+}
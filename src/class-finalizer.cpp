@@ -0,0 +1,236 @@
+#include "jvm/class-finalizer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "jvm/embedded-jvm.h"
+#include "jvm/helper-process-pool.h"
+
+using namespace jvm;
+
+namespace
+{
+    /**
+     * @brief Write class files as serialized, after the given native analysis.
+     */
+    class NativeFinalizer final : public ClassFinalizer
+    {
+    public:
+        explicit NativeFinalizer(Analysis analysis) : analysis_(analysis)
+        {
+        }
+
+        [[nodiscard]] Analysis getAnalysis() const override
+        {
+            return analysis_;
+        }
+
+        void writeAll(std::span<const Class* const> classes, const Class::ClassSink& sink) const override
+        {
+            for (const auto* classToWrite : classes)
+            {
+                auto bytes = classToWrite->toBytes();
+                sink(*classToWrite, bytes);
+            }
+        }
+
+    private:
+        Analysis analysis_;
+    };
+
+    /**
+     * @brief Fix class files in the process-wide JVM.
+     */
+    class EmbeddedJvmFinalizer final : public ClassFinalizer
+    {
+    public:
+        [[nodiscard]] Analysis getAnalysis() const override
+        {
+            return None;
+        }
+
+        void write(const Class& classToWrite, std::ostream& os) const override
+        {
+            // serialize into jvm memory, copy the result out: the stream may block while gc is stalled
+            std::vector<unsigned char> fixedData;
+            EmbeddedJvm::fix(
+                classToWrite.getByteSize(),
+                [&classToWrite](std::span<unsigned char> buffer)
+                {
+                    classToWrite.serializeInto(std::as_writable_bytes(buffer));
+                },
+                [&fixedData](std::span<const unsigned char> fixed)
+                {
+                    fixedData.assign(fixed.begin(), fixed.end());
+                });
+            os.write(reinterpret_cast<const char*>(fixedData.data()), static_cast<std::streamsize>(fixedData.size()));
+        }
+
+        void writeAll(std::span<const Class* const> classes, const Class::ClassSink& sink) const override
+        {
+            if (classes.empty())
+            {
+                return;
+            }
+
+            // serialize all classes into one buffer
+            std::vector<std::size_t> offsets;
+            offsets.reserve(classes.size() + 1);
+            offsets.push_back(0);
+            for (const auto* classToWrite : classes)
+            {
+                offsets.push_back(offsets.back() + classToWrite->getByteSize());
+            }
+
+            std::vector<unsigned char> data(offsets.back());
+            auto buffer = std::as_writable_bytes(std::span(data));
+            for (std::size_t i = 0; i < classes.size(); ++i)
+            {
+                classes[i]->serializeInto(buffer.subspan(offsets[i], offsets[i + 1] - offsets[i]));
+            }
+
+            // fix data and pass every class to sink
+            auto fixed = EmbeddedJvm::fixAll(data, offsets);
+            auto fixedBytes = std::as_bytes(std::span(fixed.data));
+            for (std::size_t i = 0; i < classes.size(); ++i)
+            {
+                sink(*classes[i], fixedBytes.subspan(fixed.offsets[i], fixed.offsets[i + 1] - fixed.offsets[i]));
+            }
+        }
+    };
+
+    /**
+     * @brief Fix class files in the pool of helper java processes.
+     */
+    class ExternalHelperProcessFinalizer final : public ClassFinalizer
+    {
+    public:
+        [[nodiscard]] Analysis getAnalysis() const override
+        {
+            return None;
+        }
+
+        void write(const Class& classToWrite, std::ostream& os) const override
+        {
+            auto fixed = fixInHelperProcess(classToWrite);
+            os.write(reinterpret_cast<const char*>(fixed.data()), static_cast<std::streamsize>(fixed.size()));
+        }
+
+        void writeAll(std::span<const Class* const> classes, const Class::ClassSink& sink) const override
+        {
+            // keep every process of the pool busy
+            std::vector<std::vector<unsigned char>> fixed(classes.size());
+            std::atomic<std::size_t> next = 0;
+            std::exception_ptr error;
+            std::mutex errorMutex;
+
+            auto threadCount = std::min(classes.size(), HelperProcessPool::getMaxProcesses());
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount);
+            for (std::size_t i = 0; i < threadCount; ++i)
+            {
+                threads.emplace_back([&]
+                {
+                    try
+                    {
+                        for (std::size_t index = next++; index < classes.size(); index = next++)
+                        {
+                            fixed[index] = fixInHelperProcess(*classes[index]);
+                        }
+                    }
+                    catch (...)
+                    {
+                        next = classes.size();
+                        std::lock_guard lock(errorMutex);
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            for (std::size_t i = 0; i < classes.size(); ++i)
+            {
+                sink(*classes[i], std::as_bytes(std::span(fixed[i])));
+            }
+        }
+
+    private:
+        static std::vector<unsigned char> fixInHelperProcess(const Class& classToWrite)
+        {
+            auto bytes = classToWrite.toBytes();
+            return HelperProcessPool::fix(std::span(reinterpret_cast<const unsigned char*>(bytes.data()), bytes.size()));
+        }
+    };
+}
+
+void ClassFinalizer::write(const Class& classToWrite, std::ostream& os) const
+{
+    auto bytes = classToWrite.toBytes();
+    os.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}
+
+void ClassFinalizer::writeAll(std::span<const Class* const> classes, const Class::ClassSink& sink) const
+{
+    for (const auto* classToWrite : classes)
+    {
+        std::ostringstream os;
+        write(*classToWrite, os);
+        auto bytes = std::move(os).str();
+        sink(*classToWrite, std::as_bytes(std::span(bytes)));
+    }
+}
+
+const ClassFinalizer& ClassFinalizer::none()
+{
+    static const NativeFinalizer finalizer(None);
+    return finalizer;
+}
+
+const ClassFinalizer& ClassFinalizer::nativeMaxs()
+{
+    static const NativeFinalizer finalizer(Maxs);
+    return finalizer;
+}
+
+const ClassFinalizer& ClassFinalizer::nativeFrames()
+{
+    static const NativeFinalizer finalizer(Frames);
+    return finalizer;
+}
+
+const ClassFinalizer& ClassFinalizer::embeddedJvm()
+{
+    static const EmbeddedJvmFinalizer finalizer;
+    return finalizer;
+}
+
+const ClassFinalizer& ClassFinalizer::externalHelperProcess()
+{
+    static const ExternalHelperProcessFinalizer finalizer;
+    return finalizer;
+}
+
+const ClassFinalizer& ClassFinalizer::platformDefault()
+{
+#ifdef _WIN32
+    return externalHelperProcess();
+#else
+    return embeddedJvm();
+#endif
+}
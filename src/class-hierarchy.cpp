@@ -0,0 +1,56 @@
+#include "jvm/class-hierarchy.h"
+
+#include <unordered_set>
+
+using namespace jvm;
+
+namespace
+{
+    const std::string objectClassName = "java/lang/Object";
+}
+
+void SimpleClassHierarchy::addClass(const std::string& name, const std::string& superName)
+{
+    superClasses_[name] = superName;
+}
+
+std::string SimpleClassHierarchy::getCommonSuperClass(const std::string& first, const std::string& second) const
+{
+    // collect all superclasses of the first class
+    std::unordered_set<std::string> firstAncestors;
+    for (const std::string* current = &first;;)
+    {
+        if (!firstAncestors.insert(*current).second)
+        {
+            break; // cyclic declarations
+        }
+        auto superClass = superClasses_.find(*current);
+        if (superClass == superClasses_.end())
+        {
+            break;
+        }
+        current = &superClass->second;
+    }
+
+    // find the nearest of them among superclasses of the second class
+    std::unordered_set<std::string> secondAncestors;
+    for (const std::string* current = &second;;)
+    {
+        if (firstAncestors.contains(*current))
+        {
+            return *current;
+        }
+        if (!secondAncestors.insert(*current).second)
+        {
+            break;
+        }
+        auto superClass = superClasses_.find(*current);
+        if (superClass == superClasses_.end())
+        {
+            break;
+        }
+        current = &superClass->second;
+    }
+
+    return objectClassName;
+}
@@ -0,0 +1,170 @@
+#include "jvm/class-sharder.h"
+
+#include <stdexcept>
+#include <utility>
+
+#include "jvm/class.h"
+#include "jvm/code-emitter.h"
+#include "jvm/constant-utf-8-info.h"
+#include "jvm/descriptor-method.h"
+#include "jvm/method.h"
+#include "jvm/internal/bytecode.h"
+
+using namespace jvm;
+using namespace jvm::internal;
+
+namespace
+{
+    Instruction::Command getLoadCommand(std::string_view type)
+    {
+        switch (type.front())
+        {
+        case 'J':
+            return Instruction::INSTRUCTION_lload;
+        case 'F':
+            return Instruction::INSTRUCTION_fload;
+        case 'D':
+            return Instruction::INSTRUCTION_dload;
+        case 'L':
+        case '[':
+            return Instruction::INSTRUCTION_aload;
+        default:
+            return Instruction::INSTRUCTION_iload;
+        }
+    }
+
+    Instruction::Command getReturnCommand(std::string_view type)
+    {
+        switch (type.front())
+        {
+        case 'V':
+            return Instruction::INSTRUCTION_return;
+        case 'J':
+            return Instruction::INSTRUCTION_lreturn;
+        case 'F':
+            return Instruction::INSTRUCTION_freturn;
+        case 'D':
+            return Instruction::INSTRUCTION_dreturn;
+        case 'L':
+        case '[':
+            return Instruction::INSTRUCTION_areturn;
+        default:
+            return Instruction::INSTRUCTION_ireturn;
+        }
+    }
+}
+
+ClassSharder::ClassSharder(std::string className, std::string parentName, ShardSetup setup, uint16_t constantLimit) :
+    className_(std::move(className)), parentName_(std::move(parentName)), setup_(std::move(setup)),
+    constantLimit_(constantLimit)
+{
+    if (constantLimit_ == 0 || constantLimit_ > Class::maxConstantPoolCount)
+    {
+        throw std::invalid_argument("Shard constant limit must be in [1, "
+                                    + std::to_string(Class::maxConstantPoolCount) + "].");
+    }
+
+    addShard();
+}
+
+ClassSharder::~ClassSharder() = default;
+
+Method* ClassSharder::createMethod(const std::string& name, const DescriptorMethod& descriptor)
+{
+    std::string key = name + descriptor.toString();
+    auto it = methodShards_.find(key);
+    if (it != methodShards_.end())
+    {
+        Method* method = shards_[it->second]->getOrCreateMethod(name, descriptor);
+        if (declaredMethods_.erase(key) == 0 || shards_[it->second]->getConstantPoolCount() < constantLimit_)
+        {
+            return method;
+        }
+
+        // the declaring shard filled up since the first call, keep it to a forwarder of a few slots
+        std::size_t shard = getOpenShard();
+        Method* target = shards_[shard]->getOrCreateMethod(name, descriptor);
+        target->addFlag(Method::ACC_STATIC);
+        createForwarder(*method, shard);
+        it->second = shard;
+        return target;
+    }
+
+    std::size_t shard = getOpenShard();
+    Method* method = shards_[shard]->getOrCreateMethod(name, descriptor);
+    method->addFlag(Method::ACC_STATIC);
+    methodShards_.emplace(std::move(key), shard);
+    return method;
+}
+
+ConstantMethodref* ClassSharder::getMethodref(Class& caller, const std::string& name,
+                                              const DescriptorMethod& descriptor)
+{
+    std::string key = name + descriptor.toString();
+    auto it = methodShards_.find(key);
+    if (it == methodShards_.end())
+    {
+        std::size_t shard = getOpenShard();
+        shards_[shard]->getOrCreateMethod(name, descriptor)->addFlag(Method::ACC_STATIC);
+        declaredMethods_.insert(key);
+        it = methodShards_.emplace(std::move(key), shard).first;
+    }
+
+    return caller.getOrCreateMethodrefConstant(shards_[it->second]->getName(), name, descriptor);
+}
+
+std::span<const Class* const> ClassSharder::getClasses() const noexcept
+{
+    return classes_;
+}
+
+std::size_t ClassSharder::getShardCount() const noexcept
+{
+    return shards_.size();
+}
+
+Class* ClassSharder::getShard(std::size_t index) const
+{
+    return shards_.at(index).get();
+}
+
+void ClassSharder::addShard()
+{
+    std::string name = shards_.empty() ? className_ : className_ + "$Shard" + std::to_string(shards_.size());
+    auto& shard = shards_.emplace_back(std::make_unique<Class>(name, parentName_));
+    classes_.push_back(shard.get());
+    if (setup_)
+    {
+        setup_(*shard);
+    }
+}
+
+std::size_t ClassSharder::getOpenShard()
+{
+    // the pool of a shard only grows, so a full shard is never reused
+    if (shards_.back()->getConstantPoolCount() >= constantLimit_)
+    {
+        addShard();
+    }
+    return shards_.size() - 1;
+}
+
+void ClassSharder::createForwarder(Method& forwarder, std::size_t shard)
+{
+    Class& owner = *forwarder.getOwner();
+    ConstantUtf8Info* name = forwarder.getName();
+    ConstantUtf8Info* descriptor = forwarder.getDescriptor();
+    std::string signature = descriptor->getString();
+    forwarder.addFlag(Method::ACC_SYNTHETIC);
+
+    CodeEmitter& code = *forwarder.getCodeEmitter();
+    uint16_t slot = 0;
+    for (std::string_view type : Bytecode::getArgumentTypes(signature))
+    {
+        code.emitLocal(getLoadCommand(type), slot);
+        slot += type == "J" || type == "D" ? 2 : 1;
+    }
+    code.emitInvoke(Instruction::INSTRUCTION_invokestatic, owner.getOrCreateMethodrefConstant(
+                        owner.getOrCreateClassConstant(shards_[shard]->getName()), name, descriptor));
+    code.emit(getReturnCommand(Bytecode::getReturnType(signature)));
+}
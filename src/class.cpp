@@ -1,16 +1,17 @@
 #include "jvm/class.h"
 
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <stdexcept>
 #include <cstring>
-#include <jni.h>
+#include <memory>
 #include <ostream>
-#include <sstream>
 #include <utility>
-#include <fstream>
-#include <filesystem>
-#include <iostream>
 
+#include "jvm/attribute-code.h"
+#include "jvm/class-finalizer.h"
+#include "jvm/code-emitter.h"
 #include "jvm/constant.h"
 #include "jvm/constant-class.h"
 #include "jvm/constant-double.h"
@@ -28,19 +29,42 @@
 #include "jvm/field.h"
 #include "jvm/method.h"
 #include "jvm/internal/utils.h"
-#include "java-internal-paths.h"
 
-namespace fs = std::filesystem;
 using namespace jvm;
 
 MajorVersion Class::majorVersion = MAJOR_VERSION_16;
 
-Class::Class(const std::string& className, const std::string& parentName)
+Class::Class(const std::string& className, const std::string& parentName, std::pmr::memory_resource* upstream) :
+    arena_(upstream)
 {
     thisClassConstant_ = getOrCreateClassConstant(className);
     superClassConstant_ = getOrCreateClassConstant(parentName);
 }
 
+Class::~Class()
+{
+    // elements don't own their memory, it is released with the arena
+    for (auto* method : methods_)
+    {
+        std::destroy_at(method);
+    }
+
+    for (auto* field : fields_)
+    {
+        std::destroy_at(field);
+    }
+
+    for (auto* constant : constants_)
+    {
+        std::destroy_at(constant);
+    }
+}
+
+std::pmr::memory_resource* Class::getMemoryResource() noexcept
+{
+    return &arena_;
+}
+
 uint16_t Class::minorVersion = 0x0000;
 
 ConstantClass* Class::getOrCreateClassConstant(const std::string& name)
@@ -54,21 +78,15 @@ ConstantClass* Class::getOrCreateClassConstant(ConstantUtf8Info* name)
     assert(this == name->getOwner());
 
     // try search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant({Constant::CONSTANT_Class, name->getIndex()});
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Class)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* classConstant = static_cast<ConstantClass*>(constant);
-            if (classConstant->getName() == name)
-            {
-                return classConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantClass*>(existingConstant);
     }
 
     // create new
-    auto* classConstant = new ConstantClass(name);
+    auto* classConstant = create<ConstantClass>(name);
     addNewConstant(classConstant);
     return classConstant;
 }
@@ -110,22 +128,15 @@ ConstantFieldref* Class::getOrCreateFieldrefConstant(ConstantClass* classConstan
     assert(this == nameAndTypeConstant -> getOwner());
 
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant(makeConstantKey(Constant::CONSTANT_Fieldref, classConstant->getIndex(), nameAndTypeConstant->getIndex()));
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Fieldref)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* fieldrefConstant = static_cast<ConstantFieldref*>(constant);
-            if (fieldrefConstant->getClass() == classConstant && fieldrefConstant->getNameAndType() ==
-                nameAndTypeConstant)
-            {
-                return fieldrefConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantFieldref*>(existingConstant);
     }
 
     // create new
-    auto* fieldrefConstant = new ConstantFieldref(classConstant, nameAndTypeConstant);
+    auto* fieldrefConstant = create<ConstantFieldref>(classConstant, nameAndTypeConstant);
     addNewConstant(fieldrefConstant);
     return fieldrefConstant;
 }
@@ -171,22 +182,15 @@ ConstantMethodref* Class::getOrCreateMethodrefConstant(ConstantClass* classConst
     assert(this == nameAndTypeConstant->getOwner());
 
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant(makeConstantKey(Constant::CONSTANT_Methodref, classConstant->getIndex(), nameAndTypeConstant->getIndex()));
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Methodref)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* constantMethodref = static_cast<ConstantMethodref*>(constant);
-            if (constantMethodref->getClass() == classConstant && constantMethodref->getNameAndType() ==
-                nameAndTypeConstant)
-            {
-                return constantMethodref;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantMethodref*>(existingConstant);
     }
 
     // create new
-    auto* methodrefConstant = new ConstantMethodref(classConstant, nameAndTypeConstant);
+    auto* methodrefConstant = create<ConstantMethodref>(classConstant, nameAndTypeConstant);
     addNewConstant(methodrefConstant);
     return methodrefConstant;
 }
@@ -232,23 +236,16 @@ ConstantInterfaceMethodref* Class::getOrCreateInterfaceMethodrefConstant(Constan
     assert(this == nameAndTypeConstant->getOwner());
 
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant(makeConstantKey(Constant::CONSTANT_InterfaceMethodref, classConstant->getIndex(),
+                                                    nameAndTypeConstant->getIndex()));
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_InterfaceMethodref)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* interfaceMethodrefConstant = static_cast<ConstantInterfaceMethodref*>(constant);
-            if (interfaceMethodrefConstant->getClass() == classConstant && interfaceMethodrefConstant->getNameAndType()
-                ==
-                nameAndTypeConstant)
-            {
-                return interfaceMethodrefConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantInterfaceMethodref*>(existingConstant);
     }
 
     // create new
-    auto* interfaceMethodrefConstant = new ConstantInterfaceMethodref(classConstant, nameAndTypeConstant);
+    auto* interfaceMethodrefConstant = create<ConstantInterfaceMethodref>(classConstant, nameAndTypeConstant);
     addNewConstant(interfaceMethodrefConstant);
     return interfaceMethodrefConstant;
 }
@@ -264,21 +261,15 @@ ConstantString* Class::getOrCreateStringConstant(ConstantUtf8Info* utf8Constant)
     assert(this == utf8Constant->getOwner());
 
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant({Constant::CONSTANT_String, utf8Constant->getIndex()});
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_String)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* stringConstant = static_cast<ConstantString*>(constant);
-            if (stringConstant->getString() == utf8Constant)
-            {
-                return stringConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantString*>(existingConstant);
     }
 
     // create new
-    auto* stringConstant = new ConstantString(utf8Constant);
+    auto* stringConstant = create<ConstantString>(utf8Constant);
     addNewConstant(stringConstant);
     return stringConstant;
 }
@@ -286,21 +277,15 @@ ConstantString* Class::getOrCreateStringConstant(ConstantUtf8Info* utf8Constant)
 ConstantInteger* Class::getOrCreateIntegerConstant(int32_t value)
 {
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant({Constant::CONSTANT_Integer, static_cast<uint32_t>(value)});
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Integer)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* integerConstant = static_cast<ConstantInteger*>(constant);
-            if (integerConstant->getValue() == value)
-            {
-                return integerConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantInteger*>(existingConstant);
     }
 
     // create new
-    auto* integerConstant = new ConstantInteger(value, this);
+    auto* integerConstant = create<ConstantInteger>(value, this);
     addNewConstant(integerConstant);
     return integerConstant;
 }
@@ -308,22 +293,15 @@ ConstantInteger* Class::getOrCreateIntegerConstant(int32_t value)
 ConstantFloat* Class::getOrCreateFloatConstant(float value)
 {
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant({Constant::CONSTANT_Float, std::bit_cast<uint32_t>(value)});
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Float)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* floatConstant = static_cast<ConstantFloat*>(constant);
-            auto valueFromConstant = floatConstant->getValue();
-            if (std::memcmp(&valueFromConstant, &value, sizeof(float)) == 0)
-            {
-                return floatConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantFloat*>(existingConstant);
     }
 
     // create new
-    auto* floatConstant = new ConstantFloat(value, this);
+    auto* floatConstant = create<ConstantFloat>(value, this);
     addNewConstant(floatConstant);
     return floatConstant;
 }
@@ -331,21 +309,15 @@ ConstantFloat* Class::getOrCreateFloatConstant(float value)
 ConstantLong* Class::getOrCreateLongConstant(int64_t value)
 {
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant({Constant::CONSTANT_Long, static_cast<uint64_t>(value)});
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Long)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* longConstant = static_cast<ConstantLong*>(constant);
-            if (longConstant->getValue() == value)
-            {
-                return longConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantLong*>(existingConstant);
     }
 
     // create new
-    auto* longConstant = new ConstantLong(value, this);
+    auto* longConstant = create<ConstantLong>(value, this);
     addNewConstant(longConstant);
     return longConstant;
 }
@@ -353,22 +325,15 @@ ConstantLong* Class::getOrCreateLongConstant(int64_t value)
 ConstantDouble* Class::getOrCreateDoubleConstant(double value)
 {
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant({Constant::CONSTANT_Double, std::bit_cast<uint64_t>(value)});
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_Double)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* doubleConstant = static_cast<ConstantDouble*>(constant);
-            auto valueFromConstant = doubleConstant->getValue();
-            if (std::memcmp(&valueFromConstant, &value, sizeof(double)) == 0)
-            {
-                return doubleConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantDouble*>(existingConstant);
     }
 
     // create new
-    auto doubleConstant = new ConstantDouble(value, this);
+    auto doubleConstant = create<ConstantDouble>(value, this);
     addNewConstant(doubleConstant);
     return doubleConstant;
 }
@@ -404,22 +369,15 @@ ConstantNameAndType* Class::getOrCreateNameAndTypeConstant(ConstantUtf8Info* nam
     assert(this == descriptorConstant->getOwner());
 
     // search constant
-    for (auto* constant : constants_)
+    auto* existingConstant = findConstant(makeConstantKey(Constant::CONSTANT_NameAndType, nameConstant->getIndex(), descriptorConstant->getIndex()));
+    if (existingConstant != nullptr)
     {
-        if (constant->getTag() == Constant::CONSTANT_NameAndType)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* nameAndTypeConstant = static_cast<ConstantNameAndType*>(constant);
-            if (nameAndTypeConstant->getName() == nameConstant &&
-                nameAndTypeConstant->getDescriptor() == descriptorConstant)
-            {
-                return nameAndTypeConstant;
-            }
-        }
+        // Use static method because only one tag can be associated with only one class type.
+        return static_cast<ConstantNameAndType*>(existingConstant);
     }
 
     // create new
-    auto* nameAndTypeConstant = new ConstantNameAndType(nameConstant, descriptorConstant);
+    auto* nameAndTypeConstant = create<ConstantNameAndType>(nameConstant, descriptorConstant);
     addNewConstant(nameAndTypeConstant);
     return nameAndTypeConstant;
 }
@@ -427,21 +385,14 @@ ConstantNameAndType* Class::getOrCreateNameAndTypeConstant(ConstantUtf8Info* nam
 ConstantUtf8Info* Class::getOrCreateUtf8Constant(const std::string& value)
 {
     // search constant
-    for (auto* constant : constants_)
+    auto existingConstant = utf8Constants_.find(value);
+    if (existingConstant != utf8Constants_.end())
     {
-        if (constant->getTag() == Constant::CONSTANT_Utf8)
-        {
-            // Use static method because only one tag can be associated with only one class type.
-            auto* utf8Constant = static_cast<ConstantUtf8Info*>(constant);
-            if (utf8Constant->getString() == value)
-            {
-                return utf8Constant;
-            }
-        }
+        return existingConstant->second;
     }
 
     // create new
-    auto* utf8Constant = new ConstantUtf8Info(value, this);
+    auto* utf8Constant = create<ConstantUtf8Info>(value, this);
     addNewConstant(utf8Constant);
     return utf8Constant;
 }
@@ -480,7 +431,7 @@ Field* Class::getOrCreateField(ConstantUtf8Info* nameConstant, ConstantUtf8Info*
     }
 
     // create new
-    auto* field = new Field(nameConstant, descriptorConstant);
+    auto* field = create<Field>(nameConstant, descriptorConstant);
     fields_.insert(field);
     return field;
 }
@@ -519,7 +470,7 @@ Method* Class::getOrCreateMethod(ConstantUtf8Info* nameConstant, ConstantUtf8Inf
     }
 
     // create new
-    auto* method = new Method(nameConstant, descriptorConstant);
+    auto* method = create<Method>(nameConstant, descriptorConstant);
     methods_.insert(method);
     return method;
 }
@@ -529,6 +480,11 @@ std::span<Constant*> Class::constants()
     return constants_;
 }
 
+uint16_t Class::getConstantPoolCount() const noexcept
+{
+    return nextCpIndex;
+}
+
 void Class::addFlag(AccessFlag flag)
 {
     uint16_t newFlags = 0;
@@ -546,28 +502,163 @@ void Class::removeFlag(AccessFlag flag)
     accessFlags_.erase(flag);
 }
 
+std::string Class::getName() const
+{
+    return static_cast<ConstantClass*>(thisClassConstant_)->getName()->getString();
+}
+
+void Class::setClassHierarchy(const ClassHierarchy* hierarchy)
+{
+    classHierarchy_ = hierarchy;
+}
+
+const ClassHierarchy* Class::getClassHierarchy() const
+{
+    return classHierarchy_;
+}
+
+void Class::setFinalizer(const ClassFinalizer* finalizer)
+{
+    finalizer_ = finalizer;
+}
+
+const ClassFinalizer& Class::getFinalizer() const
+{
+    if (finalizer_ != nullptr)
+    {
+        return *finalizer_;
+    }
+    return classHierarchy_ != nullptr ? ClassFinalizer::nativeFrames() : ClassFinalizer::platformDefault();
+}
+
+void Class::setMethodSizeLimits(const MethodSizeLimits& limits)
+{
+    methodSizeLimits_ = limits;
+}
+
+const MethodSizeLimits& Class::getMethodSizeLimits() const noexcept
+{
+    return methodSizeLimits_;
+}
+
+MethodSizeSummary Class::getMethodSizeSummary() const
+{
+    finalizeMethods();
+
+    MethodSizeSummary summary;
+    for (const auto* method : methods_)
+    {
+        std::size_t codeLength = 0;
+        if (method->codeAttribute_ != nullptr)
+        {
+            codeLength = method->codeAttribute_->getBytecode().size();
+        }
+        else if (method->codeEmitter_ != nullptr)
+        {
+            codeLength = method->codeEmitter_->getBytecode().size();
+        }
+        else
+        {
+            continue;
+        }
+        const auto& report = summary.methods.emplace_back(methodSizeLimits_.report(method, codeLength));
+        ++summary.counts[report.category];
+        summary.totalCodeLength += codeLength;
+    }
+    std::ranges::stable_sort(summary.methods, std::ranges::greater{}, &MethodSizeReport::codeLength);
+    return summary;
+}
+
 void Class::writeTo(std::ostream& os) const
 {
-    std::ostringstream buffer;
+    const auto& finalizer = getFinalizer();
+    finalizeMethods(finalizer);
+    finalizer.write(*this, os);
+}
+
+std::size_t Class::serializeInto(std::span<std::byte> buffer) const
+{
+    std::size_t size = getByteSize();
+    if (buffer.size() < size)
+    {
+        throw std::out_of_range("Buffer is too small for the class file.");
+    }
+
+    ByteWriter writer(buffer.first(size));
+    writeTo(writer);
+    assert(writer.size() == size);
+
+    return size;
+}
+
+std::vector<std::byte> Class::toBytes() const
+{
+    std::vector<std::byte> bytes(getByteSize());
+
+    ByteWriter writer(bytes);
+    writeTo(writer);
+    assert(writer.size() == bytes.size());
+
+    return bytes;
+}
+
+void Class::writeAll(std::span<const Class* const> classes, const ClassSink& sink)
+{
+    if (classes.empty())
+    {
+        return;
+    }
+
+    // one batch per finalizer, in the order of their first class; there are only a few finalizers
+    std::vector<std::pair<const ClassFinalizer*, std::vector<const Class*>>> batches;
+    for (const auto* classToWrite : classes)
+    {
+        const auto* finalizer = &classToWrite->getFinalizer();
+        auto batch = std::ranges::find(batches, finalizer, &decltype(batches)::value_type::first);
+        if (batch == batches.end())
+        {
+            batch = batches.insert(batch, {finalizer, {}});
+        }
+        batch->second.push_back(classToWrite);
+    }
+
+    for (const auto& [finalizer, batch] : batches)
+    {
+        writeAll(batch, sink, *finalizer);
+    }
+}
+
+void Class::writeAll(std::span<const Class* const> classes, const ClassSink& sink, const ClassFinalizer& finalizer)
+{
+    for (const auto* classToWrite : classes)
+    {
+        classToWrite->finalizeMethods(finalizer);
+    }
+    finalizer.writeAll(classes, sink);
+}
+
+void Class::writeTo(ByteWriter& writer) const
+{
+    finalizeMethods();
 
     // u4             magic;
     static uint32_t magicNumber = 0xCAFEBABE;
-    internal::Utils::writeBigEndian(buffer, magicNumber);
+    writer.writeBigEndian(magicNumber);
 
     // u2             minor_version;
-    internal::Utils::writeBigEndian(buffer, minorVersion);
+    writer.writeBigEndian(minorVersion);
 
     // u2             major_version;
-    internal::Utils::writeBigEndian(buffer, static_cast<uint16_t>(majorVersion));
+    writer.writeBigEndian(static_cast<uint16_t>(majorVersion));
 
     // u2             constant_pool_count;
     uint16_t constantCount = static_cast<uint16_t>(nextCpIndex);
-    internal::Utils::writeBigEndian(buffer, constantCount);
+    writer.writeBigEndian(constantCount);
 
     // cp_info        constant_pool[constant_pool_count-1];
     for (const auto& constant : constants_)
     {
-        buffer << *constant;
+        writer << *constant;
     }
 
     // u2             access_flags;
@@ -576,64 +667,62 @@ void Class::writeTo(std::ostream& os) const
     {
         accessFlags = accessFlags | flag;
     }
-    internal::Utils::writeBigEndian(buffer, accessFlags);
+    writer.writeBigEndian(accessFlags);
 
     // u2             this_class;
     uint16_t thisClass = thisClassConstant_->getIndex();
-    internal::Utils::writeBigEndian(buffer, thisClass);
+    writer.writeBigEndian(thisClass);
 
     // u2             super_class;
     uint16_t superClass = superClassConstant_->getIndex();
-    internal::Utils::writeBigEndian(buffer, superClass);
+    writer.writeBigEndian(superClass);
 
     // u2             interfaces_count;
     uint16_t interfacesCount = static_cast<uint16_t>(interfacesConstant_.size());
-    internal::Utils::writeBigEndian(buffer, interfacesCount);
+    writer.writeBigEndian(interfacesCount);
 
     // u2             interfaces[interfaces_count];
     for (const auto& interface : interfacesConstant_)
     {
         uint16_t interfaceIndex = interface->getIndex();
-        internal::Utils::writeBigEndian(buffer, interfaceIndex);
+        writer.writeBigEndian(interfaceIndex);
     }
 
     // u2             fields_count;
     uint16_t fieldsCount = static_cast<uint16_t>(fields_.size());
-    internal::Utils::writeBigEndian(buffer, fieldsCount);
+    writer.writeBigEndian(fieldsCount);
 
     // field_info     fields[fields_count];
     for (const auto& field : fields_)
     {
-        buffer << *field;
+        writer << *field;
     }
 
     // u2             methods_count;
     uint16_t methodsCount = static_cast<uint16_t>(methods_.size());
-    internal::Utils::writeBigEndian(buffer, methodsCount);
+    writer.writeBigEndian(methodsCount);
 
     // method_info    methods[methods_count];
     for (const auto& method : methods_)
     {
-        buffer << *method;
+        writer << *method;
     }
 
     // u2             attributes_count;
     uint16_t attributesCount = static_cast<uint16_t>(attributes_.size());
-    internal::Utils::writeBigEndian(buffer, attributesCount);
+    writer.writeBigEndian(attributesCount);
 
     // attribute_info attributes[attributes_count];
     for (const auto& attribute : attributes_)
     {
-        buffer << *attribute;
+        writer << *attribute;
     }
-
-    // fix data and write to stream
-    auto str = buffer.str();
-    fixClassBinary(os, std::vector<unsigned char>{str.begin(), str.end()});
 }
 
 std::size_t Class::getByteSize() const
 {
+    finalizeMethods();
+
     size_t size = 0;
 
     // u4 magic;
@@ -645,10 +734,7 @@ std::size_t Class::getByteSize() const
     // u2 constant_pool_count;
     size += 2;
     // cp_info constant_pool[constant_pool_count-1];
-    for (const auto& constant : constants_)
-    {
-        size += constant->getByteSize();
-    }
+    size += constantsByteSize_;
     // u2 access_flags;
     size += 2;
     // u2 this_class;
@@ -658,7 +744,7 @@ std::size_t Class::getByteSize() const
     // u2 interfaces_count;
     size += 2;
     // u2 interfaces[interfaces_count];
-    size += 2;
+    size += 2 * interfacesConstant_.size();
     // u2 fields_count;
     size += 2;
     // field_info fields[fields_count];
@@ -691,10 +777,93 @@ const std::set<Class::AccessFlag>* Class::getAccessFlags() const
 
 void Class::addNewConstant(Constant* constant)
 {
+    // indices are u2 and the count is one more than the last slot, a wrapped index would corrupt the pool
+    if (constant->getOccupiedSlots() > maxConstantPoolCount - nextCpIndex)
+    {
+        std::destroy_at(constant);
+        throw std::length_error("Constant pool of class " + getName() + " is full: "
+                                + std::to_string(nextCpIndex - 1) + " slots used, at most "
+                                + std::to_string(maxConstantPoolCount - 1) + ".");
+    }
+
     constants_.push_back(constant);
     constant->setIndex(nextCpIndex);
+    constantsByteSize_ += constant->getByteSize();
 
     nextCpIndex += constant->getOccupiedSlots();
+
+    // register constant in lookup index
+    if (constant->getTag() == Constant::CONSTANT_Utf8)
+    {
+        auto* utf8Constant = static_cast<ConstantUtf8Info*>(constant);
+        utf8Constants_.emplace(utf8Constant->string_, utf8Constant);
+    }
+    else
+    {
+        constantsIndex_.emplace(makeConstantKey(constant), constant);
+    }
+}
+
+Constant* Class::findConstant(const ConstantKey& key) const
+{
+    auto it = constantsIndex_.find(key);
+    return it != constantsIndex_.end() ? it->second : nullptr;
+}
+
+Class::ConstantKey Class::makeConstantKey(uint8_t tag, uint16_t firstIndex, uint16_t secondIndex)
+{
+    return {tag, static_cast<uint64_t>(firstIndex) << 16 | secondIndex};
+}
+
+Class::ConstantKey Class::makeConstantKey(const Constant* constant)
+{
+    // Use static method because only one tag can be associated with only one class type.
+    switch (constant->getTag())
+    {
+    case Constant::CONSTANT_Class:
+        return {Constant::CONSTANT_Class, static_cast<const ConstantClass*>(constant)->name_->getIndex()};
+    case Constant::CONSTANT_String:
+        return {Constant::CONSTANT_String, static_cast<const ConstantString*>(constant)->string_->getIndex()};
+    case Constant::CONSTANT_Integer:
+        return {Constant::CONSTANT_Integer, static_cast<uint32_t>(static_cast<const ConstantInteger*>(constant)->value_)};
+    case Constant::CONSTANT_Float:
+        return {Constant::CONSTANT_Float, std::bit_cast<uint32_t>(static_cast<const ConstantFloat*>(constant)->value_)};
+    case Constant::CONSTANT_Long:
+        return {Constant::CONSTANT_Long, static_cast<uint64_t>(static_cast<const ConstantLong*>(constant)->value_)};
+    case Constant::CONSTANT_Double:
+        return {Constant::CONSTANT_Double, std::bit_cast<uint64_t>(static_cast<const ConstantDouble*>(constant)->value_)};
+    case Constant::CONSTANT_NameAndType:
+        {
+            auto* nameAndType = static_cast<const ConstantNameAndType*>(constant);
+            return makeConstantKey(Constant::CONSTANT_NameAndType, nameAndType->name_->getIndex(),
+                                   nameAndType->descriptor_->getIndex());
+        }
+    case Constant::CONSTANT_Fieldref:
+        {
+            auto* fieldref = static_cast<const ConstantFieldref*>(constant);
+            return makeConstantKey(Constant::CONSTANT_Fieldref, fieldref->class_->getIndex(),
+                                   fieldref->nameAndType_->getIndex());
+        }
+    case Constant::CONSTANT_Methodref:
+        {
+            auto* methodref = static_cast<const ConstantMethodref*>(constant);
+            return makeConstantKey(Constant::CONSTANT_Methodref, methodref->class_->getIndex(),
+                                   methodref->nameAndType_->getIndex());
+        }
+    case Constant::CONSTANT_InterfaceMethodref:
+        {
+            auto* interfaceMethodref = static_cast<const ConstantInterfaceMethodref*>(constant);
+            return makeConstantKey(Constant::CONSTANT_InterfaceMethodref, interfaceMethodref->class_->getIndex(),
+                                   interfaceMethodref->nameAndType_->getIndex());
+        }
+    default:
+        throw std::invalid_argument("Constants with this tag can't be indexed.");
+    }
+}
+
+std::size_t Class::ConstantKeyHash::operator()(const ConstantKey& key) const noexcept
+{
+    return std::hash<uint64_t>{}(key.value * 31 + key.tag);
 }
 
 void Class::validateFlags(uint16_t flags)
@@ -772,131 +941,35 @@ void Class::validateFlags(uint16_t flags)
     }
 }
 
-void Class::fixClassBinary(std::ostream& os, const std::span<const unsigned char>& data)
+void Class::finalizeMethods() const
 {
-#ifdef _WIN32
-    fs::path jarPath = JAVA_INTERNAL_JAR;
-    auto pathToTempFile = std::filesystem::temp_directory_path() / "jvm_class_builder_temp_class.class";
-    try
+    // code finalized by the finalizer of a batch (see writeAll) is sized and written as is
+    auto analysis = getFinalizer().getAnalysis();
+    for (auto* method : methods_)
     {
-        // write input
+        if (method->codeAttribute_ != nullptr && !method->codeAttribute_->isFinalized())
         {
-            std::ofstream inputDataFile(pathToTempFile, std::ios::binary);
-            if (!inputDataFile) throw std::runtime_error("can't open input.class");
-            inputDataFile.write(reinterpret_cast<const char*>(data.data()),
-                                static_cast<std::streamsize>(data.size()));
-            inputDataFile.close();
+            method->codeAttribute_->finalize(analysis);
         }
-
-        // java.exe
-        const char* jh = std::getenv("JAVA_HOME");
-        if (!jh) throw std::runtime_error("JAVA_HOME not set");
-
-        fs::path javaExe = fs::path(jh) / "bin" / "java.exe";
-
-        std::string cmd =
-            javaExe.string() + " -jar " +
-            jarPath.string() + " " +
-            pathToTempFile.string() + " " +
-            pathToTempFile.string();
-
-
-        int code = std::system(cmd.c_str());
-        if (code != 0)
-            throw std::runtime_error("java -jar failed");
-
-        // read result
+        if (method->codeEmitter_ != nullptr && !method->codeEmitter_->isFinalized())
         {
-            std::ifstream in(pathToTempFile, std::ios::binary);
-            if (!in) throw std::runtime_error("can't open finalize.class");
-            os << in.rdbuf();
+            method->codeEmitter_->finalize(analysis);
         }
     }
-    catch (...)
-    {
-        // delete temp file
-        std::filesystem::remove(pathToTempFile);
-        throw;
-    }
-    //delete temp file
-    std::filesystem::remove(pathToTempFile);
-#else
-
-    JavaVM* jvm = nullptr;
-    JNIEnv* env = nullptr;
-
-    std::string classpath = std::string("-Djava.class.path=") + JAVA_INTERNAL_JAR;
-    JavaVMOption options[1];
-    options[0].optionString = classpath.data();
-    JavaVMInitArgs vm_args{};
-    vm_args.version = JNI_VERSION_1_8;
-    vm_args.nOptions = 1;
-    vm_args.options = options;
-    vm_args.ignoreUnrecognized = JNI_FALSE;
-
-    // run jvm
-    jint correctJvmCreation = JNI_CreateJavaVM(&jvm, reinterpret_cast<void**>(&env), &vm_args);
-    if (correctJvmCreation != JNI_OK || !env)
-    {
-        throw std::runtime_error("Failed to create JVM");
-    }
+}
 
-    try
+void Class::finalizeMethods(const ClassFinalizer& finalizer) const
+{
+    for (auto* method : methods_)
     {
-        // find class
-        jclass fixClass = env->FindClass("compilator/fix/FixClass");
-        if (!fixClass)
+        if (method->codeAttribute_ != nullptr)
         {
-            throw std::logic_error("FixClass not found");
+            method->codeAttribute_->finalize(finalizer.getAnalysis());
         }
-
-        // find static method
-        jmethodID fixMethod = env->GetStaticMethodID(fixClass, "fix", "([B)[B");
-        if (!fixMethod)
+        if (method->codeEmitter_ != nullptr)
         {
-            throw std::logic_error("FixClass.fix(byte[]) not found");
+            method->codeEmitter_->finalize(finalizer.getAnalysis());
         }
-
-        // convert c++ byte array to jvm byte array
-        jbyteArray inputArray = env->NewByteArray(static_cast<jsize>(data.size()));
-        env->SetByteArrayRegion(
-            inputArray, 0,
-            static_cast<jsize>(data.size()),
-            reinterpret_cast<const jbyte*>(data.data()));
-
-        // call fix method (method provide jByteArray)
-        auto resultArray = static_cast<jbyteArray>(env->CallStaticObjectMethod(fixClass, fixMethod, inputArray));
-
-        if (env->ExceptionCheck())
-        {
-            env->ExceptionDescribe();
-            env->ExceptionClear();
-            throw std::runtime_error("Java exception in FixClass.fix()");
-        }
-
-        // convert jvm byte array to c++ byte array
-        jsize resultSize = env->GetArrayLength(resultArray);
-        std::vector<unsigned char> result(resultSize);
-        env->GetByteArrayRegion(
-            resultArray, 0, resultSize,
-            reinterpret_cast<jbyte*>(result.data()));
-
-        // write data to stream
-        os.write(reinterpret_cast<const char*>(result.data()), static_cast<std::streamsize>(result.size()));
-
-        // clear refs
-        env->DeleteLocalRef(inputArray);
-        env->DeleteLocalRef(resultArray);
-        env->DeleteLocalRef(fixClass);
-    }
-    catch (...)
-    {
-        // destroy jvm
-        jvm->DestroyJavaVM();
-        throw;
     }
-
-    // destroy jvm
-    jvm->DestroyJavaVM();
-#endif
 }
+
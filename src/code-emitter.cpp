@@ -0,0 +1,588 @@
+#include "jvm/code-emitter.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "jvm/class.h"
+#include "jvm/constant-class.h"
+#include "jvm/constant-fieldref.h"
+#include "jvm/constant-interface-methodref.h"
+#include "jvm/constant-long.h"
+#include "jvm/constant-methodref.h"
+#include "jvm/constant-integer.h"
+#include "jvm/constant-name-and-type.h"
+#include "jvm/constant-utf-8-info.h"
+#include "jvm/method.h"
+#include "jvm/internal/bytecode.h"
+
+using namespace jvm;
+using internal::Bytecode;
+
+#define REQUIRE_FINALIZED() \
+if (!isFinalized()) { \
+    throw std::logic_error("CodeEmitter is not finalized"); \
+}
+
+CodeEmitter::CodeEmitter(Method* methodOwner) :
+    Attribute(methodOwner->getOwner()->getOrCreateUtf8Constant("Code")),
+    ClassFileElement(methodOwner),
+    memoryResource_(methodOwner->getOwner()->getMemoryResource()),
+    bytecode_(memoryResource_),
+    labels_(memoryResource_),
+    patches_(memoryResource_),
+    handlers_(memoryResource_)
+{
+}
+
+CodeEmitter::Label CodeEmitter::newLabel()
+{
+    labels_.emplace_back();
+    return Label(static_cast<uint32_t>(labels_.size() - 1));
+}
+
+CodeEmitter& CodeEmitter::bind(Label label)
+{
+    if (isFinalized_)
+    {
+        throw std::logic_error("CodeEmitter is finalized.");
+    }
+
+    auto& state = getLabelState(label);
+    if (state.offset >= 0)
+    {
+        throw std::logic_error("Label is already bound.");
+    }
+
+    // reached by falling through, by jumps, or only by jumps after unreachable code
+    if (stack_ != unknownStack)
+    {
+        mergeStack(state, stack_);
+    }
+    stack_ = state.stack != unknownStack ? state.stack : 0;
+    state.stack = stack_;
+    state.offset = static_cast<int32_t>(bytecode_.size());
+
+    // resolve forward jumps
+    for (auto index = state.firstPatch; index != UINT32_MAX; index = patches_[index].next)
+    {
+        const auto& patch = patches_[index];
+        writeJumpOffset(patch.offset, patch.source, patch.isWide, state.offset);
+    }
+    state.firstPatch = UINT32_MAX;
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emit(Instruction::Command command)
+{
+    if (Bytecode::getOperandSize(command) != 0)
+    {
+        throw std::invalid_argument("Instruction has operands, use the matching emit function.");
+    }
+
+    writeOpcode(command, Bytecode::getStackDelta(command));
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitPushInt(int32_t value)
+{
+    if (-1 <= value && value <= 5)
+    {
+        writeOpcode(static_cast<Instruction::Command>(Instruction::INSTRUCTION_iconst_0 + value), 1);
+    }
+    else if (INT8_MIN <= value && value <= INT8_MAX)
+    {
+        writeOpcode(Instruction::INSTRUCTION_bipush, 1);
+        writeU1(static_cast<uint8_t>(value));
+    }
+    else if (INT16_MIN <= value && value <= INT16_MAX)
+    {
+        writeOpcode(Instruction::INSTRUCTION_sipush, 1);
+        writeU2(static_cast<uint16_t>(value));
+    }
+    else
+    {
+        emitLdc(getOwner()->getOwner()->getOrCreateIntegerConstant(value));
+    }
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitPushLong(int64_t value)
+{
+    if (value == 0 || value == 1)
+    {
+        writeOpcode(static_cast<Instruction::Command>(Instruction::INSTRUCTION_lconst_0 + value), 2);
+        return *this;
+    }
+    return emitLdc(getOwner()->getOwner()->getOrCreateLongConstant(value));
+}
+
+CodeEmitter& CodeEmitter::emitLdc(Constant* constant)
+{
+    checkConstant(constant);
+    switch (constant->getTag())
+    {
+    case Constant::CONSTANT_Long:
+    case Constant::CONSTANT_Double:
+        writeOpcode(Instruction::INSTRUCTION_ldc2_w, 2);
+        writeU2(constant->getIndex());
+        break;
+    case Constant::CONSTANT_Integer:
+    case Constant::CONSTANT_Float:
+    case Constant::CONSTANT_String:
+    case Constant::CONSTANT_Class:
+    case Constant::CONSTANT_MethodHandle:
+    case Constant::CONSTANT_MethodType:
+    case Constant::CONSTANT_Dynamic:
+        if (constant->getIndex() <= UINT8_MAX)
+        {
+            writeOpcode(Instruction::INSTRUCTION_ldc, 1);
+            writeU1(static_cast<uint8_t>(constant->getIndex()));
+        }
+        else
+        {
+            writeOpcode(Instruction::INSTRUCTION_ldc_w, 1);
+            writeU2(constant->getIndex());
+        }
+        break;
+    default:
+        throw std::invalid_argument("ldc* instructions do not support this type of constants.");
+    }
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitLocal(Instruction::Command command, uint16_t index)
+{
+    // xload_n and xstore_n follow xload and xstore, four per type
+    Instruction::Command implicitBase;
+    if (Instruction::INSTRUCTION_iload <= command && command <= Instruction::INSTRUCTION_aload)
+    {
+        implicitBase = Instruction::INSTRUCTION_iload_0;
+    }
+    else if (Instruction::INSTRUCTION_istore <= command && command <= Instruction::INSTRUCTION_astore)
+    {
+        implicitBase = Instruction::INSTRUCTION_istore_0;
+    }
+    else
+    {
+        throw std::invalid_argument("Instruction doesn't load or store a local variable.");
+    }
+
+    auto stackDelta = Bytecode::getStackDelta(command);
+    if (index <= 3)
+    {
+        auto kind = command - (implicitBase == Instruction::INSTRUCTION_iload_0
+                                   ? Instruction::INSTRUCTION_iload
+                                   : Instruction::INSTRUCTION_istore);
+        writeOpcode(static_cast<Instruction::Command>(implicitBase + kind * 4 + index), stackDelta);
+    }
+    else if (index <= UINT8_MAX)
+    {
+        writeOpcode(command, stackDelta);
+        writeU1(static_cast<uint8_t>(index));
+    }
+    else
+    {
+        writeOpcode(Instruction::INSTRUCTION_wide, 0);
+        writeOpcode(command, stackDelta);
+        writeU2(index);
+    }
+
+    localsEnd_ = std::max<uint32_t>(localsEnd_, index + Bytecode::getLocalSlots(command));
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitIncrement(uint16_t index, int16_t value)
+{
+    if (index <= UINT8_MAX && INT8_MIN <= value && value <= INT8_MAX)
+    {
+        writeOpcode(Instruction::INSTRUCTION_iinc, 0);
+        writeU1(static_cast<uint8_t>(index));
+        writeU1(static_cast<uint8_t>(value));
+    }
+    else
+    {
+        writeOpcode(Instruction::INSTRUCTION_wide, 0);
+        writeOpcode(Instruction::INSTRUCTION_iinc, 0);
+        writeU2(index);
+        writeU2(static_cast<uint16_t>(value));
+    }
+
+    localsEnd_ = std::max<uint32_t>(localsEnd_, index + 1);
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitNewArray(Instruction::Type type)
+{
+    writeOpcode(Instruction::INSTRUCTION_newarray, 0);
+    writeU1(type);
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitType(Instruction::Command command, ConstantClass* classConstant)
+{
+    switch (command)
+    {
+    case Instruction::INSTRUCTION_new:
+    case Instruction::INSTRUCTION_anewarray:
+    case Instruction::INSTRUCTION_checkcast:
+    case Instruction::INSTRUCTION_instanceof:
+        checkConstant(classConstant);
+        writeOpcode(command, Bytecode::getStackDelta(command));
+        writeU2(classConstant->getIndex());
+        return *this;
+    default:
+        throw std::invalid_argument("Instruction has no class operand.");
+    }
+}
+
+CodeEmitter& CodeEmitter::emitMultiNewArray(ConstantClass* classConstant, uint8_t dimensions)
+{
+    if (dimensions == 0)
+    {
+        throw std::invalid_argument("multianewarray needs at least one dimension.");
+    }
+
+    checkConstant(classConstant);
+
+    // pop dimensions, push array
+    writeOpcode(Instruction::INSTRUCTION_multianewarray, 1 - static_cast<int32_t>(dimensions));
+    writeU2(classConstant->getIndex());
+    writeU1(dimensions);
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitField(Instruction::Command command, ConstantFieldref* field)
+{
+    switch (command)
+    {
+    case Instruction::INSTRUCTION_getstatic:
+    case Instruction::INSTRUCTION_putstatic:
+    case Instruction::INSTRUCTION_getfield:
+    case Instruction::INSTRUCTION_putfield:
+        break;
+    default:
+        throw std::invalid_argument("Instruction doesn't access a field.");
+    }
+
+    checkConstant(field);
+    auto descriptor = field->getNameAndType()->getDescriptor()->getString();
+    writeOpcode(command, Bytecode::getMemberStackDelta(command, descriptor));
+    writeU2(field->getIndex());
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitInvoke(Instruction::Command command, ConstantMethodref* method)
+{
+    switch (command)
+    {
+    case Instruction::INSTRUCTION_invokevirtual:
+    case Instruction::INSTRUCTION_invokespecial:
+    case Instruction::INSTRUCTION_invokestatic:
+        break;
+    default:
+        throw std::invalid_argument("Instruction doesn't invoke a class method.");
+    }
+
+    checkConstant(method);
+    auto descriptor = method->getNameAndType()->getDescriptor()->getString();
+    writeOpcode(command, Bytecode::getMemberStackDelta(command, descriptor));
+    writeU2(method->getIndex());
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitInvoke(Instruction::Command command, ConstantInterfaceMethodref* method)
+{
+    switch (command)
+    {
+    case Instruction::INSTRUCTION_invokeinterface:
+    case Instruction::INSTRUCTION_invokespecial:
+    case Instruction::INSTRUCTION_invokestatic:
+        break;
+    default:
+        throw std::invalid_argument("Instruction doesn't invoke an interface method.");
+    }
+
+    checkConstant(method);
+    auto descriptor = method->getNameAndType()->getDescriptor()->getString();
+    writeOpcode(command, Bytecode::getMemberStackDelta(command, descriptor));
+    writeU2(method->getIndex());
+    if (command == Instruction::INSTRUCTION_invokeinterface)
+    {
+        // u1 count (arguments with the receiver), u1 0
+        writeU1(static_cast<uint8_t>(Bytecode::getArgumentSlots(descriptor) + 1));
+        writeU1(0);
+    }
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::emitJump(Instruction::Command command, Label target)
+{
+    bool isWide = command == Instruction::INSTRUCTION_goto_w;
+    bool isConditional = (Instruction::INSTRUCTION_ifeq <= command && command <= Instruction::INSTRUCTION_if_acmpne)
+        || command == Instruction::INSTRUCTION_ifnull || command == Instruction::INSTRUCTION_ifnonnull;
+    if (!isConditional && !isWide && command != Instruction::INSTRUCTION_goto)
+    {
+        throw std::invalid_argument("Instruction is not a jump, subroutines are not supported.");
+    }
+
+    auto& state = getLabelState(target);
+    auto source = static_cast<uint32_t>(bytecode_.size());
+    auto stackDelta = Bytecode::getStackDelta(command);
+    int32_t targetStack = (stack_ == unknownStack ? 0 : stack_) + stackDelta;
+    writeOpcode(command, stackDelta);
+    mergeStack(state, targetStack);
+
+    auto operand = static_cast<uint32_t>(bytecode_.size());
+    if (state.offset >= 0)
+    {
+        bytecode_.resize(bytecode_.size() + (isWide ? 4 : 2));
+        writeJumpOffset(operand, source, isWide, state.offset);
+    }
+    else
+    {
+        patches_.push_back({operand, source, isWide, state.firstPatch});
+        state.firstPatch = static_cast<uint32_t>(patches_.size() - 1);
+        isWide ? writeU4(0) : writeU2(0);
+    }
+    hasJumps_ = true;
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::addTryCatch(Label start, Label end, Label handler, ConstantClass* catchClass)
+{
+    getLabelState(start);
+    getLabelState(end);
+    auto& state = getLabelState(handler);
+    if (state.offset >= 0 || state.stack != unknownStack)
+    {
+        throw std::logic_error("Exception handler must be registered before its label is bound or jumped to.");
+    }
+    if (catchClass != nullptr)
+    {
+        checkConstant(catchClass);
+    }
+
+    // the handler is entered with the exception on the stack
+    state.stack = 1;
+    maxStack_ = std::max<uint16_t>(maxStack_, 1);
+    handlers_.push_back({start, end, handler, catchClass});
+    return *this;
+}
+
+CodeEmitter& CodeEmitter::setMaxs(uint16_t maxStack, uint16_t maxLocals)
+{
+    maxStack_ = maxStack;
+    maxLocals_ = maxLocals;
+    isMaxsSet_ = true;
+    return *this;
+}
+
+void CodeEmitter::finalize()
+{
+    finalize(getOwner()->getOwner()->getFinalizer().getAnalysis());
+}
+
+void CodeEmitter::finalize(ClassFinalizer::Analysis analysis)
+{
+    if (analysis >= ClassFinalizer::Frames && (hasJumps_ || !handlers_.empty()))
+    {
+        throw std::logic_error("CodeEmitter doesn't compute stack map frames, use a JVM finalizer.");
+    }
+    if (isFinalized_)
+    {
+        return;
+    }
+
+    if (bytecode_.empty())
+    {
+        throw std::logic_error("Code is empty.");
+    }
+    if (bytecode_.size() > UINT16_MAX)
+    {
+        throw std::runtime_error("Too large instructions size.");
+    }
+    for (const auto& state : labels_)
+    {
+        if (state.firstPatch != UINT32_MAX)
+        {
+            throw std::logic_error("Jump to a label that is not bound.");
+        }
+    }
+    for (const auto& handler : handlers_)
+    {
+        if (labels_[handler.start.id_].offset < 0 || labels_[handler.end.id_].offset < 0
+            || labels_[handler.handler.id_].offset < 0)
+        {
+            throw std::logic_error("Exception handler label is not bound.");
+        }
+        if (labels_[handler.start.id_].offset >= labels_[handler.end.id_].offset)
+        {
+            throw std::logic_error("Exception handler protects no instruction.");
+        }
+    }
+    if (!isMaxsSet_ && localsEnd_ > UINT16_MAX)
+    {
+        throw std::runtime_error("Too many local variables.");
+    }
+    getOwner()->getOwner()->getMethodSizeLimits().check(getOwner(), bytecode_.size());
+
+    isFinalized_ = true;
+}
+
+uint16_t CodeEmitter::getMaxStack() const
+{
+    return maxStack_;
+}
+
+uint16_t CodeEmitter::getMaxLocals() const
+{
+    if (isMaxsSet_)
+    {
+        return maxLocals_;
+    }
+
+    // this and arguments, then every accessed slot
+    const Method* method = getOwner();
+    bool isStatic = method->getAccessFlags()->contains(Method::ACC_STATIC);
+    uint32_t arguments = Bytecode::getArgumentSlots(method->getDescriptor()->getString()) + (isStatic ? 0 : 1);
+    return static_cast<uint16_t>(std::min<uint32_t>(std::max(arguments, localsEnd_), UINT16_MAX));
+}
+
+std::span<const std::byte> CodeEmitter::getBytecode() const noexcept
+{
+    return bytecode_;
+}
+
+std::size_t CodeEmitter::getByteSize() const
+{
+    return Attribute::getByteSize();
+}
+
+void CodeEmitter::writeTo(ByteWriter& writer) const
+{
+    REQUIRE_FINALIZED();
+
+    Attribute::writeTo(writer);
+
+    // u2 max_stack;
+    writer.writeBigEndian(getMaxStack());
+
+    // u2 max_locals;
+    writer.writeBigEndian(getMaxLocals());
+
+    // u4 code_length;
+    writer.writeBigEndian(static_cast<uint32_t>(bytecode_.size()));
+
+    // u1 code[code_length];
+    writer.writeBytes(bytecode_.data(), bytecode_.size());
+
+    // u2 exception_table_length;
+    writer.writeBigEndian(static_cast<uint16_t>(handlers_.size()));
+
+    // exception_table[exception_table_length];
+    for (const auto& handler : handlers_)
+    {
+        writer.writeBigEndian(static_cast<uint16_t>(labels_[handler.start.id_].offset));
+        writer.writeBigEndian(static_cast<uint16_t>(labels_[handler.end.id_].offset));
+        writer.writeBigEndian(static_cast<uint16_t>(labels_[handler.handler.id_].offset));
+        writer.writeBigEndian(static_cast<uint16_t>(handler.catchClass != nullptr ? handler.catchClass->getIndex() : 0));
+    }
+
+    // u2 attributes_count;
+    writer.writeBigEndian(static_cast<uint16_t>(0));
+}
+
+size_t CodeEmitter::getContentSizeInBytes() const
+{
+    REQUIRE_FINALIZED();
+
+    // max_stack, max_locals, code_length, code, exception_table_length, exception_table, attributes_count
+    return 2 + 2 + 4 + bytecode_.size() + 2 + 8 * handlers_.size() + 2;
+}
+
+void CodeEmitter::writeOpcode(Instruction::Command command, int32_t stackDelta)
+{
+    if (isFinalized_)
+    {
+        throw std::logic_error("CodeEmitter is finalized.");
+    }
+
+    // unreachable code is assumed to start with an empty stack
+    int32_t stack = (stack_ == unknownStack ? 0 : stack_) + stackDelta;
+    if (stack < 0)
+    {
+        throw std::logic_error("Operand stack underflow.");
+    }
+    stack_ = Bytecode::isTerminal(command) ? unknownStack : stack;
+    maxStack_ = static_cast<uint16_t>(std::min<int32_t>(std::max<int32_t>(maxStack_, stack), UINT16_MAX));
+
+    bytecode_.push_back(static_cast<std::byte>(command));
+}
+
+void CodeEmitter::writeU1(uint8_t value)
+{
+    bytecode_.push_back(static_cast<std::byte>(value));
+}
+
+void CodeEmitter::writeU2(uint16_t value)
+{
+    bytecode_.push_back(static_cast<std::byte>(value >> 8));
+    bytecode_.push_back(static_cast<std::byte>(value));
+}
+
+void CodeEmitter::writeU4(uint32_t value)
+{
+    writeU2(static_cast<uint16_t>(value >> 16));
+    writeU2(static_cast<uint16_t>(value));
+}
+
+void CodeEmitter::checkConstant(const Constant* constant) const
+{
+    if (constant->getOwner() != getOwner()->getOwner())
+    {
+        throw std::invalid_argument("Constant belongs to another class.");
+    }
+}
+
+CodeEmitter::LabelState& CodeEmitter::getLabelState(Label label)
+{
+    if (label.id_ >= labels_.size())
+    {
+        throw std::invalid_argument("Label doesn't belong to this CodeEmitter.");
+    }
+    return labels_[label.id_];
+}
+
+void CodeEmitter::mergeStack(LabelState& state, int32_t stack)
+{
+    if (state.stack == unknownStack)
+    {
+        state.stack = stack;
+    }
+    else if (state.stack != stack)
+    {
+        throw std::logic_error("Different stack sizes at a label.");
+    }
+}
+
+void CodeEmitter::writeJumpOffset(uint32_t offset, uint32_t source, bool isWide, int32_t target)
+{
+    int32_t jump = target - static_cast<int32_t>(source);
+    auto* operand = bytecode_.data() + offset;
+    if (isWide)
+    {
+        for (int i = 3; i >= 0; --i)
+        {
+            operand[i] = static_cast<std::byte>(jump);
+            jump >>= 8;
+        }
+        return;
+    }
+
+    if (jump < INT16_MIN || jump > INT16_MAX)
+    {
+        throw std::out_of_range("Jump offset doesn't fit 16 bits, use goto_w.");
+    }
+    operand[0] = static_cast<std::byte>(jump >> 8);
+    operand[1] = static_cast<std::byte>(jump);
+}
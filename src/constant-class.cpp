@@ -1,9 +1,5 @@
 #include "jvm/constant-class.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 ConstantUtf8Info* ConstantClass::getName() const
@@ -11,11 +7,11 @@ ConstantUtf8Info* ConstantClass::getName() const
     return name_;
 }
 
-void ConstantClass::writeTo(std::ostream& os) const
+void ConstantClass::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
+    Constant::writeTo(writer);
     uint16_t nameIndex = name_->getIndex();
-    internal::Utils::writeBigEndian(os, nameIndex);
+    writer.writeBigEndian(nameIndex);
 }
 
 std::size_t ConstantClass::getByteSize() const
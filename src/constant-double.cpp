@@ -2,8 +2,6 @@
 
 #include <cstring>
 
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 double ConstantDouble::getValue() const
@@ -16,10 +14,10 @@ uint16_t ConstantDouble::getOccupiedSlots() const
     return 2;
 }
 
-void ConstantDouble::writeTo(std::ostream& os) const
+void ConstantDouble::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
-    internal::Utils::writeBigEndian(os, value_);
+    Constant::writeTo(writer);
+    writer.writeBigEndian(value_);
 }
 
 std::size_t ConstantDouble::getByteSize() const
@@ -2,8 +2,6 @@
 
 #include <cstring>
 
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 float ConstantFloat::getValue() const
@@ -11,10 +9,10 @@ float ConstantFloat::getValue() const
     return value_;
 }
 
-void ConstantFloat::writeTo(std::ostream& os) const
+void ConstantFloat::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
-    internal::Utils::writeBigEndian(os, value_);
+    Constant::writeTo(writer);
+    writer.writeBigEndian(value_);
 }
 
 std::size_t ConstantFloat::getByteSize() const
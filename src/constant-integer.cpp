@@ -1,9 +1,5 @@
 #include "jvm/constant-integer.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 int32_t ConstantInteger::getValue()
@@ -11,10 +7,10 @@ int32_t ConstantInteger::getValue()
     return value_;
 }
 
-void ConstantInteger::writeTo(std::ostream& os) const
+void ConstantInteger::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
-    internal::Utils::writeBigEndian(os, value_);
+    Constant::writeTo(writer);
+    writer.writeBigEndian(value_);
 }
 
 std::size_t ConstantInteger::getByteSize() const
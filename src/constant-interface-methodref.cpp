@@ -2,8 +2,6 @@
 
 #include <cassert>
 
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 ConstantClass* ConstantInterfaceMethodref::getClass() const
@@ -16,15 +14,15 @@ ConstantNameAndType* ConstantInterfaceMethodref::getNameAndType() const
     return nameAndType_;
 }
 
-void ConstantInterfaceMethodref::writeTo(std::ostream& os) const
+void ConstantInterfaceMethodref::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
+    Constant::writeTo(writer);
 
     uint16_t classIndex = class_->getIndex();
-    internal::Utils::writeBigEndian(os, classIndex);
+    writer.writeBigEndian(classIndex);
 
     uint16_t nameAndTypeIndex = nameAndType_->getIndex();
-    internal::Utils::writeBigEndian(os, nameAndTypeIndex);
+    writer.writeBigEndian(nameAndTypeIndex);
 }
 
 std::size_t ConstantInterfaceMethodref::getByteSize() const
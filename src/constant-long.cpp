@@ -1,7 +1,5 @@
 #include "jvm/constant-long.h"
 
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 int64_t ConstantLong::getValue() const
@@ -14,10 +12,10 @@ uint16_t ConstantLong::getOccupiedSlots() const
     return 2;
 }
 
-void ConstantLong::writeTo(std::ostream& os) const
+void ConstantLong::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
-    internal::Utils::writeBigEndian(os, value_);
+    Constant::writeTo(writer);
+    writer.writeBigEndian(value_);
 }
 
 std::size_t ConstantLong::getByteSize() const
@@ -2,8 +2,6 @@
 
 #include <cassert>
 
-#include "jvm/internal/utils.h"
-
 namespace jvm
 {
     ConstantUtf8Info* ConstantNameAndType::getName() const
@@ -16,15 +14,15 @@ namespace jvm
         return descriptor_;
     }
 
-    void ConstantNameAndType::writeTo(std::ostream& os) const
+    void ConstantNameAndType::writeTo(ByteWriter& writer) const
     {
-        Constant::writeTo(os);
+        Constant::writeTo(writer);
 
         uint16_t nameIndex = name_->getIndex();
-        internal::Utils::writeBigEndian(os, nameIndex);
+        writer.writeBigEndian(nameIndex);
 
         uint16_t descriptorIndex = descriptor_->getIndex();
-        internal::Utils::writeBigEndian(os, descriptorIndex);
+        writer.writeBigEndian(descriptorIndex);
     }
 
     std::size_t ConstantNameAndType::getByteSize() const
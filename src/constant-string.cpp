@@ -1,9 +1,5 @@
 #include "jvm/constant-string.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 ConstantUtf8Info* ConstantString::getString()
@@ -11,11 +7,11 @@ ConstantUtf8Info* ConstantString::getString()
     return string_;
 }
 
-void ConstantString::writeTo(std::ostream& os) const
+void ConstantString::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
+    Constant::writeTo(writer);
     uint16_t stringIndex = string_->getIndex();
-    internal::Utils::writeBigEndian(os, stringIndex);
+    writer.writeBigEndian(stringIndex);
 }
 
 std::size_t ConstantString::getByteSize() const
@@ -1,9 +1,5 @@
 #include "jvm/constant-utf-8-info.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 std::string ConstantUtf8Info::getString() const
@@ -16,12 +12,12 @@ ConstantUtf8Info::ConstantUtf8Info(std::string string, Class* classOwner) :
 {
 }
 
-void ConstantUtf8Info::writeTo(std::ostream& os) const
+void ConstantUtf8Info::writeTo(ByteWriter& writer) const
 {
-    Constant::writeTo(os);
+    Constant::writeTo(writer);
     uint16_t size = string_.size();
-    internal::Utils::writeBigEndian(os, size);
-    os.write(string_.c_str(), size);
+    writer.writeBigEndian(size);
+    writer.writeBytes(string_.data(), size);
 }
 
 std::size_t ConstantUtf8Info::getByteSize() const
@@ -1,9 +1,5 @@
 #include "jvm/constant.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
-
 using namespace jvm;
 
 
@@ -26,9 +22,9 @@ Constant::Constant(Tag tag, Class* classOwner) : ClassFileElement(classOwner), t
 {
 }
 
-void Constant::writeTo(std::ostream& os) const
+void Constant::writeTo(ByteWriter& writer) const
 {
-    internal::Utils::writeBigEndian(os, tag_);
+    writer.writeBigEndian(tag_);
 }
 
 void Constant::setIndex(uint32_t index)
@@ -0,0 +1,282 @@
+#include "jvm/control-flow-graph.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <utility>
+
+#include "jvm/attribute-code.h"
+#include "jvm/exception-handler.h"
+#include "jvm/instruction-jump.h"
+#include "jvm/instruction-switch.h"
+#include "jvm/internal/bytecode.h"
+
+using namespace jvm;
+using internal::Bytecode;
+
+namespace
+{
+    using Positions = std::vector<std::pair<const Instruction*, uint32_t>>;
+
+    /**
+     * @brief Get the position of the instruction a label is bound to.
+     *
+     * @param positions Positions of the instructions, sorted by address.
+     * @throws std::logic_error If the label is not bound to an instruction of the code.
+     */
+    uint32_t getPosition(const Positions& positions, const Label* label)
+    {
+        const Instruction* instruction = label->getInstruction();
+        auto position = std::lower_bound(positions.begin(), positions.end(), instruction,
+                                         [](const auto& entry, const Instruction* key) { return entry.first < key; });
+        if (position == positions.end() || position->first != instruction)
+        {
+            throw std::logic_error("Label is not bound to an instruction of this code.");
+        }
+        return position->second;
+    }
+}
+
+ControlFlowGraph::ControlFlowGraph(const AttributeCode& code)
+{
+    auto instructions = code.getInstructions();
+    auto count = static_cast<uint32_t>(instructions.size());
+    if (count == 0)
+    {
+        successorStarts_.push_back(0);
+        exceptionSuccessorStarts_.push_back(0);
+        predecessorStarts_.push_back(0);
+        return;
+    }
+
+    // a sorted array is cheaper to build than a hash map for the few hundred instructions of a typical method
+    Positions positions;
+    positions.reserve(count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        positions.emplace_back(instructions[i], i);
+    }
+    std::sort(positions.begin(), positions.end());
+
+    // leaders are marked with 1 in blockAt_, targets are resolved once in code order
+    blockAt_.assign(count, 0);
+    blockAt_[0] = 1;
+    std::vector<uint32_t> targets;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const Instruction* instruction = instructions[i];
+        if (instruction->getOperandKind() == Instruction::OPERAND_jump)
+        {
+            targets.push_back(getPosition(positions, static_cast<const InstructionJump*>(instruction)->getJumpLabel()));
+            blockAt_[targets.back()] = 1;
+        }
+        else if (instruction->getOperandKind() == Instruction::OPERAND_switch)
+        {
+            const auto* switchInstruction = static_cast<const InstructionSwitch*>(instruction);
+            targets.push_back(getPosition(positions, switchInstruction->getDefaultLabel()));
+            blockAt_[targets.back()] = 1;
+            for (const auto* label : switchInstruction->getLabels())
+            {
+                targets.push_back(getPosition(positions, label));
+                blockAt_[targets.back()] = 1;
+            }
+        }
+        else if (!Bytecode::isTerminal(instruction->getCommandCode()))
+        {
+            continue;
+        }
+        if (i + 1 < count)
+        {
+            blockAt_[i + 1] = 1;
+        }
+    }
+    std::vector<std::array<uint32_t, 3>> ranges; // start, end and handler of each exception range
+    ranges.reserve(code.exceptionHandlers_.size());
+    for (const auto* handler : code.exceptionHandlers_)
+    {
+        ranges.push_back({
+            getPosition(positions, handler->getTryStartLabel()),
+            getPosition(positions, handler->getTryFinishLabel()),
+            getPosition(positions, handler->getCatchStartLabel())
+        });
+        for (auto position : ranges.back())
+        {
+            blockAt_[position] = 1;
+        }
+    }
+
+    // blocks
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (blockAt_[i] != 0)
+        {
+            if (!blocks_.empty())
+            {
+                blocks_.back().end = i;
+            }
+            blocks_.push_back({i, count});
+        }
+        blockAt_[i] = static_cast<uint32_t>(blocks_.size() - 1);
+    }
+    auto blockCount = static_cast<uint32_t>(blocks_.size());
+
+    // normal successors
+    successorStarts_.reserve(blockCount + 1);
+    successors_.reserve(blockCount + targets.size());
+    auto target = targets.begin();
+    for (uint32_t block = 0; block < blockCount; ++block)
+    {
+        successorStarts_.push_back(static_cast<uint32_t>(successors_.size()));
+        const Instruction* last = instructions[blocks_[block].end - 1];
+        if (!Bytecode::isTerminal(last->getCommandCode()) && block + 1 < blockCount)
+        {
+            successors_.push_back(block + 1);
+        }
+        std::size_t targetCount = 0;
+        if (last->getOperandKind() == Instruction::OPERAND_jump)
+        {
+            targetCount = 1;
+        }
+        else if (last->getOperandKind() == Instruction::OPERAND_switch)
+        {
+            targetCount = 1 + static_cast<const InstructionSwitch*>(last)->getLabels().size();
+        }
+        for (; targetCount != 0; --targetCount)
+        {
+            successors_.push_back(blockAt_[*target++]);
+        }
+
+        // switches may share targets, a jump may target the next block
+        auto first = successors_.begin() + successorStarts_.back();
+        std::sort(first, successors_.end());
+        successors_.erase(std::unique(first, successors_.end()), successors_.end());
+    }
+    successorStarts_.push_back(static_cast<uint32_t>(successors_.size()));
+
+    // exception successors: range boundaries are leaders, so a range covers whole blocks
+    std::vector<std::pair<uint32_t, uint32_t>> handlerEdges;
+    for (const auto& [start, end, handler] : ranges)
+    {
+        for (uint32_t block = blockAt_[start]; block < blockAt_[end]; ++block)
+        {
+            handlerEdges.emplace_back(block, blockAt_[handler]);
+        }
+    }
+    std::stable_sort(handlerEdges.begin(), handlerEdges.end(),
+                     [](const auto& left, const auto& right) { return left.first < right.first; });
+    exceptionSuccessorStarts_.reserve(blockCount + 1);
+    exceptionSuccessors_.reserve(handlerEdges.size());
+    auto edge = handlerEdges.begin();
+    for (uint32_t block = 0; block < blockCount; ++block)
+    {
+        auto start = static_cast<uint32_t>(exceptionSuccessors_.size());
+        exceptionSuccessorStarts_.push_back(start);
+        for (; edge != handlerEdges.end() && edge->first == block; ++edge)
+        {
+            // handlers of several catch types may share a block
+            if (std::find(exceptionSuccessors_.begin() + start, exceptionSuccessors_.end(), edge->second)
+                == exceptionSuccessors_.end())
+            {
+                exceptionSuccessors_.push_back(edge->second);
+            }
+        }
+    }
+    exceptionSuccessorStarts_.push_back(static_cast<uint32_t>(exceptionSuccessors_.size()));
+
+    buildPredecessors();
+    buildReversePostorder();
+}
+
+std::span<const uint32_t> ControlFlowGraph::getSuccessors(uint32_t block) const
+{
+    uint32_t start = successorStarts_.at(block);
+    return std::span(successors_).subspan(start, successorStarts_[block + 1] - start);
+}
+
+std::span<const uint32_t> ControlFlowGraph::getExceptionSuccessors(uint32_t block) const
+{
+    uint32_t start = exceptionSuccessorStarts_.at(block);
+    return std::span(exceptionSuccessors_).subspan(start, exceptionSuccessorStarts_[block + 1] - start);
+}
+
+std::span<const uint32_t> ControlFlowGraph::getPredecessors(uint32_t block) const
+{
+    uint32_t start = predecessorStarts_.at(block);
+    return std::span(predecessors_).subspan(start, predecessorStarts_[block + 1] - start);
+}
+
+bool ControlFlowGraph::isReachable(uint32_t block) const
+{
+    return isReachable_.at(block);
+}
+
+uint32_t ControlFlowGraph::getBlockAt(std::size_t position) const
+{
+    return blockAt_.at(position);
+}
+
+void ControlFlowGraph::buildPredecessors()
+{
+    auto blockCount = static_cast<uint32_t>(blocks_.size());
+
+    // count the edges into each block, then fill; sources are visited in ascending order
+    auto visitEdges = [&](auto&& visit)
+    {
+        for (uint32_t block = 0; block < blockCount; ++block)
+        {
+            auto normal = getSuccessors(block);
+            for (auto successor : normal)
+            {
+                visit(block, successor);
+            }
+            for (auto successor : getExceptionSuccessors(block))
+            {
+                if (std::find(normal.begin(), normal.end(), successor) == normal.end())
+                {
+                    visit(block, successor);
+                }
+            }
+        }
+    };
+    predecessorStarts_.assign(blockCount + 1, 0);
+    visitEdges([&](uint32_t, uint32_t successor) { ++predecessorStarts_[successor + 1]; });
+    for (uint32_t block = 0; block < blockCount; ++block)
+    {
+        predecessorStarts_[block + 1] += predecessorStarts_[block];
+    }
+    predecessors_.resize(predecessorStarts_.back());
+    std::vector<uint32_t> fill(predecessorStarts_.begin(), predecessorStarts_.end() - 1);
+    visitEdges([&](uint32_t block, uint32_t successor) { predecessors_[fill[successor]++] = block; });
+}
+
+void ControlFlowGraph::buildReversePostorder()
+{
+    auto blockCount = static_cast<uint32_t>(blocks_.size());
+    isReachable_.assign(blockCount, false);
+    reversePostorder_.reserve(blockCount);
+
+    // depth-first search with an explicit stack of blocks and their next edge
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.emplace_back(0, 0);
+    isReachable_[0] = true;
+    while (!stack.empty())
+    {
+        auto& [block, edge] = stack.back();
+        auto normal = getSuccessors(block);
+        auto exceptional = getExceptionSuccessors(block);
+        if (edge == normal.size() + exceptional.size())
+        {
+            reversePostorder_.push_back(block);
+            stack.pop_back();
+            continue;
+        }
+        uint32_t successor = edge < normal.size() ? normal[edge] : exceptional[edge - normal.size()];
+        ++edge;
+        if (!isReachable_[successor])
+        {
+            isReachable_[successor] = true;
+            stack.emplace_back(successor, 0);
+        }
+    }
+    std::reverse(reversePostorder_.begin(), reversePostorder_.end());
+}
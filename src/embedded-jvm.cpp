@@ -0,0 +1,551 @@
+#include "jvm/embedded-jvm.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <jni.h>
+#include <limits>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+
+#include "java-internal-paths.h"
+
+using namespace jvm;
+
+namespace
+{
+    /**
+     * @brief State of the process-wide JVM.
+     *
+     * Fixing holds @c mutex shared, so any number of threads call into the JVM concurrently,
+     * while starting and stopping the JVM holds it exclusively.
+     */
+    struct JvmState
+    {
+        std::shared_mutex mutex{};
+        JavaVM* vm = nullptr;
+        uint64_t generation = 0; ///< Incremented every time the JVM stops.
+        bool isOwned = false; ///< True if the JVM was created by this library.
+        bool isDestroyed = false; ///< True if the JVM was destroyed, it can't be created again.
+        bool isPinned = false; ///< True if the JVM was started lazily and is kept until the process exits.
+        std::size_t references = 0;
+        jclass fixClass = nullptr; ///< Global reference to @c FixClass.
+        jmethodID fixMethod = nullptr; ///< @c FixClass.fix(byte[]).
+        jmethodID fixAllMethod = nullptr; ///< @c FixClass.fixAll(byte[], int[]).
+    };
+
+    JvmState& getState()
+    {
+        static JvmState state;
+        return state;
+    }
+
+    /**
+     * @brief Attachment of the current thread to the JVM.
+     *
+     * Threads are attached as daemons on first use, so they never block JVM destruction,
+     * and are detached when they exit, unless the JVM was stopped in the meantime.
+     */
+    struct ThreadAttachment
+    {
+        JavaVM* vm = nullptr;
+        uint64_t generation = 0;
+        JNIEnv* env = nullptr;
+        bool isAttachedHere = false; ///< False if the thread was attached by someone else.
+
+        ~ThreadAttachment()
+        {
+            if (!isAttachedHere)
+            {
+                return;
+            }
+
+            auto& state = getState();
+            std::shared_lock lock(state.mutex);
+            if (state.vm == vm && state.generation == generation)
+            {
+                vm->DetachCurrentThread();
+            }
+        }
+    };
+
+    thread_local ThreadAttachment threadAttachment;
+
+    /**
+     * @brief Get the JNI environment of the current thread, attaching the thread if needed.
+     * @note @c state.mutex must be locked, shared or exclusively.
+     */
+    JNIEnv* getEnv(const JvmState& state)
+    {
+        auto& attachment = threadAttachment;
+        if (attachment.vm == state.vm && attachment.generation == state.generation)
+        {
+            return attachment.env;
+        }
+
+        JNIEnv* env = nullptr;
+        bool isAttachedHere = false;
+        jint result = state.vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_8);
+        if (result == JNI_EDETACHED)
+        {
+            result = state.vm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&env), nullptr);
+            isAttachedHere = true;
+        }
+        if (result != JNI_OK || env == nullptr)
+        {
+            throw std::runtime_error("Failed to attach thread to JVM");
+        }
+
+        attachment.vm = state.vm;
+        attachment.generation = state.generation;
+        attachment.env = env;
+        attachment.isAttachedHere = isAttachedHere;
+        return env;
+    }
+
+    /**
+     * @brief Local reference frame, popped when leaving the scope.
+     */
+    class LocalFrame
+    {
+    public:
+        LocalFrame(JNIEnv* env, jint capacity) : env_(env)
+        {
+            if (env_->PushLocalFrame(capacity) != JNI_OK)
+            {
+                env_->ExceptionClear();
+                throw std::runtime_error("Failed to allocate JNI local frame");
+            }
+        }
+
+        ~LocalFrame()
+        {
+            env_->PopLocalFrame(nullptr);
+        }
+
+        LocalFrame(const LocalFrame&) = delete;
+        LocalFrame& operator=(const LocalFrame&) = delete;
+
+    private:
+        JNIEnv* env_;
+    };
+
+    /**
+     * @brief Start the JVM if it is not running.
+     * @note @c state.mutex must be locked.
+     */
+    void startVm(JvmState& state)
+    {
+        if (state.isDestroyed)
+        {
+            throw std::logic_error("Embedded JVM can't be restarted after shutdown.");
+        }
+
+        // reuse a JVM hosting this process
+        JavaVM* vm = nullptr;
+        jsize createdCount = 0;
+        if (JNI_GetCreatedJavaVMs(&vm, 1, &createdCount) == JNI_OK && createdCount > 0)
+        {
+            state.vm = vm;
+            state.isOwned = false;
+            return;
+        }
+
+        std::string classpath = std::string("-Djava.class.path=") + JAVA_INTERNAL_JAR;
+        JavaVMOption options[1];
+        options[0].optionString = classpath.data();
+        JavaVMInitArgs vmArgs{};
+        vmArgs.version = JNI_VERSION_1_8;
+        vmArgs.nOptions = 1;
+        vmArgs.options = options;
+        vmArgs.ignoreUnrecognized = JNI_FALSE;
+
+        // run jvm
+        JNIEnv* env = nullptr;
+        jint correctJvmCreation = JNI_CreateJavaVM(&vm, reinterpret_cast<void**>(&env), &vmArgs);
+        if (correctJvmCreation != JNI_OK || !env)
+        {
+            throw std::runtime_error("Failed to create JVM");
+        }
+        // the creating thread is attached as a non-daemon thread, which would block destruction from other threads
+        vm->DetachCurrentThread();
+
+        state.vm = vm;
+        state.isOwned = true;
+    }
+
+    /**
+     * @brief Resolve @c FixClass.fix, @c FixClass.fixAll and keep @c FixClass loaded while the JVM is running.
+     * @note @c state.mutex must be locked.
+     */
+    void resolveFixMethod(JvmState& state)
+    {
+        JNIEnv* env = getEnv(state);
+        LocalFrame frame(env, 1);
+
+        // find class
+        jclass fixClass = env->FindClass("compilator/fix/FixClass");
+        if (!fixClass)
+        {
+            env->ExceptionClear();
+            throw std::logic_error("FixClass not found");
+        }
+
+        // find static method
+        jmethodID fixMethod = env->GetStaticMethodID(fixClass, "fix", "([B)[B");
+        if (!fixMethod)
+        {
+            env->ExceptionClear();
+            throw std::logic_error("FixClass.fix(byte[]) not found");
+        }
+
+        jmethodID fixAllMethod = env->GetStaticMethodID(fixClass, "fixAll", "([B[I)[B");
+        if (!fixAllMethod)
+        {
+            env->ExceptionClear();
+            throw std::logic_error("FixClass.fixAll(byte[], int[]) not found");
+        }
+
+        state.fixClass = static_cast<jclass>(env->NewGlobalRef(fixClass));
+        state.fixMethod = fixMethod;
+        state.fixAllMethod = fixAllMethod;
+    }
+
+    /**
+     * @brief Start the JVM and resolve @c FixClass methods if not done yet.
+     * @note @c state.mutex must be locked.
+     */
+    void ensureStarted(JvmState& state)
+    {
+        if (state.vm == nullptr)
+        {
+            startVm(state);
+        }
+        if (state.fixClass == nullptr)
+        {
+            resolveFixMethod(state);
+        }
+    }
+
+    /**
+     * @brief Destroy the JVM if nothing references it anymore.
+     * @note @c state.mutex must be locked.
+     */
+    void stopIfUnused(JvmState& state)
+    {
+        if (state.vm == nullptr || state.references != 0 || state.isPinned)
+        {
+            return;
+        }
+
+        if (state.fixClass != nullptr)
+        {
+            getEnv(state)->DeleteGlobalRef(state.fixClass);
+        }
+        state.fixClass = nullptr;
+        state.fixMethod = nullptr;
+        state.fixAllMethod = nullptr;
+
+        if (state.isOwned)
+        {
+            state.vm->DestroyJavaVM();
+            state.isDestroyed = true;
+        }
+        state.vm = nullptr;
+        ++state.generation;
+    }
+
+    /**
+     * @brief Copy a C++ byte array to a new Java byte array.
+     */
+    jbyteArray toJavaArray(JNIEnv* env, std::span<const unsigned char> data)
+    {
+        jbyteArray array = env->NewByteArray(static_cast<jsize>(data.size()));
+        if (!array)
+        {
+            env->ExceptionClear();
+            throw std::runtime_error("Failed to allocate Java byte array");
+        }
+        env->SetByteArrayRegion(
+            array, 0,
+            static_cast<jsize>(data.size()),
+            reinterpret_cast<const jbyte*>(data.data()));
+        return array;
+    }
+
+    /**
+     * @brief Direct access to the elements of a Java primitive array, released when leaving the scope.
+     *
+     * No JNI calls may be made while the array is accessed.
+     */
+    class CriticalArray
+    {
+    public:
+        CriticalArray(JNIEnv* env, jarray array) : env_(env), array_(array)
+        {
+            data_ = static_cast<unsigned char*>(env_->GetPrimitiveArrayCritical(array_, nullptr));
+            if (data_ == nullptr)
+            {
+                env_->ExceptionClear();
+                throw std::runtime_error("Failed to access Java array");
+            }
+        }
+
+        ~CriticalArray()
+        {
+            env_->ReleasePrimitiveArrayCritical(array_, data_, 0);
+        }
+
+        CriticalArray(const CriticalArray&) = delete;
+        CriticalArray& operator=(const CriticalArray&) = delete;
+
+        [[nodiscard]] unsigned char* data() const { return data_; }
+
+    private:
+        JNIEnv* env_;
+        jarray array_;
+        unsigned char* data_ = nullptr;
+    };
+
+    /**
+     * @brief Rethrow a pending Java exception as a C++ one.
+     */
+    void checkJavaException(JNIEnv* env, const char* message)
+    {
+        if (env->ExceptionCheck())
+        {
+            env->ExceptionDescribe();
+            env->ExceptionClear();
+            throw std::runtime_error(message);
+        }
+    }
+
+    /**
+     * @brief Call @c FixClass.fix from the current thread.
+     * @note @c state.mutex must be locked shared, and the JVM must be started.
+     */
+    std::vector<unsigned char> callFix(const JvmState& state, std::span<const unsigned char> data)
+    {
+        JNIEnv* env = getEnv(state);
+        LocalFrame frame(env, 2);
+
+        // convert c++ byte array to jvm byte array
+        jbyteArray inputArray = toJavaArray(env, data);
+
+        // call fix method (method provide jByteArray)
+        auto resultArray = static_cast<jbyteArray>(
+            env->CallStaticObjectMethod(state.fixClass, state.fixMethod, inputArray));
+        checkJavaException(env, "Java exception in FixClass.fix()");
+
+        // convert jvm byte array to c++ byte array
+        jsize resultSize = env->GetArrayLength(resultArray);
+        std::vector<unsigned char> result(resultSize);
+        env->GetByteArrayRegion(
+            resultArray, 0, resultSize,
+            reinterpret_cast<jbyte*>(result.data()));
+
+        return result;
+    }
+
+    /**
+     * @brief Call @c FixClass.fix from the current thread, accessing both arrays in place.
+     * @note @c state.mutex must be locked shared, and the JVM must be started.
+     */
+    void callFixInPlace(const JvmState& state,
+                        std::size_t size,
+                        const EmbeddedJvm::Serializer& serialize,
+                        const EmbeddedJvm::Consumer& consume)
+    {
+        JNIEnv* env = getEnv(state);
+        LocalFrame frame(env, 2);
+
+        // serialize straight into jvm byte array
+        jbyteArray inputArray = env->NewByteArray(static_cast<jsize>(size));
+        if (!inputArray)
+        {
+            env->ExceptionClear();
+            throw std::runtime_error("Failed to allocate Java byte array");
+        }
+        {
+            CriticalArray input(env, inputArray);
+            serialize({input.data(), size});
+        }
+
+        // call fix method (method provide jByteArray)
+        auto resultArray = static_cast<jbyteArray>(
+            env->CallStaticObjectMethod(state.fixClass, state.fixMethod, inputArray));
+        checkJavaException(env, "Java exception in FixClass.fix()");
+
+        // consume straight from jvm byte array
+        auto resultSize = static_cast<std::size_t>(env->GetArrayLength(resultArray));
+        CriticalArray result(env, resultArray);
+        consume({result.data(), resultSize});
+    }
+
+    /**
+     * @brief Call @c FixClass.fixAll from the current thread.
+     * @note @c state.mutex must be locked shared, and the JVM must be started.
+     */
+    EmbeddedJvm::Batch callFixAll(const JvmState& state,
+                                  std::span<const unsigned char> data,
+                                  std::span<const std::size_t> offsets)
+    {
+        JNIEnv* env = getEnv(state);
+        LocalFrame frame(env, 3);
+
+        auto count = static_cast<jsize>(offsets.size() - 1);
+
+        // convert c++ arrays to jvm arrays
+        jbyteArray inputArray = toJavaArray(env, data);
+        std::vector<jint> inputOffsets(offsets.begin(), offsets.end());
+        jintArray offsetsArray = env->NewIntArray(static_cast<jsize>(inputOffsets.size()));
+        if (!offsetsArray)
+        {
+            env->ExceptionClear();
+            throw std::runtime_error("Failed to allocate Java int array");
+        }
+        env->SetIntArrayRegion(offsetsArray, 0, static_cast<jsize>(inputOffsets.size()), inputOffsets.data());
+
+        // call fixAll method (lengths of fixed classes, then fixed classes)
+        auto resultArray = static_cast<jbyteArray>(
+            env->CallStaticObjectMethod(state.fixClass, state.fixAllMethod, inputArray, offsetsArray));
+        checkJavaException(env, "Java exception in FixClass.fixAll()");
+
+        // read big-endian lengths
+        std::vector<unsigned char> lengths(4 * static_cast<std::size_t>(count));
+        env->GetByteArrayRegion(
+            resultArray, 0, static_cast<jsize>(lengths.size()),
+            reinterpret_cast<jbyte*>(lengths.data()));
+
+        EmbeddedJvm::Batch result;
+        result.offsets.reserve(offsets.size());
+        result.offsets.push_back(0);
+        for (std::size_t i = 0; i < lengths.size(); i += 4)
+        {
+            std::size_t length = static_cast<std::size_t>(lengths[i]) << 24
+                | static_cast<std::size_t>(lengths[i + 1]) << 16
+                | static_cast<std::size_t>(lengths[i + 2]) << 8
+                | static_cast<std::size_t>(lengths[i + 3]);
+            result.offsets.push_back(result.offsets.back() + length);
+        }
+
+        // read fixed classes
+        result.data.resize(result.offsets.back());
+        env->GetByteArrayRegion(
+            resultArray, static_cast<jsize>(lengths.size()), static_cast<jsize>(result.data.size()),
+            reinterpret_cast<jbyte*>(result.data.data()));
+
+        return result;
+    }
+}
+
+EmbeddedJvm::EmbeddedJvm()
+{
+    startup();
+}
+
+EmbeddedJvm::~EmbeddedJvm()
+{
+    shutdown();
+}
+
+void EmbeddedJvm::startup()
+{
+    auto& state = getState();
+    std::unique_lock lock(state.mutex);
+
+    ensureStarted(state);
+    ++state.references;
+}
+
+void EmbeddedJvm::shutdown()
+{
+    auto& state = getState();
+    std::unique_lock lock(state.mutex);
+
+    if (state.references == 0)
+    {
+        throw std::logic_error("Embedded JVM shutdown() without matching startup().");
+    }
+    --state.references;
+    stopIfUnused(state);
+}
+
+bool EmbeddedJvm::isRunning()
+{
+    auto& state = getState();
+    std::shared_lock lock(state.mutex);
+
+    return state.vm != nullptr;
+}
+
+/**
+ * @brief Run @p call with the JVM started, starting it lazily if needed.
+ */
+template <class Call>
+static auto callStarted(Call call)
+{
+    auto& state = getState();
+
+    {
+        std::shared_lock lock(state.mutex);
+        if (state.fixClass != nullptr)
+        {
+            return call(state);
+        }
+    }
+
+    // start lazily
+    {
+        std::unique_lock lock(state.mutex);
+        if (state.references == 0)
+        {
+            state.isPinned = true;
+        }
+        ensureStarted(state);
+    }
+
+    // a pinned jvm is never stopped, a referenced one may be stopped in between by its owner
+    std::shared_lock lock(state.mutex);
+    if (state.fixClass == nullptr)
+    {
+        throw std::logic_error("Embedded JVM can't be restarted after shutdown.");
+    }
+    return call(state);
+}
+
+std::vector<unsigned char> EmbeddedJvm::fix(std::span<const unsigned char> data)
+{
+    return callStarted([data](const JvmState& state) { return callFix(state, data); });
+}
+
+void EmbeddedJvm::fix(std::size_t size, const Serializer& serialize, const Consumer& consume)
+{
+    if (size > static_cast<std::size_t>(std::numeric_limits<jint>::max()))
+    {
+        throw std::invalid_argument("Class is too large for a Java array.");
+    }
+
+    callStarted([&](const JvmState& state) { callFixInPlace(state, size, serialize, consume); });
+}
+
+EmbeddedJvm::Batch EmbeddedJvm::fixAll(std::span<const unsigned char> data, std::span<const std::size_t> offsets)
+{
+    if (data.size() > static_cast<std::size_t>(std::numeric_limits<jint>::max()))
+    {
+        throw std::invalid_argument("Batch is too large for a Java array.");
+    }
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != data.size()
+        || !std::ranges::is_sorted(offsets))
+    {
+        throw std::invalid_argument("Batch offsets must ascend from 0 to the data size.");
+    }
+    if (offsets.size() == 1)
+    {
+        return {{}, {0}};
+    }
+
+    return callStarted([data, offsets](const JvmState& state) { return callFixAll(state, data, offsets); });
+}
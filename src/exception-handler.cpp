@@ -7,7 +7,6 @@
 #include "jvm/constant-class.h"
 #include "jvm/instruction.h"
 #include "jvm/label.h"
-#include "jvm/internal/utils.h"
 
 using namespace jvm;
 
@@ -31,7 +30,7 @@ ConstantClass* ExceptionHandler::getCatchClass() const
     return catchClass_;
 }
 
-void ExceptionHandler::writeTo(std::ostream& os) const
+void ExceptionHandler::writeTo(ByteWriter& writer) const
 {
     // Labels must be bound to instructions.
     Instruction* startInstruction = tryStartLabel_->getInstruction();
@@ -59,10 +58,10 @@ void ExceptionHandler::writeTo(std::ostream& os) const
         catch_type = catchClass_->getIndex();
     }
 
-    internal::Utils::writeBigEndian(os, start_pc);
-    internal::Utils::writeBigEndian(os, end_pc);
-    internal::Utils::writeBigEndian(os, handler_pc);
-    internal::Utils::writeBigEndian(os, catch_type);
+    writer.writeBigEndian(start_pc);
+    writer.writeBigEndian(end_pc);
+    writer.writeBigEndian(handler_pc);
+    writer.writeBigEndian(catch_type);
 }
 
 std::size_t ExceptionHandler::getByteSize() const
@@ -1,7 +1,6 @@
 #include "jvm/field.h"
 
 #include <cassert>
-#include <ostream>
 #include <utility>
 
 #include "jvm/attribute.h"
@@ -64,7 +63,7 @@ const std::set<Attribute*>* Field::getAttributes() const
     return &attributes_;
 }
 
-void Field::writeTo(std::ostream& os) const
+void Field::writeTo(ByteWriter& writer) const
 {
     // u2             access_flags;
     uint16_t accessFlags = 0x0000;
@@ -72,30 +71,31 @@ void Field::writeTo(std::ostream& os) const
     {
         accessFlags = accessFlags | flag;
     }
-    internal::Utils::writeBigEndian(os, accessFlags);
+    writer.writeBigEndian(accessFlags);
 
     // u2             name_index;
     uint16_t nameIndex = name_->getIndex();
-    internal::Utils::writeBigEndian(os, nameIndex);
+    writer.writeBigEndian(nameIndex);
 
     // u2             descriptor_index;
     uint16_t descriptorIndex = descriptor_->getIndex();
-    internal::Utils::writeBigEndian(os, descriptorIndex);
+    writer.writeBigEndian(descriptorIndex);
 
     // u2             attributes_count;
     uint16_t attributeCount = attributes_.size();
-    internal::Utils::writeBigEndian(os, attributeCount);
+    writer.writeBigEndian(attributeCount);
 
     // attribute_info attributes[attributes_count];
     for (auto* attribute : attributes_)
     {
-        os << *attribute;
+        writer << *attribute;
     }
 }
 
 std::size_t Field::getByteSize() const
 {
-    size_t size = sizeof(AccessFlag) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint16_t);
+    // access_flags, name_index, descriptor_index, attributes_count
+    size_t size = 4 * sizeof(uint16_t);
     for (auto* attribute : attributes_)
     {
         size += attribute->getByteSize();
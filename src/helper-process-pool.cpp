@@ -0,0 +1,486 @@
+#include "jvm/helper-process-pool.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+#include "java-internal-paths.h"
+
+namespace fs = std::filesystem;
+using namespace jvm;
+
+namespace
+{
+    constexpr uint8_t statusOk = 0; ///< @c FixClass.STATUS_OK
+    constexpr uint8_t statusError = 1; ///< @c FixClass.STATUS_ERROR
+
+    /**
+     * @brief Path of the java executable in @c JAVA_HOME.
+     */
+    fs::path getJavaExecutable()
+    {
+        const char* javaHome = std::getenv("JAVA_HOME");
+        if (javaHome == nullptr)
+        {
+            throw std::runtime_error("JAVA_HOME not set");
+        }
+
+#ifdef _WIN32
+        return fs::path(javaHome) / "bin" / "java.exe";
+#else
+        return fs::path(javaHome) / "bin" / "java";
+#endif
+    }
+
+    /**
+     * @brief One @c FixClass process in serving mode, with its standard input and output connected to this process.
+     *
+     * Stopped on destruction: closing its input ends the serving loop, a broken process is killed.
+     */
+    class HelperProcess
+    {
+    public:
+        HelperProcess()
+        {
+            start(getJavaExecutable(), JAVA_INTERNAL_JAR);
+        }
+
+        ~HelperProcess()
+        {
+            stop();
+        }
+
+        HelperProcess(const HelperProcess&) = delete;
+        HelperProcess& operator=(const HelperProcess&) = delete;
+
+        /**
+         * @brief Send a class and receive the fixed one.
+         *
+         * @throws std::runtime_error If the process exited or broke the protocol, it is marked broken,
+         * or if @c FixClass failed to fix the class, the process stays usable.
+         */
+        std::vector<unsigned char> fix(std::span<const unsigned char> data)
+        {
+            std::array<unsigned char, 4> length{};
+            writeU4(length, static_cast<uint32_t>(data.size()));
+            writeExact(length);
+            writeExact(data);
+
+            std::array<unsigned char, 5> header{};
+            readExact(header);
+            auto payloadLength = readU4(std::span(header).subspan<1>());
+            if (payloadLength > static_cast<uint32_t>(std::numeric_limits<int32_t>::max()))
+            {
+                markBroken();
+                throw std::runtime_error("Helper process sent an invalid response");
+            }
+
+            std::vector<unsigned char> payload(payloadLength);
+            readExact(payload);
+            switch (header[0])
+            {
+            case statusOk:
+                return payload;
+            case statusError:
+                throw std::runtime_error("FixClass failed: " + std::string(payload.begin(), payload.end()));
+            default:
+                markBroken();
+                throw std::runtime_error("Helper process sent an invalid response");
+            }
+        }
+
+        [[nodiscard]] bool isBroken() const noexcept { return isBroken_; }
+
+    private:
+        static void writeU4(std::span<unsigned char, 4> bytes, uint32_t value)
+        {
+            bytes[0] = static_cast<unsigned char>(value >> 24);
+            bytes[1] = static_cast<unsigned char>(value >> 16);
+            bytes[2] = static_cast<unsigned char>(value >> 8);
+            bytes[3] = static_cast<unsigned char>(value);
+        }
+
+        static uint32_t readU4(std::span<const unsigned char, 4> bytes)
+        {
+            return static_cast<uint32_t>(bytes[0]) << 24 | static_cast<uint32_t>(bytes[1]) << 16 |
+                static_cast<uint32_t>(bytes[2]) << 8 | static_cast<uint32_t>(bytes[3]);
+        }
+
+        void markBroken() noexcept
+        {
+            isBroken_ = true;
+        }
+
+#ifdef _WIN32
+        void start(const fs::path& javaExecutable, const fs::path& jar)
+        {
+            // handles of the child ends are inherited, so processes are created one at a time:
+            // a process created concurrently would inherit them too and keep the pipes open
+            static std::mutex creationMutex;
+
+            SECURITY_ATTRIBUTES attributes{};
+            attributes.nLength = sizeof(attributes);
+            attributes.bInheritHandle = TRUE;
+
+            HANDLE childInput = nullptr;
+            HANDLE childOutput = nullptr;
+            std::lock_guard lock(creationMutex);
+            if (!CreatePipe(&childInput, &input_, &attributes, 0))
+            {
+                throw std::runtime_error("Failed to create helper process pipe");
+            }
+            if (!CreatePipe(&output_, &childOutput, &attributes, 0))
+            {
+                CloseHandle(childInput);
+                CloseHandle(input_);
+                throw std::runtime_error("Failed to create helper process pipe");
+            }
+            SetHandleInformation(input_, HANDLE_FLAG_INHERIT, 0);
+            SetHandleInformation(output_, HANDLE_FLAG_INHERIT, 0);
+
+            STARTUPINFOW startupInfo{};
+            startupInfo.cb = sizeof(startupInfo);
+            startupInfo.dwFlags = STARTF_USESTDHANDLES;
+            startupInfo.hStdInput = childInput;
+            startupInfo.hStdOutput = childOutput;
+            startupInfo.hStdError = GetStdHandle(STD_ERROR_HANDLE);
+
+            std::wstring commandLine =
+                L"\"" + javaExecutable.wstring() + L"\" -jar \"" + jar.wstring() + L"\" --serve";
+
+            PROCESS_INFORMATION processInfo{};
+            BOOL isCreated = CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, TRUE,
+                                            CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo);
+            CloseHandle(childInput);
+            CloseHandle(childOutput);
+            if (!isCreated)
+            {
+                CloseHandle(input_);
+                CloseHandle(output_);
+                throw std::runtime_error("Failed to start helper process");
+            }
+            CloseHandle(processInfo.hThread);
+            process_ = processInfo.hProcess;
+        }
+
+        void stop() noexcept
+        {
+            CloseHandle(input_);
+            if (isBroken_)
+            {
+                TerminateProcess(process_, 1);
+            }
+            WaitForSingleObject(process_, INFINITE);
+            CloseHandle(output_);
+            CloseHandle(process_);
+        }
+
+        void writeExact(std::span<const unsigned char> data)
+        {
+            while (!data.empty())
+            {
+                DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(data.size(), UINT32_MAX));
+                DWORD written = 0;
+                if (!WriteFile(input_, data.data(), chunk, &written, nullptr))
+                {
+                    markBroken();
+                    throw std::runtime_error("Helper process exited unexpectedly");
+                }
+                data = data.subspan(written);
+            }
+        }
+
+        void readExact(std::span<unsigned char> data)
+        {
+            while (!data.empty())
+            {
+                DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(data.size(), UINT32_MAX));
+                DWORD read = 0;
+                if (!ReadFile(output_, data.data(), chunk, &read, nullptr) || read == 0)
+                {
+                    markBroken();
+                    throw std::runtime_error("Helper process exited unexpectedly");
+                }
+                data = data.subspan(read);
+            }
+        }
+
+        HANDLE process_ = nullptr;
+        HANDLE input_ = nullptr; ///< Write end of the process standard input.
+        HANDLE output_ = nullptr; ///< Read end of the process standard output.
+#else
+        void start(const fs::path& javaExecutable, const fs::path& jar)
+        {
+            // a socket instead of pipes: writes to an exited process fail instead of raising SIGPIPE
+            std::array<int, 2> sockets{};
+#ifdef SOCK_CLOEXEC
+            if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets.data()) != 0)
+            {
+                throw std::runtime_error("Failed to create helper process socket");
+            }
+#else
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets.data()) != 0)
+            {
+                throw std::runtime_error("Failed to create helper process socket");
+            }
+            fcntl(sockets[0], F_SETFD, FD_CLOEXEC);
+            fcntl(sockets[1], F_SETFD, FD_CLOEXEC);
+#endif
+#ifdef SO_NOSIGPIPE
+            int noSigPipe = 1;
+            setsockopt(sockets[0], SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+            // the child end becomes standard input and output, the original descriptors are closed on exec
+            posix_spawn_file_actions_t actions;
+            posix_spawn_file_actions_init(&actions);
+            posix_spawn_file_actions_adddup2(&actions, sockets[1], STDIN_FILENO);
+            posix_spawn_file_actions_adddup2(&actions, sockets[1], STDOUT_FILENO);
+
+            std::string executable = javaExecutable.string();
+            std::string jarPath = jar.string();
+            std::array<char*, 5> arguments = {
+                executable.data(), const_cast<char*>("-jar"), jarPath.data(), const_cast<char*>("--serve"), nullptr
+            };
+
+            int result = posix_spawn(&process_, executable.c_str(), &actions, nullptr, arguments.data(), environ);
+            posix_spawn_file_actions_destroy(&actions);
+            close(sockets[1]);
+            if (result != 0)
+            {
+                close(sockets[0]);
+                throw std::runtime_error("Failed to start helper process: " + executable);
+            }
+            socket_ = sockets[0];
+        }
+
+        void stop() noexcept
+        {
+            close(socket_);
+            if (isBroken_)
+            {
+                kill(process_, SIGKILL);
+            }
+            while (waitpid(process_, nullptr, 0) == -1 && errno == EINTR)
+            {
+            }
+        }
+
+        void writeExact(std::span<const unsigned char> data)
+        {
+#ifdef MSG_NOSIGNAL
+            constexpr int flags = MSG_NOSIGNAL;
+#else
+            constexpr int flags = 0;
+#endif
+            while (!data.empty())
+            {
+                ssize_t written = send(socket_, data.data(), data.size(), flags);
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    markBroken();
+                    throw std::runtime_error("Helper process exited unexpectedly");
+                }
+                data = data.subspan(static_cast<std::size_t>(written));
+            }
+        }
+
+        void readExact(std::span<unsigned char> data)
+        {
+            while (!data.empty())
+            {
+                ssize_t read = recv(socket_, data.data(), data.size(), 0);
+                if (read < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (read <= 0)
+                {
+                    markBroken();
+                    throw std::runtime_error("Helper process exited unexpectedly");
+                }
+                data = data.subspan(static_cast<std::size_t>(read));
+            }
+        }
+
+        pid_t process_ = 0;
+        int socket_ = -1; ///< Connected to the process standard input and output.
+#endif
+
+        bool isBroken_ = false; ///< Process exited or broke the protocol.
+    };
+
+    /**
+     * @brief State of the process-wide pool.
+     *
+     * @c processCount counts idle, busy and starting processes, so the limit holds while processes start
+     * without @c mutex held.
+     */
+    struct PoolState
+    {
+        std::mutex mutex{};
+        std::condition_variable released{};
+        std::vector<std::unique_ptr<HelperProcess>> idle{};
+        std::size_t processCount = 0;
+        std::size_t maxProcesses = std::max(1U, std::thread::hardware_concurrency());
+    };
+
+    PoolState& getState()
+    {
+        static PoolState state;
+        return state;
+    }
+
+    /**
+     * @brief Exclusive use of one helper process, returned to the pool when leaving the scope.
+     */
+    class Lease
+    {
+    public:
+        /**
+         * @brief Take an idle process, start a new one below the limit, or wait for one to be released.
+         */
+        explicit Lease(PoolState& state) : state_(state)
+        {
+            std::unique_lock lock(state_.mutex);
+            state_.released.wait(lock, [this]
+            {
+                return !state_.idle.empty() || state_.processCount < state_.maxProcesses;
+            });
+
+            if (!state_.idle.empty())
+            {
+                process_ = std::move(state_.idle.back());
+                state_.idle.pop_back();
+                return;
+            }
+
+            // start outside the lock, it takes a while
+            ++state_.processCount;
+            lock.unlock();
+            try
+            {
+                process_ = std::make_unique<HelperProcess>();
+            }
+            catch (...)
+            {
+                lock.lock();
+                --state_.processCount;
+                state_.released.notify_one();
+                throw;
+            }
+        }
+
+        ~Lease()
+        {
+            std::unique_ptr<HelperProcess> stopped;
+            {
+                std::lock_guard lock(state_.mutex);
+                if (process_->isBroken() || state_.processCount > state_.maxProcesses)
+                {
+                    --state_.processCount;
+                    stopped = std::move(process_);
+                }
+                else
+                {
+                    state_.idle.push_back(std::move(process_));
+                }
+            }
+            state_.released.notify_one();
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        HelperProcess& operator*() const noexcept { return *process_; }
+        HelperProcess* operator->() const noexcept { return process_.get(); }
+
+    private:
+        PoolState& state_;
+        std::unique_ptr<HelperProcess> process_;
+    };
+}
+
+std::vector<unsigned char> HelperProcessPool::fix(std::span<const unsigned char> data)
+{
+    if (data.size() > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+    {
+        throw std::invalid_argument("Class is too large for the helper process");
+    }
+
+    Lease process(getState());
+    return process->fix(data);
+}
+
+void HelperProcessPool::setMaxProcesses(std::size_t count)
+{
+    if (count == 0)
+    {
+        throw std::invalid_argument("Helper process pool needs at least one process");
+    }
+
+    auto& state = getState();
+    std::vector<std::unique_ptr<HelperProcess>> stopped;
+    {
+        std::lock_guard lock(state.mutex);
+        state.maxProcesses = count;
+        while (state.processCount > count && !state.idle.empty())
+        {
+            stopped.push_back(std::move(state.idle.back()));
+            state.idle.pop_back();
+            --state.processCount;
+        }
+    }
+    state.released.notify_all();
+}
+
+std::size_t HelperProcessPool::getMaxProcesses()
+{
+    auto& state = getState();
+    std::lock_guard lock(state.mutex);
+    return state.maxProcesses;
+}
+
+void HelperProcessPool::shutdown()
+{
+    auto& state = getState();
+    std::vector<std::unique_ptr<HelperProcess>> stopped;
+    {
+        std::lock_guard lock(state.mutex);
+        stopped = std::move(state.idle);
+        state.idle.clear();
+        state.processCount -= stopped.size();
+    }
+    state.released.notify_all();
+}
@@ -1,10 +1,10 @@
 #include "jvm/instruction-jump.h"
 
 #include <cassert>
-#include <ostream>
+#include <stdexcept>
 
 #include "jvm/attribute-code.h"
-#include "jvm/internal/utils.h"
+#include "jvm/internal/bytecode.h"
 
 using namespace jvm;
 
@@ -14,28 +14,67 @@ Label* InstructionJump::getJumpLabel() const
 }
 
 InstructionJump::InstructionJump(AttributeCode* attributeCode, Command command, Label* label) :
-    Instruction(attributeCode, command), label_(label)
+    Instruction(attributeCode, command, OPERAND_jump, shortSize), label_(label)
 {
     assert(label_ != nullptr);
 }
 
 
-void InstructionJump::writeTo(std::ostream& os) const
+void InstructionJump::writeTo(ByteWriter& writer) const
 {
     assert(label_ != nullptr);
 
-    Instruction::writeTo(os);
-
     Instruction* toTarget = label_->getInstruction();
     if (!toTarget)
     {
         throw std::logic_error("Jump label is not bound to any instruction.");
     }
 
-    internal::Utils::writeBigEndian(os, static_cast<uint16_t>(calculateShift(toTarget)));
+    int32_t shift = calculateShift(toTarget);
+    switch (byteSize_)
+    {
+    case shortSize:
+        Instruction::writeTo(writer);
+        writer.writeBigEndian(static_cast<uint16_t>(shift));
+        break;
+    case wideSize:
+        Instruction::writeTo(writer);
+        writer.writeBigEndian(static_cast<uint32_t>(shift));
+        break;
+    default:
+        // inverted jump over the goto_w, which is 3 bytes further from the target
+        writer.writeBigEndian(static_cast<uint8_t>(internal::Bytecode::getInvertedJump(getCommandCode())));
+        writer.writeBigEndian(static_cast<uint16_t>(wideConditionalSize));
+        writer.writeBigEndian(static_cast<uint8_t>(INSTRUCTION_goto_w));
+        writer.writeBigEndian(static_cast<uint32_t>(shift - shortSize));
+        break;
+    }
+}
+
+void InstructionJump::widen()
+{
+    switch (getCommandCode())
+    {
+    case INSTRUCTION_goto:
+        setCommand(INSTRUCTION_goto_w);
+        byteSize_ = wideSize;
+        break;
+    case INSTRUCTION_jsr:
+        setCommand(INSTRUCTION_jsr_w);
+        byteSize_ = wideSize;
+        break;
+    case INSTRUCTION_goto_w:
+    case INSTRUCTION_jsr_w:
+        break;
+    default:
+        // keep the condition, only its inversion is written; throws if it has none
+        static_cast<void>(internal::Bytecode::getInvertedJump(getCommandCode()));
+        byteSize_ = wideConditionalSize;
+        break;
+    }
 }
 
-size_t InstructionJump::getByteSize() const
+void InstructionJump::invert()
 {
-    return Instruction::getByteSize() + 2;
+    setCommand(internal::Bytecode::getInvertedJump(getCommandCode()));
 }
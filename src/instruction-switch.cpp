@@ -0,0 +1,98 @@
+#include "jvm/instruction-switch.h"
+
+#include <cassert>
+#include <stdexcept>
+
+#include "jvm/attribute-code.h"
+
+using namespace jvm;
+
+int32_t InstructionSwitch::getKey(std::size_t caseIndex) const
+{
+    if (caseIndex >= labels_.size())
+    {
+        throw std::out_of_range("Switch case index out of range.");
+    }
+    if (getCommandCode() == INSTRUCTION_tableswitch)
+    {
+        return static_cast<int32_t>(static_cast<int64_t>(low_) + static_cast<int64_t>(caseIndex));
+    }
+    return keys_[caseIndex];
+}
+
+InstructionSwitch::InstructionSwitch(AttributeCode* attributeCode, Label* defaultLabel, int32_t low,
+                                     std::pmr::vector<Label*> labels) :
+    Instruction(attributeCode, INSTRUCTION_tableswitch, OPERAND_switch,
+                static_cast<uint16_t>(getUnpaddedSize(INSTRUCTION_tableswitch, labels.size()) + maxPadding)),
+    defaultLabel_(defaultLabel), low_(low), keys_(labels.get_allocator()), labels_(std::move(labels))
+{
+    assert(defaultLabel_ != nullptr);
+}
+
+InstructionSwitch::InstructionSwitch(AttributeCode* attributeCode, Label* defaultLabel, std::pmr::vector<int32_t> keys,
+                                     std::pmr::vector<Label*> labels) :
+    Instruction(attributeCode, INSTRUCTION_lookupswitch, OPERAND_switch,
+                static_cast<uint16_t>(getUnpaddedSize(INSTRUCTION_lookupswitch, labels.size()) + maxPadding)),
+    defaultLabel_(defaultLabel), keys_(std::move(keys)), labels_(std::move(labels))
+{
+    assert(defaultLabel_ != nullptr);
+    assert(keys_.size() == labels_.size());
+}
+
+uint32_t InstructionSwitch::getUnpaddedSize(Command command, std::size_t caseCount) noexcept
+{
+    if (command == INSTRUCTION_tableswitch)
+    {
+        return tableFixedSize + 4 * static_cast<uint32_t>(caseCount);
+    }
+    return lookupFixedSize + 8 * static_cast<uint32_t>(caseCount);
+}
+
+void InstructionSwitch::updatePadding()
+{
+    byteSize_ = static_cast<uint16_t>(getUnpaddedSize(getCommandCode(), labels_.size()) + getPadding());
+}
+
+uint32_t InstructionSwitch::getPadding() const
+{
+    // operands start at a multiple of 4 from the start of the code
+    return (4 - (getIndex() + 1u) % 4) % 4;
+}
+
+void InstructionSwitch::writeTo(ByteWriter& writer) const
+{
+    auto writeShift = [this, &writer](Label* label)
+    {
+        Instruction* target = label->getInstruction();
+        if (!target)
+        {
+            throw std::logic_error("Switch label is not bound to any instruction.");
+        }
+        writer.writeBigEndian(static_cast<uint32_t>(calculateShift(target)));
+    };
+
+    Instruction::writeTo(writer);
+    for (uint32_t i = 0; i < getPadding(); ++i)
+    {
+        writer.writeBigEndian(static_cast<uint8_t>(0));
+    }
+    writeShift(defaultLabel_);
+
+    if (getCommandCode() == INSTRUCTION_tableswitch)
+    {
+        writer.writeBigEndian(static_cast<uint32_t>(low_));
+        writer.writeBigEndian(static_cast<uint32_t>(getKey(labels_.size() - 1)));
+        for (auto* label : labels_)
+        {
+            writeShift(label);
+        }
+        return;
+    }
+
+    writer.writeBigEndian(static_cast<uint32_t>(labels_.size()));
+    for (std::size_t i = 0; i < labels_.size(); ++i)
+    {
+        writer.writeBigEndian(static_cast<uint32_t>(keys_[i]));
+        writeShift(labels_[i]);
+    }
+}
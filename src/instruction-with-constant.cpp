@@ -1,8 +1,6 @@
 #include "jvm/instruction-with-constant.h"
 
-#include <ostream>
-
-#include "jvm/internal/utils.h"
+#include <stdexcept>
 
 using namespace jvm;
 
@@ -15,17 +13,22 @@ InstructionWithConstant::InstructionWithConstant(AttributeCode* attributeCode,
                                                  Command command,
                                                  Constant* constant,
                                                  AvailableReferenceSize size) :
-    Instruction(attributeCode, command), constant_(constant), size_(size)
+    Instruction(attributeCode, command, OPERAND_constant, 1 + size), constant_(constant), size_(size)
 {
 }
 
 void InstructionWithConstant::setAvailableReferenceSize(AvailableReferenceSize size)
 {
+    byteSize_ = static_cast<uint16_t>(byteSize_ - size_ + size);
     size_ = size;
 }
 
 void InstructionWithConstant::setTrailingByte(uint8_t trailingByte)
 {
+    if (!hasTrailingByte_)
+    {
+        byteSize_ += sizeof(trailingByte_);
+    }
     trailingByte_ = trailingByte;
     hasTrailingByte_ = true;
 }
@@ -34,9 +37,9 @@ void InstructionWithConstant::update()
 {
 }
 
-void InstructionWithConstant::writeTo(std::ostream& os) const
+void InstructionWithConstant::writeTo(ByteWriter& writer) const
 {
-    Instruction::writeTo(os);
+    Instruction::writeTo(writer);
 
     uint16_t index = constant_->getIndex();
     if (size_ == OneByte)
@@ -45,20 +48,15 @@ void InstructionWithConstant::writeTo(std::ostream& os) const
         {
             throw std::out_of_range("Constant index bigger then available reference size.");
         }
-        internal::Utils::writeBigEndian(os, static_cast<uint8_t>(index));
+        writer.writeBigEndian(static_cast<uint8_t>(index));
     }
     else
     {
-        internal::Utils::writeBigEndian(os, index);
+        writer.writeBigEndian(index);
     }
 
     if (hasTrailingByte_)
     {
-        internal::Utils::writeBigEndian(os, trailingByte_);
+        writer.writeBigEndian(trailingByte_);
     }
 }
-
-size_t InstructionWithConstant::getByteSize() const
-{
-    return Instruction::getByteSize() + size_ + (hasTrailingByte_ ? sizeof(trailingByte_) : 0);
-}
@@ -1,20 +1,9 @@
 #include "jvm/instruction.h"
 
-#include <ostream>
+#include <stdexcept>
 
 using namespace jvm;
 
-Instruction::Command Instruction::getCommandCode() const
-{
-    return command_;
-}
-
-void Instruction::setIndex(uint16_t index)
-{
-    index_ = index;
-    isIndexSet_ = true;
-}
-
 void Instruction::resetIndex()
 {
     isIndexSet_ = false;
@@ -25,35 +14,46 @@ Instruction::Instruction(AttributeCode* attributeCode, Command command) :
 {
 }
 
+Instruction::Instruction(AttributeCode* attributeCode, Command command, OperandKind operandKind, uint16_t byteSize) :
+    ClassFileElement(attributeCode), byteSize_(byteSize), command_(command), operandKind_(operandKind)
+{
+}
+
 void Instruction::setCommand(Command newCommand)
 {
     command_ = newCommand;
 }
 
-uint16_t Instruction::calculateShift(Instruction* target) const
+int32_t Instruction::calculateShift(Instruction* target) const
 {
     if (!isIndexSet()) { throw std::logic_error("Index for source instruction not set yet."); }
     if (!target->isIndexSet()) { throw std::logic_error("Index for target instruction not set yet."); }
 
-    uint16_t from = getIndex();
-    uint16_t to = target->getIndex();
+    int32_t from = getIndex();
+    int32_t to = target->getIndex();
 
     return to - from;
 }
 
 size_t Instruction::getByteSize() const
 {
-    return sizeof(command_);
+    return byteSize_;
 }
 
-void Instruction::writeTo(std::ostream& os) const
+void Instruction::writeTo(ByteWriter& writer) const
 {
-    const auto byte = static_cast<char>(command_);
-    os.put(byte);
+    if (operandKind_ == OPERAND_wide)
+    {
+        writer.writeBigEndian(static_cast<uint8_t>(INSTRUCTION_wide));
+        writer.writeBigEndian(static_cast<uint8_t>(command_));
+        writer.writeBytes(immediates_.data(), byteSize_ - 2);
+        return;
+    }
 
-    if (!os)
+    writer.writeBigEndian(static_cast<uint8_t>(command_));
+    if (operandKind_ == OPERAND_value)
     {
-        throw std::runtime_error("Failed to write instruction opcode to stream");
+        writer.writeBytes(immediates_.data(), byteSize_ - 1);
     }
 }
 
@@ -0,0 +1,348 @@
+#include "jvm/internal/bytecode.h"
+
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace jvm::internal
+{
+    namespace
+    {
+        constexpr int8_t V = Bytecode::variableStackDelta;
+
+        /// Stack size change of every opcode up to @c breakpoint, see JVMS §6.5.
+        constexpr std::array<int8_t, Instruction::INSTRUCTION_breakpoint + 1> stackDeltas = {
+            // nop, aconst_null, iconst_m1..iconst_5
+            0, 1, 1, 1, 1, 1, 1, 1, 1,
+            // lconst_0, lconst_1, fconst_0..fconst_2, dconst_0, dconst_1
+            2, 2, 1, 1, 1, 2, 2,
+            // bipush, sipush, ldc, ldc_w, ldc2_w
+            1, 1, 1, 1, 2,
+            // iload, lload, fload, dload, aload
+            1, 2, 1, 2, 1,
+            // iload_n, lload_n, fload_n, dload_n, aload_n
+            1, 1, 1, 1, 2, 2, 2, 2, 1, 1, 1, 1, 2, 2, 2, 2, 1, 1, 1, 1,
+            // iaload, laload, faload, daload, aaload, baload, caload, saload
+            -1, 0, -1, 0, -1, -1, -1, -1,
+            // istore, lstore, fstore, dstore, astore
+            -1, -2, -1, -2, -1,
+            // istore_n, lstore_n, fstore_n, dstore_n, astore_n
+            -1, -1, -1, -1, -2, -2, -2, -2, -1, -1, -1, -1, -2, -2, -2, -2, -1, -1, -1, -1,
+            // iastore, lastore, fastore, dastore, aastore, bastore, castore, sastore
+            -3, -4, -3, -4, -3, -3, -3, -3,
+            // pop, pop2, dup, dup_x1, dup_x2, dup2, dup2_x1, dup2_x2, swap
+            -1, -2, 1, 1, 1, 2, 2, 2, 0,
+            // add, sub, mul, div, rem (int, long, float, double)
+            -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2, -1, -2,
+            // ineg, lneg, fneg, dneg
+            0, 0, 0, 0,
+            // ishl, lshl, ishr, lshr, iushr, lushr
+            -1, -1, -1, -1, -1, -1,
+            // iand, land, ior, lor, ixor, lxor
+            -1, -2, -1, -2, -1, -2,
+            // iinc
+            0,
+            // i2l, i2f, i2d, l2i, l2f, l2d, f2i, f2l, f2d, d2i, d2l, d2f, i2b, i2c, i2s
+            1, 0, 1, -1, -1, 0, 0, 1, 1, -1, 0, -1, 0, 0, 0,
+            // lcmp, fcmpl, fcmpg, dcmpl, dcmpg
+            -3, -1, -1, -3, -3,
+            // ifeq, ifne, iflt, ifge, ifgt, ifle
+            -1, -1, -1, -1, -1, -1,
+            // if_icmpeq, if_icmpne, if_icmplt, if_icmpge, if_icmpgt, if_icmple, if_acmpeq, if_acmpne
+            -2, -2, -2, -2, -2, -2, -2, -2,
+            // goto, jsr, ret, tableswitch, lookupswitch
+            0, 1, 0, -1, -1,
+            // ireturn, lreturn, freturn, dreturn, areturn, return
+            -1, -2, -1, -2, -1, 0,
+            // getstatic, putstatic, getfield, putfield
+            V, V, V, V,
+            // invokevirtual, invokespecial, invokestatic, invokeinterface, invokedynamic
+            V, V, V, V, V,
+            // new, newarray, anewarray, arraylength, athrow, checkcast, instanceof, monitorenter, monitorexit
+            1, 0, 0, 0, -1, 0, 0, -1, -1,
+            // wide, multianewarray, ifnull, ifnonnull, goto_w, jsr_w, breakpoint
+            V, V, -1, -1, 0, 1, 0,
+        };
+        static_assert(stackDeltas[Instruction::INSTRUCTION_iinc] == 0);
+        static_assert(stackDeltas[Instruction::INSTRUCTION_goto] == 0);
+        static_assert(stackDeltas[Instruction::INSTRUCTION_getstatic] == V);
+        static_assert(stackDeltas[Instruction::INSTRUCTION_jsr_w] == 1);
+
+        /**
+         * @brief Skip one field type in a descriptor.
+         * @return Position after the field type.
+         */
+        std::size_t skipFieldType(std::string_view descriptor, std::size_t position)
+        {
+            while (position < descriptor.size() && descriptor[position] == '[')
+            {
+                ++position;
+            }
+            if (position >= descriptor.size())
+            {
+                throw std::invalid_argument("Malformed descriptor: " + std::string(descriptor));
+            }
+            if (descriptor[position] == 'L')
+            {
+                position = descriptor.find(';', position);
+                if (position == std::string_view::npos)
+                {
+                    throw std::invalid_argument("Malformed descriptor: " + std::string(descriptor));
+                }
+            }
+            return position + 1;
+        }
+
+        /**
+         * @return Position of the closing parenthesis of a method descriptor.
+         */
+        std::size_t findArgumentsEnd(std::string_view methodDescriptor)
+        {
+            auto end = methodDescriptor.find(')');
+            if (methodDescriptor.empty() || methodDescriptor.front() != '(' || end == std::string_view::npos)
+            {
+                throw std::invalid_argument("Malformed method descriptor: " + std::string(methodDescriptor));
+            }
+            return end;
+        }
+    }
+
+    int8_t Bytecode::getStackDelta(Instruction::Command command)
+    {
+        if (command >= stackDeltas.size())
+        {
+            throw std::invalid_argument("Unknown instruction.");
+        }
+        return stackDeltas[command];
+    }
+
+    int32_t Bytecode::getMemberStackDelta(Instruction::Command command, std::string_view descriptor)
+    {
+        switch (command)
+        {
+        case Instruction::INSTRUCTION_getstatic:
+            return getSlots(descriptor);
+        case Instruction::INSTRUCTION_putstatic:
+            return -getSlots(descriptor);
+        case Instruction::INSTRUCTION_getfield:
+            return getSlots(descriptor) - 1;
+        case Instruction::INSTRUCTION_putfield:
+            return -getSlots(descriptor) - 1;
+        case Instruction::INSTRUCTION_invokestatic:
+        case Instruction::INSTRUCTION_invokedynamic:
+            return getReturnSlots(descriptor) - getArgumentSlots(descriptor);
+        case Instruction::INSTRUCTION_invokevirtual:
+        case Instruction::INSTRUCTION_invokespecial:
+        case Instruction::INSTRUCTION_invokeinterface:
+            return getReturnSlots(descriptor) - getArgumentSlots(descriptor) - 1;
+        default:
+            throw std::invalid_argument("Instruction doesn't access a class member.");
+        }
+    }
+
+    int8_t Bytecode::getOperandSize(Instruction::Command command)
+    {
+        switch (command)
+        {
+        case Instruction::INSTRUCTION_bipush:
+        case Instruction::INSTRUCTION_ldc:
+        case Instruction::INSTRUCTION_iload:
+        case Instruction::INSTRUCTION_lload:
+        case Instruction::INSTRUCTION_fload:
+        case Instruction::INSTRUCTION_dload:
+        case Instruction::INSTRUCTION_aload:
+        case Instruction::INSTRUCTION_istore:
+        case Instruction::INSTRUCTION_lstore:
+        case Instruction::INSTRUCTION_fstore:
+        case Instruction::INSTRUCTION_dstore:
+        case Instruction::INSTRUCTION_astore:
+        case Instruction::INSTRUCTION_ret:
+        case Instruction::INSTRUCTION_newarray:
+            return 1;
+        case Instruction::INSTRUCTION_sipush:
+        case Instruction::INSTRUCTION_ldc_w:
+        case Instruction::INSTRUCTION_ldc2_w:
+        case Instruction::INSTRUCTION_iinc:
+        case Instruction::INSTRUCTION_getstatic:
+        case Instruction::INSTRUCTION_putstatic:
+        case Instruction::INSTRUCTION_getfield:
+        case Instruction::INSTRUCTION_putfield:
+        case Instruction::INSTRUCTION_invokevirtual:
+        case Instruction::INSTRUCTION_invokespecial:
+        case Instruction::INSTRUCTION_invokestatic:
+        case Instruction::INSTRUCTION_new:
+        case Instruction::INSTRUCTION_anewarray:
+        case Instruction::INSTRUCTION_checkcast:
+        case Instruction::INSTRUCTION_instanceof:
+            return 2;
+        case Instruction::INSTRUCTION_multianewarray:
+            return 3;
+        case Instruction::INSTRUCTION_invokeinterface:
+        case Instruction::INSTRUCTION_invokedynamic:
+        case Instruction::INSTRUCTION_goto_w:
+        case Instruction::INSTRUCTION_jsr_w:
+            return 4;
+        case Instruction::INSTRUCTION_tableswitch:
+        case Instruction::INSTRUCTION_lookupswitch:
+        case Instruction::INSTRUCTION_wide:
+            return variableOperandSize;
+        default:
+            break;
+        }
+
+        if ((Instruction::INSTRUCTION_ifeq <= command && command <= Instruction::INSTRUCTION_jsr)
+            || command == Instruction::INSTRUCTION_ifnull || command == Instruction::INSTRUCTION_ifnonnull)
+        {
+            return 2;
+        }
+        if (command > Instruction::INSTRUCTION_breakpoint)
+        {
+            throw std::invalid_argument("Unknown instruction.");
+        }
+        return 0;
+    }
+
+    uint8_t Bytecode::getLocalSlots(Instruction::Command command)
+    {
+        switch (command)
+        {
+        case Instruction::INSTRUCTION_lload:
+        case Instruction::INSTRUCTION_dload:
+        case Instruction::INSTRUCTION_lstore:
+        case Instruction::INSTRUCTION_dstore:
+            return 2;
+        case Instruction::INSTRUCTION_iload:
+        case Instruction::INSTRUCTION_fload:
+        case Instruction::INSTRUCTION_aload:
+        case Instruction::INSTRUCTION_istore:
+        case Instruction::INSTRUCTION_fstore:
+        case Instruction::INSTRUCTION_astore:
+        case Instruction::INSTRUCTION_iinc:
+        case Instruction::INSTRUCTION_ret:
+            return 1;
+        default:
+            break;
+        }
+
+        if (Instruction::INSTRUCTION_iload_0 <= command && command <= Instruction::INSTRUCTION_aload_3)
+        {
+            auto kind = (command - Instruction::INSTRUCTION_iload_0) / 4; // i, l, f, d, a
+            return kind == 1 || kind == 3 ? 2 : 1;
+        }
+        if (Instruction::INSTRUCTION_istore_0 <= command && command <= Instruction::INSTRUCTION_astore_3)
+        {
+            auto kind = (command - Instruction::INSTRUCTION_istore_0) / 4; // i, l, f, d, a
+            return kind == 1 || kind == 3 ? 2 : 1;
+        }
+        return 0;
+    }
+
+    int8_t Bytecode::getImplicitLocalIndex(Instruction::Command command)
+    {
+        if (Instruction::INSTRUCTION_iload_0 <= command && command <= Instruction::INSTRUCTION_aload_3)
+        {
+            return static_cast<int8_t>((command - Instruction::INSTRUCTION_iload_0) % 4);
+        }
+        if (Instruction::INSTRUCTION_istore_0 <= command && command <= Instruction::INSTRUCTION_astore_3)
+        {
+            return static_cast<int8_t>((command - Instruction::INSTRUCTION_istore_0) % 4);
+        }
+        return -1;
+    }
+
+    bool Bytecode::isTerminal(Instruction::Command command)
+    {
+        switch (command)
+        {
+        case Instruction::INSTRUCTION_ireturn:
+        case Instruction::INSTRUCTION_lreturn:
+        case Instruction::INSTRUCTION_freturn:
+        case Instruction::INSTRUCTION_dreturn:
+        case Instruction::INSTRUCTION_areturn:
+        case Instruction::INSTRUCTION_return:
+        case Instruction::INSTRUCTION_athrow:
+        case Instruction::INSTRUCTION_goto:
+        case Instruction::INSTRUCTION_goto_w:
+        case Instruction::INSTRUCTION_ret:
+        case Instruction::INSTRUCTION_tableswitch:
+        case Instruction::INSTRUCTION_lookupswitch:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    Instruction::Command Bytecode::getInvertedJump(Instruction::Command command)
+    {
+        // conditions come in pairs of opposites: ifeq/ifne, iflt/ifge, ..., if_acmpeq/if_acmpne
+        if (Instruction::INSTRUCTION_ifeq <= command && command <= Instruction::INSTRUCTION_if_acmpne)
+        {
+            auto pairIndex = command - Instruction::INSTRUCTION_ifeq;
+            return static_cast<Instruction::Command>(Instruction::INSTRUCTION_ifeq + (pairIndex ^ 1));
+        }
+        if (command == Instruction::INSTRUCTION_ifnull)
+        {
+            return Instruction::INSTRUCTION_ifnonnull;
+        }
+        if (command == Instruction::INSTRUCTION_ifnonnull)
+        {
+            return Instruction::INSTRUCTION_ifnull;
+        }
+        throw std::invalid_argument("Instruction is not a conditional jump.");
+    }
+
+    uint8_t Bytecode::getSlots(std::string_view descriptor)
+    {
+        if (descriptor == "J" || descriptor == "D")
+        {
+            return 2;
+        }
+        if (descriptor == "V")
+        {
+            return 0;
+        }
+        return 1;
+    }
+
+    uint16_t Bytecode::getArgumentSlots(std::string_view methodDescriptor)
+    {
+        auto end = findArgumentsEnd(methodDescriptor);
+
+        uint16_t slots = 0;
+        std::size_t position = 1;
+        while (position < end)
+        {
+            auto next = skipFieldType(methodDescriptor, position);
+            slots += getSlots(methodDescriptor.substr(position, next - position));
+            position = next;
+        }
+        return slots;
+    }
+
+    uint8_t Bytecode::getReturnSlots(std::string_view methodDescriptor)
+    {
+        auto end = findArgumentsEnd(methodDescriptor);
+        return getSlots(methodDescriptor.substr(end + 1));
+    }
+
+    std::vector<std::string_view> Bytecode::getArgumentTypes(std::string_view methodDescriptor)
+    {
+        auto end = findArgumentsEnd(methodDescriptor);
+
+        std::vector<std::string_view> types;
+        std::size_t position = 1;
+        while (position < end)
+        {
+            auto next = skipFieldType(methodDescriptor, position);
+            types.push_back(methodDescriptor.substr(position, next - position));
+            position = next;
+        }
+        return types;
+    }
+
+    std::string_view Bytecode::getReturnType(std::string_view methodDescriptor)
+    {
+        auto end = findArgumentsEnd(methodDescriptor);
+        return methodDescriptor.substr(end + 1);
+    }
+} // jvm::internal
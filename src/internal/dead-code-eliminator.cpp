@@ -0,0 +1,92 @@
+#include "jvm/internal/dead-code-eliminator.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "jvm/attribute-code.h"
+#include "jvm/control-flow-graph.h"
+#include "jvm/exception-handler.h"
+
+namespace jvm::internal
+{
+    DeadCodeEliminator::DeadCodeEliminator(AttributeCode& code) : code_(code)
+    {
+    }
+
+    std::size_t DeadCodeEliminator::run()
+    {
+        std::size_t size = code_.getUnlaidSize();
+        ControlFlowGraph graph(code_);
+        if (graph.getReversePostorder().size() == graph.getBlocks().size())
+        {
+            return 0;
+        }
+
+        std::vector<Instruction*> code;
+        code.reserve(code_.code_.size());
+        std::vector<Instruction*> removed;
+        std::unordered_map<const Instruction*, Instruction*> moved;
+        std::size_t pendingStart = 0; // first removed instruction without a next kept one
+
+        auto blocks = graph.getBlocks();
+        for (uint32_t block = 0; block < blocks.size(); ++block)
+        {
+            bool isReachable = graph.isReachable(block);
+            for (uint32_t position = blocks[block].start; position < blocks[block].end; ++position)
+            {
+                Instruction* instruction = code_.code_[position];
+                if (!isReachable)
+                {
+                    removed.push_back(instruction);
+                    continue;
+                }
+                for (; pendingStart < removed.size(); ++pendingStart)
+                {
+                    moved.emplace(removed[pendingStart], instruction);
+                }
+                code.push_back(instruction);
+            }
+        }
+
+        // labels bound to unreachable code at the end have no next instruction: they are unbound,
+        // unless an exception range of reachable code ends there
+        if (pendingStart < removed.size())
+        {
+            std::unordered_set<const Instruction*> tail(removed.begin() + pendingStart, removed.end());
+            bool isRangeEnd = false;
+            for (const auto* handler : code_.exceptionHandlers_)
+            {
+                isRangeEnd = isRangeEnd || (tail.contains(handler->getTryFinishLabel()->getInstruction())
+                                            && !tail.contains(handler->getTryStartLabel()->getInstruction()));
+            }
+            Instruction* replacement = nullptr;
+            if (isRangeEnd)
+            {
+                replacement = code_.Throw();
+                code.push_back(replacement);
+            }
+            for (std::size_t i = pendingStart; i < removed.size(); ++i)
+            {
+                moved.emplace(removed[i], replacement);
+            }
+        }
+
+        for (auto* label : code_.allRegisteredLabels_)
+        {
+            auto target = moved.find(label->instruction_);
+            if (target != moved.end())
+            {
+                label->instruction_ = target->second;
+            }
+        }
+        for (auto* instruction : removed)
+        {
+            std::destroy_at(instruction);
+        }
+        code_.code_ = std::move(code);
+        code_.removeEmptyExceptionHandlers();
+        return size - code_.getUnlaidSize();
+    }
+} // jvm::internal
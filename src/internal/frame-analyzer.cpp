@@ -0,0 +1,902 @@
+#include "jvm/internal/frame-analyzer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include "jvm/attribute-code.h"
+#include "jvm/class.h"
+#include "jvm/class-hierarchy.h"
+#include "jvm/constant-class.h"
+#include "jvm/constant-fieldref.h"
+#include "jvm/constant-interface-methodref.h"
+#include "jvm/constant-methodref.h"
+#include "jvm/constant-name-and-type.h"
+#include "jvm/constant-utf-8-info.h"
+#include "jvm/instruction-jump.h"
+#include "jvm/instruction-switch.h"
+#include "jvm/instruction-value.h"
+#include "jvm/instruction-with-constant.h"
+#include "jvm/method.h"
+#include "jvm/internal/bytecode.h"
+
+namespace jvm::internal
+{
+    namespace
+    {
+        using Type = FrameAnalyzer::Type;
+        using Frame = FrameAnalyzer::Frame;
+
+        const std::string objectClassName = "java/lang/Object";
+        const std::string throwableClassName = "java/lang/Throwable";
+
+        bool isCategory2(const Type& type)
+        {
+            return type.kind == Type::Long || type.kind == Type::Double;
+        }
+
+        bool isReference(const Type& type)
+        {
+            return type.kind == Type::Object || type.kind == Type::Null;
+        }
+
+        Type makeObject(std::string className)
+        {
+            return {Type::Object, std::move(className)};
+        }
+
+        /**
+         * @brief Get the type of a value of a field type.
+         */
+        Type fromDescriptor(std::string_view descriptor)
+        {
+            if (descriptor.empty())
+            {
+                throw std::invalid_argument("Empty field descriptor.");
+            }
+            switch (descriptor.front())
+            {
+            case 'Z':
+            case 'B':
+            case 'C':
+            case 'S':
+            case 'I':
+                return {Type::Integer};
+            case 'F':
+                return {Type::Float};
+            case 'J':
+                return {Type::Long};
+            case 'D':
+                return {Type::Double};
+            case 'L':
+                if (descriptor.size() < 3 || descriptor.back() != ';')
+                {
+                    throw std::invalid_argument("Malformed field descriptor: " + std::string(descriptor));
+                }
+                return makeObject(std::string(descriptor.substr(1, descriptor.size() - 2)));
+            case '[':
+                return makeObject(std::string(descriptor));
+            default:
+                throw std::invalid_argument("Malformed field descriptor: " + std::string(descriptor));
+            }
+        }
+
+        /**
+         * @brief Get the field descriptor of a class or array type name.
+         */
+        std::string toDescriptor(const std::string& className)
+        {
+            return className.front() == '[' ? className : "L" + className + ";";
+        }
+
+        /**
+         * @brief Get the type of primitive values by the kind of a typed instruction (i, l, f, d).
+         */
+        Type::Kind getPrimitiveKind(int kind)
+        {
+            constexpr Type::Kind kinds[] = {Type::Integer, Type::Long, Type::Float, Type::Double};
+            return kinds[kind];
+        }
+
+        /**
+         * @brief Get the type pushed by an instruction whose effect depends only on its opcode.
+         * @return Pushed type, or @c Top if nothing is pushed.
+         */
+        Type::Kind getResultKind(Instruction::Command command)
+        {
+            if (Instruction::INSTRUCTION_iadd <= command && command <= Instruction::INSTRUCTION_dneg)
+            {
+                return getPrimitiveKind((command - Instruction::INSTRUCTION_iadd) % 4);
+            }
+            if (Instruction::INSTRUCTION_ishl <= command && command <= Instruction::INSTRUCTION_lxor)
+            {
+                return (command - Instruction::INSTRUCTION_ishl) % 2 == 0 ? Type::Integer : Type::Long;
+            }
+
+            switch (command)
+            {
+            case Instruction::INSTRUCTION_iconst_m1:
+            case Instruction::INSTRUCTION_iconst_0:
+            case Instruction::INSTRUCTION_iconst_1:
+            case Instruction::INSTRUCTION_iconst_2:
+            case Instruction::INSTRUCTION_iconst_3:
+            case Instruction::INSTRUCTION_iconst_4:
+            case Instruction::INSTRUCTION_iconst_5:
+            case Instruction::INSTRUCTION_bipush:
+            case Instruction::INSTRUCTION_sipush:
+            case Instruction::INSTRUCTION_iaload:
+            case Instruction::INSTRUCTION_baload:
+            case Instruction::INSTRUCTION_caload:
+            case Instruction::INSTRUCTION_saload:
+            case Instruction::INSTRUCTION_l2i:
+            case Instruction::INSTRUCTION_f2i:
+            case Instruction::INSTRUCTION_d2i:
+            case Instruction::INSTRUCTION_i2b:
+            case Instruction::INSTRUCTION_i2c:
+            case Instruction::INSTRUCTION_i2s:
+            case Instruction::INSTRUCTION_lcmp:
+            case Instruction::INSTRUCTION_fcmpl:
+            case Instruction::INSTRUCTION_fcmpg:
+            case Instruction::INSTRUCTION_dcmpl:
+            case Instruction::INSTRUCTION_dcmpg:
+            case Instruction::INSTRUCTION_arraylength:
+            case Instruction::INSTRUCTION_instanceof:
+                return Type::Integer;
+            case Instruction::INSTRUCTION_lconst_0:
+            case Instruction::INSTRUCTION_lconst_1:
+            case Instruction::INSTRUCTION_laload:
+            case Instruction::INSTRUCTION_i2l:
+            case Instruction::INSTRUCTION_f2l:
+            case Instruction::INSTRUCTION_d2l:
+                return Type::Long;
+            case Instruction::INSTRUCTION_fconst_0:
+            case Instruction::INSTRUCTION_fconst_1:
+            case Instruction::INSTRUCTION_fconst_2:
+            case Instruction::INSTRUCTION_faload:
+            case Instruction::INSTRUCTION_i2f:
+            case Instruction::INSTRUCTION_l2f:
+            case Instruction::INSTRUCTION_d2f:
+                return Type::Float;
+            case Instruction::INSTRUCTION_dconst_0:
+            case Instruction::INSTRUCTION_dconst_1:
+            case Instruction::INSTRUCTION_daload:
+            case Instruction::INSTRUCTION_i2d:
+            case Instruction::INSTRUCTION_l2d:
+            case Instruction::INSTRUCTION_f2d:
+                return Type::Double;
+            case Instruction::INSTRUCTION_aconst_null:
+                return Type::Null;
+            default:
+                return Type::Top;
+            }
+        }
+
+        Type pop(Frame& frame)
+        {
+            if (frame.stack.empty())
+            {
+                throw std::logic_error("Operand stack underflow.");
+            }
+            Type type = std::move(frame.stack.back());
+            frame.stack.pop_back();
+            return type;
+        }
+
+        void pop(Frame& frame, std::size_t count)
+        {
+            if (frame.stack.size() < count)
+            {
+                throw std::logic_error("Operand stack underflow.");
+            }
+            frame.stack.resize(frame.stack.size() - count);
+        }
+
+        /**
+         * @brief Pop a value of @p slots slots.
+         * @return Type of the value.
+         */
+        Type popValue(Frame& frame, std::size_t slots)
+        {
+            pop(frame, slots - 1);
+            return pop(frame);
+        }
+
+        void push(Frame& frame, Type type)
+        {
+            bool isWide = isCategory2(type);
+            frame.stack.push_back(std::move(type));
+            if (isWide)
+            {
+                frame.stack.emplace_back();
+            }
+        }
+
+        void setLocal(Frame& frame, std::size_t index, Type type)
+        {
+            std::size_t slots = isCategory2(type) ? 2 : 1;
+            if (frame.locals.size() < index + slots)
+            {
+                frame.locals.resize(index + slots);
+            }
+
+            // overwriting the second half of a long or double invalidates it
+            if (index > 0 && isCategory2(frame.locals[index - 1]))
+            {
+                frame.locals[index - 1] = {};
+            }
+            frame.locals[index] = std::move(type);
+            if (slots == 2)
+            {
+                frame.locals[index + 1] = {};
+            }
+        }
+
+        Type getLocal(const Frame& frame, std::size_t index)
+        {
+            return index < frame.locals.size() ? frame.locals[index] : Type{};
+        }
+
+        /**
+         * @brief Get the name and type of a field or method reference.
+         */
+        const ConstantNameAndType* getNameAndType(const Constant* constant)
+        {
+            switch (constant->getTag())
+            {
+            case Constant::CONSTANT_Fieldref:
+                return static_cast<const ConstantFieldref*>(constant)->getNameAndType();
+            case Constant::CONSTANT_Methodref:
+                return static_cast<const ConstantMethodref*>(constant)->getNameAndType();
+            case Constant::CONSTANT_InterfaceMethodref:
+                return static_cast<const ConstantInterfaceMethodref*>(constant)->getNameAndType();
+            default:
+                throw std::logic_error("Instruction does not reference a class member.");
+            }
+        }
+
+        std::string getClassName(const Constant* constant)
+        {
+            if (constant->getTag() != Constant::CONSTANT_Class)
+            {
+                throw std::logic_error("Instruction does not reference a class.");
+            }
+            return static_cast<const ConstantClass*>(constant)->getName()->getString();
+        }
+
+        const Constant* getConstant(const Instruction* instruction)
+        {
+            return static_cast<const InstructionWithConstant*>(instruction)->getConstant();
+        }
+    }
+
+    FrameAnalyzer::FrameAnalyzer(const AttributeCode& code, const ClassHierarchy& hierarchy) :
+        code_(code), hierarchy_(hierarchy)
+    {
+    }
+
+    void FrameAnalyzer::analyze(std::span<const uint32_t> framePositions)
+    {
+        const auto& instructions = code_.code_;
+        const Method* method = code_.getOwner();
+        className_ = method->getOwner()->getName();
+
+        positions_.clear();
+        positions_.reserve(instructions.size());
+        for (std::size_t i = 0; i < instructions.size(); ++i)
+        {
+            positions_.emplace(instructions[i], i);
+        }
+
+        needsFrame_.assign(instructions.size(), false);
+        for (auto position : framePositions)
+        {
+            needsFrame_[position] = true;
+        }
+        frames_.assign(instructions.size(), std::nullopt);
+        isReachable_.assign(instructions.size(), false);
+        isQueued_.assign(instructions.size(), false);
+        worklist_.clear();
+
+        // exception handlers
+        handlers_.clear();
+        for (const auto* handler : code_.exceptionHandlers_)
+        {
+            const auto* catchClass = handler->getCatchClass();
+            handlers_.push_back({
+                getPosition(handler->getTryStartLabel()->getInstruction()),
+                getPosition(handler->getTryFinishLabel()->getInstruction()),
+                getPosition(handler->getCatchStartLabel()->getInstruction()),
+                catchClass != nullptr ? catchClass->getName()->getString() : throwableClassName
+            });
+            needsFrame_[handlers_.back().handler] = true;
+        }
+
+        // basic blocks that are merge points
+        for (std::size_t i = 0; i < instructions.size(); ++i)
+        {
+            const Instruction* instruction = instructions[i];
+            auto command = instruction->getCommandCode();
+            if (command == Instruction::INSTRUCTION_jsr || command == Instruction::INSTRUCTION_jsr_w
+                || command == Instruction::INSTRUCTION_ret)
+            {
+                throw std::logic_error("Stack map frames can't be computed for code with subroutines (jsr/ret).");
+            }
+            bool isBranchOver = false;
+            if (instruction->getOperandKind() == Instruction::OPERAND_jump)
+            {
+                const auto* jump = static_cast<const InstructionJump*>(instruction);
+                needsFrame_[getPosition(jump->getJumpLabel()->getInstruction())] = true;
+                // a widened conditional jump is an inverted jump to the next instruction over a goto_w
+                isBranchOver = jump->isWide();
+            }
+            else if (instruction->getOperandKind() == Instruction::OPERAND_switch)
+            {
+                const auto* switchInstruction = static_cast<const InstructionSwitch*>(instruction);
+                needsFrame_[getPosition(switchInstruction->getDefaultLabel()->getInstruction())] = true;
+                for (const auto* label : switchInstruction->getLabels())
+                {
+                    needsFrame_[getPosition(label->getInstruction())] = true;
+                }
+            }
+            if ((isBranchOver || Bytecode::isTerminal(command)) && i + 1 < instructions.size())
+            {
+                needsFrame_[i + 1] = true;
+            }
+        }
+
+        // method entry: this and arguments
+        initialFrame_ = {};
+        std::string descriptor = method->getDescriptor()->getString();
+        if (!method->getAccessFlags()->contains(Method::ACC_STATIC))
+        {
+            if (method->getName()->getString() == "<init>" && className_ != objectClassName)
+            {
+                initialFrame_.locals.push_back({Type::UninitializedThis});
+            }
+            else
+            {
+                initialFrame_.locals.push_back(makeObject(className_));
+            }
+        }
+        for (auto argument : Bytecode::getArgumentTypes(descriptor))
+        {
+            setLocal(initialFrame_, initialFrame_.locals.size(), fromDescriptor(argument));
+        }
+
+        if (instructions.empty())
+        {
+            return;
+        }
+        merge(0, initialFrame_);
+        while (!worklist_.empty())
+        {
+            std::size_t position = worklist_.back();
+            worklist_.pop_back();
+            isQueued_[position] = false;
+            executeBlock(position);
+        }
+    }
+
+    const FrameAnalyzer::Frame& FrameAnalyzer::getInitialFrame() const
+    {
+        return initialFrame_;
+    }
+
+    const std::optional<FrameAnalyzer::Frame>& FrameAnalyzer::getFrame(std::size_t position) const
+    {
+        static const std::optional<Frame> noFrame{};
+        return needsFrame_[position] ? frames_[position] : noFrame;
+    }
+
+    bool FrameAnalyzer::isReachable(std::size_t position) const
+    {
+        return isReachable_[position];
+    }
+
+    std::size_t FrameAnalyzer::getPosition(const Instruction* instruction) const
+    {
+        auto position = positions_.find(instruction);
+        if (position == positions_.end())
+        {
+            throw std::logic_error("Label is not bound to an instruction of this code.");
+        }
+        return position->second;
+    }
+
+    void FrameAnalyzer::executeBlock(std::size_t position)
+    {
+        const auto& instructions = code_.code_;
+        Frame frame = *frames_[position];
+        while (true)
+        {
+            isReachable_[position] = true;
+
+            // exception handlers see locals before and after the instruction
+            bool isProtected = false;
+            for (const auto& range : handlers_)
+            {
+                if (range.start <= position && position < range.end)
+                {
+                    isProtected = true;
+                    mergeHandler(range, frame.locals);
+                }
+            }
+            std::vector<Type> localsBefore;
+            if (isProtected)
+            {
+                localsBefore = frame.locals;
+            }
+
+            try
+            {
+                execute(position, frame);
+            }
+            catch (const std::logic_error& e)
+            {
+                throw std::logic_error(std::string(e.what()) + " At instruction " + std::to_string(position) + ".");
+            }
+
+            if (isProtected && frame.locals != localsBefore)
+            {
+                for (const auto& range : handlers_)
+                {
+                    if (range.start <= position && position < range.end)
+                    {
+                        mergeHandler(range, frame.locals);
+                    }
+                }
+            }
+
+            if (Bytecode::isTerminal(instructions[position]->getCommandCode()))
+            {
+                return;
+            }
+            if (++position >= instructions.size())
+            {
+                throw std::logic_error("Execution falls off the end of the code.");
+            }
+            if (needsFrame_[position])
+            {
+                merge(position, frame);
+                return;
+            }
+        }
+    }
+
+    void FrameAnalyzer::execute(std::size_t position, Frame& frame)
+    {
+        const Instruction* instruction = code_.code_[position];
+        auto command = instruction->getCommandCode();
+
+        // loads and stores
+        uint8_t localSlots = Bytecode::getLocalSlots(command);
+        if (localSlots != 0 && command != Instruction::INSTRUCTION_iinc)
+        {
+            std::size_t index = code_.getLocalsEnd(instruction) - localSlots;
+            int kind;
+            bool isLoad;
+            if (command <= Instruction::INSTRUCTION_aload)
+            {
+                kind = command - Instruction::INSTRUCTION_iload;
+                isLoad = true;
+            }
+            else if (command <= Instruction::INSTRUCTION_aload_3)
+            {
+                kind = (command - Instruction::INSTRUCTION_iload_0) / 4;
+                isLoad = true;
+            }
+            else if (command <= Instruction::INSTRUCTION_astore)
+            {
+                kind = command - Instruction::INSTRUCTION_istore;
+                isLoad = false;
+            }
+            else
+            {
+                kind = (command - Instruction::INSTRUCTION_istore_0) / 4;
+                isLoad = false;
+            }
+
+            constexpr int referenceKind = 4;
+            if (isLoad)
+            {
+                push(frame, kind == referenceKind ? getLocal(frame, index) : Type{getPrimitiveKind(kind)});
+            }
+            else
+            {
+                setLocal(frame, index, popValue(frame, localSlots));
+            }
+            return;
+        }
+
+        switch (command)
+        {
+        case Instruction::INSTRUCTION_ldc:
+        case Instruction::INSTRUCTION_ldc_w:
+        case Instruction::INSTRUCTION_ldc2_w:
+            {
+                const Constant* constant = getConstant(instruction);
+                switch (constant->getTag())
+                {
+                case Constant::CONSTANT_Integer:
+                    push(frame, {Type::Integer});
+                    break;
+                case Constant::CONSTANT_Float:
+                    push(frame, {Type::Float});
+                    break;
+                case Constant::CONSTANT_Long:
+                    push(frame, {Type::Long});
+                    break;
+                case Constant::CONSTANT_Double:
+                    push(frame, {Type::Double});
+                    break;
+                case Constant::CONSTANT_String:
+                    push(frame, makeObject("java/lang/String"));
+                    break;
+                case Constant::CONSTANT_Class:
+                    push(frame, makeObject("java/lang/Class"));
+                    break;
+                case Constant::CONSTANT_MethodType:
+                    push(frame, makeObject("java/lang/invoke/MethodType"));
+                    break;
+                case Constant::CONSTANT_MethodHandle:
+                    push(frame, makeObject("java/lang/invoke/MethodHandle"));
+                    break;
+                default:
+                    throw std::logic_error("Unsupported constant in ldc.");
+                }
+                return;
+            }
+        case Instruction::INSTRUCTION_aaload:
+            {
+                pop(frame);
+                Type array = pop(frame);
+                if (array.kind == Type::Object && array.className.size() > 1 && array.className.front() == '[')
+                {
+                    push(frame, fromDescriptor(std::string_view(array.className).substr(1)));
+                }
+                else if (array.kind == Type::Null)
+                {
+                    push(frame, {Type::Null});
+                }
+                else
+                {
+                    push(frame, makeObject(objectClassName));
+                }
+                return;
+            }
+        case Instruction::INSTRUCTION_dup:
+            {
+                Type value = pop(frame);
+                frame.stack.push_back(value);
+                frame.stack.push_back(std::move(value));
+                return;
+            }
+        case Instruction::INSTRUCTION_dup_x1:
+            {
+                Type value1 = pop(frame);
+                Type value2 = pop(frame);
+                frame.stack.push_back(value1);
+                frame.stack.push_back(std::move(value2));
+                frame.stack.push_back(std::move(value1));
+                return;
+            }
+        case Instruction::INSTRUCTION_dup_x2:
+            {
+                Type value1 = pop(frame);
+                Type value2 = pop(frame);
+                Type value3 = pop(frame);
+                frame.stack.push_back(value1);
+                frame.stack.push_back(std::move(value3));
+                frame.stack.push_back(std::move(value2));
+                frame.stack.push_back(std::move(value1));
+                return;
+            }
+        case Instruction::INSTRUCTION_dup2:
+            {
+                Type value1 = pop(frame);
+                Type value2 = pop(frame);
+                frame.stack.push_back(value2);
+                frame.stack.push_back(value1);
+                frame.stack.push_back(std::move(value2));
+                frame.stack.push_back(std::move(value1));
+                return;
+            }
+        case Instruction::INSTRUCTION_dup2_x1:
+            {
+                Type value1 = pop(frame);
+                Type value2 = pop(frame);
+                Type value3 = pop(frame);
+                frame.stack.push_back(value2);
+                frame.stack.push_back(value1);
+                frame.stack.push_back(std::move(value3));
+                frame.stack.push_back(std::move(value2));
+                frame.stack.push_back(std::move(value1));
+                return;
+            }
+        case Instruction::INSTRUCTION_dup2_x2:
+            {
+                Type value1 = pop(frame);
+                Type value2 = pop(frame);
+                Type value3 = pop(frame);
+                Type value4 = pop(frame);
+                frame.stack.push_back(value2);
+                frame.stack.push_back(value1);
+                frame.stack.push_back(std::move(value4));
+                frame.stack.push_back(std::move(value3));
+                frame.stack.push_back(std::move(value2));
+                frame.stack.push_back(std::move(value1));
+                return;
+            }
+        case Instruction::INSTRUCTION_swap:
+            {
+                Type value1 = pop(frame);
+                Type value2 = pop(frame);
+                frame.stack.push_back(std::move(value1));
+                frame.stack.push_back(std::move(value2));
+                return;
+            }
+        case Instruction::INSTRUCTION_getstatic:
+        case Instruction::INSTRUCTION_putstatic:
+        case Instruction::INSTRUCTION_getfield:
+        case Instruction::INSTRUCTION_putfield:
+            {
+                std::string descriptor = getNameAndType(getConstant(instruction))->getDescriptor()->getString();
+                Type value = fromDescriptor(descriptor);
+                std::size_t slots = Bytecode::getSlots(descriptor);
+                switch (command)
+                {
+                case Instruction::INSTRUCTION_getstatic:
+                    push(frame, std::move(value));
+                    break;
+                case Instruction::INSTRUCTION_putstatic:
+                    pop(frame, slots);
+                    break;
+                case Instruction::INSTRUCTION_getfield:
+                    pop(frame);
+                    push(frame, std::move(value));
+                    break;
+                default:
+                    pop(frame, slots + 1);
+                    break;
+                }
+                return;
+            }
+        case Instruction::INSTRUCTION_invokevirtual:
+        case Instruction::INSTRUCTION_invokespecial:
+        case Instruction::INSTRUCTION_invokestatic:
+        case Instruction::INSTRUCTION_invokeinterface:
+        case Instruction::INSTRUCTION_invokedynamic:
+            {
+                const auto* nameAndType = getNameAndType(getConstant(instruction));
+                std::string descriptor = nameAndType->getDescriptor()->getString();
+                pop(frame, Bytecode::getArgumentSlots(descriptor));
+                if (command != Instruction::INSTRUCTION_invokestatic && command != Instruction::INSTRUCTION_invokedynamic)
+                {
+                    Type receiver = pop(frame);
+                    if (command == Instruction::INSTRUCTION_invokespecial
+                        && nameAndType->getName()->getString() == "<init>")
+                    {
+                        initialize(frame, receiver);
+                    }
+                }
+                auto returnType = Bytecode::getReturnType(descriptor);
+                if (returnType != "V")
+                {
+                    push(frame, fromDescriptor(returnType));
+                }
+                return;
+            }
+        case Instruction::INSTRUCTION_new:
+            push(frame, {Type::Uninitialized, {}, instruction});
+            return;
+        case Instruction::INSTRUCTION_newarray:
+            {
+                static constexpr char elementTypes[] = "????ZCFDBSIJ";
+                if (instruction->getOperandKind() != Instruction::OPERAND_value)
+                {
+                    throw std::logic_error("Unsupported newarray type.");
+                }
+                auto type = static_cast<const InstructionValue<uint8_t>*>(instruction)->getFirstValue();
+                if (type < Instruction::BOOLEAN || type > Instruction::LONG)
+                {
+                    throw std::logic_error("Unsupported newarray type.");
+                }
+                pop(frame);
+                push(frame, makeObject(std::string("[") + elementTypes[type]));
+                return;
+            }
+        case Instruction::INSTRUCTION_anewarray:
+            pop(frame);
+            push(frame, makeObject("[" + toDescriptor(getClassName(getConstant(instruction)))));
+            return;
+        case Instruction::INSTRUCTION_checkcast:
+            pop(frame);
+            push(frame, makeObject(getClassName(getConstant(instruction))));
+            return;
+        case Instruction::INSTRUCTION_multianewarray:
+            // pops dimensions, pushes array
+            pop(frame, 1 - code_.getStackDelta(instruction));
+            push(frame, makeObject(getClassName(getConstant(instruction))));
+            return;
+        default:
+            break;
+        }
+
+        // instructions whose effect depends only on the opcode
+        int8_t delta = Bytecode::getStackDelta(command);
+        if (delta == Bytecode::variableStackDelta || command == Instruction::INSTRUCTION_breakpoint)
+        {
+            throw std::logic_error("Unsupported instruction.");
+        }
+        Type result{getResultKind(command)};
+        int32_t resultSlots = result.kind == Type::Top ? 0 : isCategory2(result) ? 2 : 1;
+        pop(frame, resultSlots - delta);
+        if (resultSlots != 0)
+        {
+            push(frame, std::move(result));
+        }
+
+        if (instruction->getOperandKind() == Instruction::OPERAND_jump)
+        {
+            const auto* jump = static_cast<const InstructionJump*>(instruction);
+            merge(getPosition(jump->getJumpLabel()->getInstruction()), frame);
+        }
+        else if (instruction->getOperandKind() == Instruction::OPERAND_switch)
+        {
+            const auto* switchInstruction = static_cast<const InstructionSwitch*>(instruction);
+            merge(getPosition(switchInstruction->getDefaultLabel()->getInstruction()), frame);
+            for (const auto* label : switchInstruction->getLabels())
+            {
+                merge(getPosition(label->getInstruction()), frame);
+            }
+        }
+    }
+
+    void FrameAnalyzer::initialize(Frame& frame, const Type& uninitialized) const
+    {
+        Type initialized;
+        switch (uninitialized.kind)
+        {
+        case Type::UninitializedThis:
+            initialized = makeObject(className_);
+            break;
+        case Type::Uninitialized:
+            initialized = makeObject(getClassName(getConstant(uninitialized.newInstruction)));
+            break;
+        default:
+            return;
+        }
+        std::replace(frame.locals.begin(), frame.locals.end(), uninitialized, initialized);
+        std::replace(frame.stack.begin(), frame.stack.end(), uninitialized, initialized);
+    }
+
+    void FrameAnalyzer::merge(std::size_t position, const Frame& frame)
+    {
+        auto& existing = frames_[position];
+        bool isChanged = false;
+        if (!existing)
+        {
+            existing = frame;
+            isChanged = true;
+        }
+        else
+        {
+            if (existing->stack.size() != frame.stack.size())
+            {
+                throw std::logic_error(
+                    "Operand stack has different sizes on merging paths at instruction " + std::to_string(position) + ".");
+            }
+            for (std::size_t i = 0; i < frame.stack.size(); ++i)
+            {
+                auto& current = existing->stack[i];
+                if (current == frame.stack[i])
+                {
+                    continue;
+                }
+                Type merged = mergeTypes(current, frame.stack[i]);
+                if (merged.kind == Type::Top)
+                {
+                    throw std::logic_error(
+                        "Operand stack has incompatible types on merging paths at instruction "
+                        + std::to_string(position) + ".");
+                }
+                if (merged != current)
+                {
+                    current = std::move(merged);
+                    isChanged = true;
+                }
+            }
+
+            // a local variable missing on either path is unusable
+            if (frame.locals.size() < existing->locals.size())
+            {
+                for (auto i = frame.locals.size(); i < existing->locals.size(); ++i)
+                {
+                    isChanged |= existing->locals[i].kind != Type::Top;
+                }
+                existing->locals.resize(frame.locals.size());
+            }
+            for (std::size_t i = 0; i < existing->locals.size(); ++i)
+            {
+                auto& current = existing->locals[i];
+                if (current == frame.locals[i])
+                {
+                    continue;
+                }
+                Type merged = mergeTypes(current, frame.locals[i]);
+                if (merged != current)
+                {
+                    current = std::move(merged);
+                    isChanged = true;
+                }
+            }
+        }
+
+        if (isChanged && !isQueued_[position])
+        {
+            isQueued_[position] = true;
+            worklist_.push_back(position);
+        }
+    }
+
+    void FrameAnalyzer::mergeHandler(const HandlerRange& range, const std::vector<Type>& locals)
+    {
+        Frame frame{locals, {makeObject(range.catchType)}};
+        merge(range.handler, frame);
+    }
+
+    FrameAnalyzer::Type FrameAnalyzer::mergeTypes(const Type& first, const Type& second) const
+    {
+        if (first == second)
+        {
+            return first;
+        }
+        if (!isReference(first) || !isReference(second))
+        {
+            return {};
+        }
+        if (first.kind == Type::Null)
+        {
+            return second;
+        }
+        if (second.kind == Type::Null)
+        {
+            return first;
+        }
+        return makeObject(getCommonSuperClass(first.className, second.className));
+    }
+
+    std::string FrameAnalyzer::getCommonSuperClass(const std::string& first, const std::string& second) const
+    {
+        if (first == second)
+        {
+            return first;
+        }
+
+        bool isFirstArray = first.front() == '[';
+        bool isSecondArray = second.front() == '[';
+        if (!isFirstArray && !isSecondArray)
+        {
+            return hierarchy_.getCommonSuperClass(first, second);
+        }
+        if (!isFirstArray || !isSecondArray)
+        {
+            return objectClassName;
+        }
+
+        // arrays of references are covariant
+        auto firstElement = std::string_view(first).substr(1);
+        auto secondElement = std::string_view(second).substr(1);
+        auto isReferenceElement = [](std::string_view element)
+        {
+            return element.front() == 'L' || element.front() == '[';
+        };
+        if (!isReferenceElement(firstElement) || !isReferenceElement(secondElement))
+        {
+            return objectClassName;
+        }
+        Type firstType = fromDescriptor(firstElement);
+        Type secondType = fromDescriptor(secondElement);
+        return "[" + toDescriptor(getCommonSuperClass(firstType.className, secondType.className));
+    }
+} // jvm::internal
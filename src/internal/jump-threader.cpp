@@ -0,0 +1,168 @@
+#include "jvm/internal/jump-threader.h"
+
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "jvm/attribute-code.h"
+#include "jvm/instruction-jump.h"
+#include "jvm/instruction-switch.h"
+
+namespace jvm::internal
+{
+    namespace
+    {
+        bool isGoto(const Instruction* instruction)
+        {
+            auto command = instruction->getCommandCode();
+            return command == Instruction::INSTRUCTION_goto || command == Instruction::INSTRUCTION_goto_w;
+        }
+
+        bool isConditional(Instruction::Command command)
+        {
+            return (Instruction::INSTRUCTION_ifeq <= command && command <= Instruction::INSTRUCTION_if_acmpne)
+                || command == Instruction::INSTRUCTION_ifnull || command == Instruction::INSTRUCTION_ifnonnull;
+        }
+
+        const Instruction* getTarget(const Instruction* jump)
+        {
+            return static_cast<const InstructionJump*>(jump)->getJumpLabel()->getInstruction();
+        }
+    }
+
+    JumpThreader::JumpThreader(AttributeCode& code) : code_(code)
+    {
+    }
+
+    std::size_t JumpThreader::run()
+    {
+        std::size_t changes = 0;
+        for (std::size_t count = retarget() + collapse(); count != 0; count = retarget() + collapse())
+        {
+            changes += count;
+        }
+        code_.removeEmptyExceptionHandlers();
+        return changes;
+    }
+
+    std::size_t JumpThreader::retarget()
+    {
+        std::size_t count = 0;
+        auto thread = [&](Label*& label)
+        {
+            Label* finalLabel = getFinalLabel(label);
+            if (finalLabel != label)
+            {
+                label = finalLabel;
+                ++count;
+            }
+        };
+
+        for (auto* instruction : code_.code_)
+        {
+            if (instruction->getOperandKind() == Instruction::OPERAND_jump)
+            {
+                thread(static_cast<InstructionJump*>(instruction)->label_);
+            }
+            else if (instruction->getOperandKind() == Instruction::OPERAND_switch)
+            {
+                auto* switchInstruction = static_cast<InstructionSwitch*>(instruction);
+                thread(switchInstruction->defaultLabel_);
+                for (auto& label : switchInstruction->labels_)
+                {
+                    thread(label);
+                }
+            }
+        }
+        return count;
+    }
+
+    std::size_t JumpThreader::collapse()
+    {
+        std::unordered_set<const Instruction*> labeled;
+        for (const auto* label : code_.allRegisteredLabels_)
+        {
+            labeled.insert(label->getInstruction());
+        }
+
+        const auto& source = code_.code_;
+        std::vector<Instruction*> code;
+        code.reserve(source.size());
+        std::vector<Instruction*> removed;
+        std::unordered_map<const Instruction*, Instruction*> moved;
+        std::vector<const Instruction*> movedToNext;
+
+        auto emit = [&](Instruction* instruction)
+        {
+            for (const auto* removedGoto : movedToNext)
+            {
+                moved.emplace(removedGoto, instruction);
+            }
+            movedToNext.clear();
+            code.push_back(instruction);
+        };
+
+        for (std::size_t i = 0; i < source.size(); ++i)
+        {
+            Instruction* instruction = source[i];
+            if (isGoto(instruction) && i + 1 < source.size() && getTarget(instruction) == source[i + 1])
+            {
+                // the last instruction is never removed, so moved labels always have a next instruction
+                if (labeled.contains(instruction))
+                {
+                    movedToNext.push_back(instruction);
+                }
+                removed.push_back(instruction);
+                continue;
+            }
+            if (isConditional(instruction->getCommandCode()) && i + 2 < source.size() && isGoto(source[i + 1])
+                && !labeled.contains(source[i + 1]) && getTarget(instruction) == source[i + 2])
+            {
+                auto* jump = static_cast<InstructionJump*>(instruction);
+                auto* over = static_cast<InstructionJump*>(source[i + 1]);
+                jump->invert();
+                jump->label_ = over->label_;
+                emit(jump);
+                removed.push_back(over);
+                ++i;
+                continue;
+            }
+            emit(instruction);
+        }
+        if (removed.empty())
+        {
+            return 0;
+        }
+
+        for (auto* label : code_.allRegisteredLabels_)
+        {
+            auto target = moved.find(label->instruction_);
+            if (target != moved.end())
+            {
+                label->instruction_ = target->second;
+            }
+        }
+        for (auto* instruction : removed)
+        {
+            std::destroy_at(instruction);
+        }
+        code_.code_ = std::move(code);
+        return removed.size();
+    }
+
+    Label* JumpThreader::getFinalLabel(Label* label) const
+    {
+        Label* finalLabel = label;
+        for (std::size_t hops = 0; hops <= code_.code_.size(); ++hops)
+        {
+            const Instruction* target = finalLabel->getInstruction();
+            if (target == nullptr || !isGoto(target))
+            {
+                return finalLabel;
+            }
+            finalLabel = static_cast<const InstructionJump*>(target)->getJumpLabel();
+        }
+        return label;
+    }
+} // jvm::internal
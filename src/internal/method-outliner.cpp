@@ -0,0 +1,743 @@
+#include "jvm/internal/method-outliner.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+#include "jvm/attribute-code.h"
+#include "jvm/class.h"
+#include "jvm/class-hierarchy.h"
+#include "jvm/constant-utf-8-info.h"
+#include "jvm/control-flow-graph.h"
+#include "jvm/exception-handler.h"
+#include "jvm/instruction-jump.h"
+#include "jvm/instruction-switch.h"
+#include "jvm/method.h"
+#include "jvm/internal/bytecode.h"
+
+namespace jvm::internal
+{
+    namespace
+    {
+        using Type = FrameAnalyzer::Type;
+
+        constexpr std::size_t noRead = std::numeric_limits<std::size_t>::max();
+
+        /// Largest return of a new method: load of the result with a one-byte index, then return.
+        constexpr std::size_t maxExitSize = 3;
+
+        /// Region ends checked per first block, the largest first.
+        constexpr std::size_t maxChecks = 16;
+
+        bool isLoad(Instruction::Command command)
+        {
+            return Instruction::INSTRUCTION_iload <= command && command <= Instruction::INSTRUCTION_aload_3;
+        }
+
+        bool isStore(Instruction::Command command)
+        {
+            return Instruction::INSTRUCTION_istore <= command && command <= Instruction::INSTRUCTION_astore_3;
+        }
+
+        bool isReturn(Instruction::Command command)
+        {
+            return Instruction::INSTRUCTION_ireturn <= command && command <= Instruction::INSTRUCTION_return;
+        }
+
+        std::string getDescriptor(const Type& type)
+        {
+            switch (type.kind)
+            {
+            case Type::Float:
+                return "F";
+            case Type::Long:
+                return "J";
+            case Type::Double:
+                return "D";
+            case Type::Object:
+                return type.className.starts_with('[') ? type.className : "L" + type.className + ";";
+            default:
+                return "I";
+            }
+        }
+
+        uint8_t getSlots(const Type& type)
+        {
+            return type.kind == Type::Long || type.kind == Type::Double ? 2 : 1;
+        }
+
+        std::size_t getLoadSize(uint16_t slot)
+        {
+            return slot <= 3 ? 1 : 2;
+        }
+
+        Instruction* createLoad(AttributeCode& code, const Type& type, uint16_t slot)
+        {
+            switch (type.kind)
+            {
+            case Type::Float:
+                return code.LoadFloat(slot);
+            case Type::Long:
+                return code.LoadLong(slot);
+            case Type::Double:
+                return code.LoadDouble(slot);
+            case Type::Object:
+                return code.LoadReference(slot);
+            default:
+                return code.LoadInt(slot);
+            }
+        }
+
+        Instruction* createStore(AttributeCode& code, const Type& type, uint16_t slot)
+        {
+            switch (type.kind)
+            {
+            case Type::Float:
+                return code.StoreFloat(slot);
+            case Type::Long:
+                return code.StoreLong(slot);
+            case Type::Double:
+                return code.StoreDouble(slot);
+            case Type::Object:
+                return code.StoreReference(slot);
+            default:
+                return code.StoreInt(slot);
+            }
+        }
+
+        Instruction* createZero(AttributeCode& code, const Type& type)
+        {
+            switch (type.kind)
+            {
+            case Type::Float:
+                return code.PushFloat(0);
+            case Type::Long:
+                return code.PushLong(0);
+            case Type::Double:
+                return code.PushDouble(0);
+            case Type::Object:
+                return code.PushNull();
+            default:
+                return code.PushInt(0);
+            }
+        }
+
+        /**
+         * @param descriptor Field descriptor, or @c V.
+         */
+        Instruction* createReturn(AttributeCode& code, std::string_view descriptor)
+        {
+            switch (descriptor.front())
+            {
+            case 'V':
+                return code.ReturnVoid();
+            case 'J':
+                return code.ReturnLong();
+            case 'F':
+                return code.ReturnFloat();
+            case 'D':
+                return code.ReturnDouble();
+            case 'L':
+            case '[':
+                return code.ReturnReference();
+            default:
+                return code.ReturnInt();
+            }
+        }
+    }
+
+    MethodOutliner::MethodOutliner(AttributeCode& code, std::size_t maxSize) : code_(code), maxSize_(maxSize)
+    {
+    }
+
+    std::vector<Method*> MethodOutliner::run()
+    {
+        Class* owner = code_.getOwner()->getOwner();
+        if (owner->getAccessFlags()->contains(Class::ACC_INTERFACE))
+        {
+            throw std::logic_error("Methods of an interface can't be outlined.");
+        }
+        // without a hierarchy distinct classes merge to java/lang/Object, too loose a type for an argument
+        const ClassHierarchy* hierarchy = owner->getClassHierarchy();
+        if (hierarchy == nullptr)
+        {
+            throw std::logic_error("Outlining requires the class hierarchy of the class.");
+        }
+
+        std::vector<Method*> methods;
+        for (std::size_t size = code_.getUnlaidSize(); size > maxSize_; size = code_.getUnlaidSize())
+        {
+            ControlFlowGraph graph(code_);
+            std::vector<uint32_t> blockStarts;
+            blockStarts.reserve(graph.getBlocks().size());
+            for (const auto& block : graph.getBlocks())
+            {
+                blockStarts.push_back(block.start);
+            }
+            FrameAnalyzer analyzer(code_, *hierarchy);
+            analyzer.analyze(blockStarts);
+            prepare(graph);
+
+            // the largest disjoint regions until the code is small enough
+            auto regions = findRegions(graph, analyzer);
+            std::ranges::stable_sort(regions, std::greater{}, &Region::gain);
+            std::vector<bool> isTaken(graph.getBlocks().size(), false);
+            std::vector<const Region*> selected;
+            for (const auto& region : regions)
+            {
+                if (size <= maxSize_)
+                {
+                    break;
+                }
+                auto blocks = isTaken.begin();
+                if (std::find(blocks + region.first, blocks + region.end, true) != blocks + region.end)
+                {
+                    continue;
+                }
+                std::fill(blocks + region.first, blocks + region.end, true);
+                selected.push_back(&region);
+                size -= region.gain;
+            }
+            if (selected.empty())
+            {
+                break;
+            }
+
+            // labels of all regions are resolved before any instruction moves, then regions move from the last one
+            std::ranges::sort(selected, std::greater{}, &Region::first);
+            std::vector<Move> moves;
+            moves.reserve(selected.size());
+            for (const auto* region : selected)
+            {
+                moves.push_back(prepareMove(graph, *region));
+            }
+            for (const auto& move : moves)
+            {
+                applyMove(move);
+                methods.push_back(move.method);
+            }
+        }
+        return methods;
+    }
+
+    void MethodOutliner::prepare(const ControlFlowGraph& graph)
+    {
+        const auto& code = code_.code_;
+        positions_.clear();
+        positions_.reserve(code.size());
+        for (std::size_t i = 0; i < code.size(); ++i)
+        {
+            positions_.emplace(code[i], i);
+        }
+
+        // local variable accesses, iinc both reads and writes
+        reads_.assign(code.size(), -1);
+        writes_.assign(code.size(), -1);
+        firstReads_.clear();
+        lastReads_.clear();
+        for (std::size_t i = 0; i < code.size(); ++i)
+        {
+            auto command = code[i]->getCommandCode();
+            uint8_t localSlots = Bytecode::getLocalSlots(command);
+            if (localSlots == 0 || command == Instruction::INSTRUCTION_ret)
+            {
+                continue;
+            }
+            auto slot = static_cast<int32_t>(code_.getLocalsEnd(code[i]) - localSlots);
+            if (isLoad(command) || command == Instruction::INSTRUCTION_iinc)
+            {
+                reads_[i] = slot;
+                if (static_cast<std::size_t>(slot) >= firstReads_.size())
+                {
+                    firstReads_.resize(slot + 1, noRead);
+                    lastReads_.resize(slot + 1, 0);
+                }
+                firstReads_[slot] = std::min(firstReads_[slot], i);
+                lastReads_[slot] = i;
+            }
+            if (isStore(command) || command == Instruction::INSTRUCTION_iinc)
+            {
+                writes_[i] = slot;
+            }
+        }
+
+        isLabeled_.assign(code.size(), false);
+        for (const auto* label : code_.allRegisteredLabels_)
+        {
+            auto position = positions_.find(label->getInstruction());
+            if (position != positions_.end())
+            {
+                isLabeled_[position->second] = true;
+            }
+        }
+
+        auto blocks = graph.getBlocks();
+        blockSizes_.assign(blocks.size(), 0);
+        firstPredecessors_.assign(blocks.size(), 0);
+        lastPredecessors_.assign(blocks.size(), 0);
+        isReturn_.assign(blocks.size(), false);
+        for (uint32_t block = 0; block < blocks.size(); ++block)
+        {
+            blockSizes_[block] = code_.getUnlaidSize(blocks[block].start, blocks[block].end);
+            auto predecessors = graph.getPredecessors(block);
+            firstPredecessors_[block] = predecessors.empty() ? block : predecessors.front();
+            lastPredecessors_[block] = predecessors.empty() ? block : predecessors.back();
+            isReturn_[block] = isReturn(code[blocks[block].end - 1]->getCommandCode());
+        }
+
+        handlers_.clear();
+        for (auto* handler : code_.exceptionHandlers_)
+        {
+            handlers_.push_back({
+                positions_.at(handler->getTryStartLabel()->getInstruction()),
+                positions_.at(handler->getTryFinishLabel()->getInstruction()),
+                positions_.at(handler->getCatchStartLabel()->getInstruction()),
+                handler
+            });
+        }
+    }
+
+    std::vector<MethodOutliner::Region> MethodOutliner::findRegions(const ControlFlowGraph& graph,
+                                                                    const FrameAnalyzer& analyzer) const
+    {
+        auto blocks = graph.getBlocks();
+        auto count = static_cast<uint32_t>(blocks.size());
+        std::size_t budget = maxSize_ > maxExitSize ? maxSize_ - maxExitSize : 0;
+
+        std::vector<Region> regions;
+        std::vector<uint32_t> exitCounts(count, 0); // jumps from the region to each block after it
+        std::vector<uint32_t> targets; // blocks with an exit count
+        std::vector<std::pair<uint32_t, std::optional<uint32_t>>> ends; // ends with a single continuation
+        std::vector<std::size_t> sizes;
+        for (uint32_t first = 0; first < count; ++first)
+        {
+            const auto& entry = analyzer.getFrame(blocks[first].start);
+            if (!entry || !entry->stack.empty())
+            {
+                continue;
+            }
+
+            // grow the region block by block while nothing before it jumps into it
+            uint32_t exitCount = 0;
+            uint32_t lastPredecessor = first;
+            std::size_t size = 0;
+            bool hasReturn = false;
+            for (uint32_t block = first; block < count; ++block)
+            {
+                if (block != first)
+                {
+                    if (firstPredecessors_[block] < first)
+                    {
+                        break;
+                    }
+                    lastPredecessor = std::max(lastPredecessor, lastPredecessors_[block]);
+                }
+                size += blockSizes_[block];
+                if (size > budget)
+                {
+                    break;
+                }
+                if (exitCounts[block] != 0)
+                {
+                    --exitCount;
+                }
+                hasReturn = hasReturn || isReturn_[block];
+
+                bool isBackward = false;
+                for (auto successor : graph.getSuccessors(block))
+                {
+                    if (successor < first)
+                    {
+                        isBackward = true;
+                        break;
+                    }
+                    if (successor > block && exitCounts[successor]++ == 0)
+                    {
+                        ++exitCount;
+                        targets.push_back(successor);
+                    }
+                }
+                if (isBackward)
+                {
+                    break;
+                }
+
+                // blocks after the region may still jump into it, or it may continue at several places
+                uint32_t end = block + 1;
+                if (lastPredecessor >= end || exitCount > 1 || (exitCount == 1 && hasReturn))
+                {
+                    continue;
+                }
+                std::optional<uint32_t> exit;
+                if (exitCount == 1)
+                {
+                    exit = *std::ranges::find_if(targets, [&](uint32_t target)
+                    {
+                        return target >= end && exitCounts[target] != 0;
+                    });
+                }
+                ends.emplace_back(end, exit);
+                sizes.push_back(size);
+            }
+            for (auto target : targets)
+            {
+                exitCounts[target] = 0;
+            }
+            targets.clear();
+
+            for (std::size_t i = ends.size(), checks = 0; i-- > 0 && checks < maxChecks; ++checks)
+            {
+                auto region = checkRegion(graph, analyzer, first, ends[i].first, ends[i].second, sizes[i]);
+                if (region)
+                {
+                    regions.push_back(std::move(*region));
+                    break;
+                }
+            }
+            ends.clear();
+            sizes.clear();
+        }
+        return regions;
+    }
+
+    std::optional<MethodOutliner::Region> MethodOutliner::checkRegion(const ControlFlowGraph& graph,
+                                                                      const FrameAnalyzer& analyzer, uint32_t first,
+                                                                      uint32_t end, std::optional<uint32_t> exit,
+                                                                      std::size_t size) const
+    {
+        auto blocks = graph.getBlocks();
+        std::size_t start = blocks[first].start;
+        std::size_t finish = blocks[end - 1].end;
+        const auto& entry = *analyzer.getFrame(start);
+        const FrameAnalyzer::Frame* continuation = nullptr;
+        if (exit)
+        {
+            const auto& frame = analyzer.getFrame(blocks[*exit].start);
+            if (!frame || !frame->stack.empty())
+            {
+                return std::nullopt;
+            }
+            continuation = &*frame;
+        }
+
+        // exception ranges move with their handler or stay around or away from the region
+        bool isProtected = false;
+        for (const auto& range : handlers_)
+        {
+            bool isHandlerInside = start <= range.handler && range.handler < finish;
+            bool isInside = start <= range.start && range.end <= finish;
+            bool isAround = range.start <= start && finish <= range.end;
+            bool isAway = range.end <= start || finish <= range.start;
+            if (isHandlerInside)
+            {
+                // a range ending with the region ends at the return of the new method
+                if (!isInside || (!exit && range.end == finish))
+                {
+                    return std::nullopt;
+                }
+            }
+            else if (isAround)
+            {
+                isProtected = true;
+            }
+            else if (!isAway)
+            {
+                return std::nullopt;
+            }
+        }
+
+        // static fields are final only in <clinit>, instance fields in <init>; monitors must be balanced per frame
+        const auto& code = code_.code_;
+        bool isInitializer = code_.getOwner()->getName()->getString().starts_with('<');
+        std::vector<bool> isRead(firstReads_.size(), false);
+        std::vector<uint16_t> written;
+        std::size_t readEnd = 0;
+        for (std::size_t position = start; position < finish; ++position)
+        {
+            auto command = code[position]->getCommandCode();
+            if (command == Instruction::INSTRUCTION_monitorenter || command == Instruction::INSTRUCTION_monitorexit
+                || (isInitializer && (command == Instruction::INSTRUCTION_putfield
+                    || command == Instruction::INSTRUCTION_putstatic)))
+            {
+                return std::nullopt;
+            }
+            if (reads_[position] >= 0)
+            {
+                isRead[reads_[position]] = true;
+                readEnd = std::max<std::size_t>(readEnd, reads_[position] + 1);
+            }
+            if (writes_[position] >= 0)
+            {
+                written.push_back(static_cast<uint16_t>(writes_[position]));
+            }
+        }
+
+        // a handler around the region reads the local variables of the caller, which the new method can't write
+        if (isProtected && !written.empty())
+        {
+            return std::nullopt;
+        }
+
+        // a written local variable live after the region is returned, the others are dead or unchanged
+        Region region{first, end, exit};
+        if (continuation != nullptr)
+        {
+            std::ranges::sort(written);
+            auto [last, writtenEnd] = std::ranges::unique(written);
+            written.erase(last, writtenEnd);
+            for (auto slot : written)
+            {
+                bool isReadOutside = slot < firstReads_.size() && firstReads_[slot] != noRead
+                    && (firstReads_[slot] < start || lastReads_[slot] >= finish);
+                if (!isReadOutside || slot >= continuation->locals.size()
+                    || continuation->locals[slot].kind == Type::Top)
+                {
+                    continue;
+                }
+                const auto& type = continuation->locals[slot];
+                if (region.result
+                    || (type.kind != Type::Integer && type.kind != Type::Float && type.kind != Type::Long
+                        && type.kind != Type::Double && type.kind != Type::Object))
+                {
+                    return std::nullopt;
+                }
+                region.result = type;
+                region.resultSlot = slot;
+            }
+        }
+
+        // arguments keep the slots of the local variables
+        std::size_t argumentEnd = region.result ? std::max<std::size_t>(readEnd, region.resultSlot + 1) : readEnd;
+        std::size_t callSize = 3;
+        region.descriptor = "(";
+        static const Type top{};
+        std::size_t slot = 0;
+        while (slot < argumentEnd)
+        {
+            const Type& local = slot < entry.locals.size() ? entry.locals[slot] : top;
+            Type type{};
+            bool isZero = true;
+            if (region.result && slot == region.resultSlot)
+            {
+                // a local variable unset before the region is set on all its paths
+                type = *region.result;
+                if (local == type)
+                {
+                    isZero = false;
+                }
+                else if (local.kind != Type::Top)
+                {
+                    return std::nullopt;
+                }
+            }
+            else if (slot < isRead.size() && isRead[slot] && local.kind != Type::Top)
+            {
+                if (local.kind == Type::Null || local.kind == Type::Uninitialized
+                    || local.kind == Type::UninitializedThis)
+                {
+                    return std::nullopt;
+                }
+                type = local;
+                isZero = false;
+            }
+            else if ((local.kind == Type::Long || local.kind == Type::Double)
+                && !(region.result && slot + 1 == region.resultSlot))
+            {
+                // one zero for both slots
+                type = local;
+            }
+            callSize += isZero ? 1 : getLoadSize(static_cast<uint16_t>(slot));
+            region.descriptor += getDescriptor(type);
+            region.arguments.push_back(type);
+            region.isZero.push_back(isZero);
+            slot += getSlots(type);
+        }
+        if (slot > UINT8_MAX)
+        {
+            return std::nullopt;
+        }
+        region.descriptor += ')';
+
+        if (region.result)
+        {
+            region.descriptor += getDescriptor(*region.result);
+            callSize += getLoadSize(region.resultSlot);
+        }
+        else if (exit)
+        {
+            region.descriptor += 'V';
+        }
+        else
+        {
+            region.descriptor += Bytecode::getReturnType(code_.getOwner()->getDescriptor()->getString());
+        }
+        if (!exit)
+        {
+            callSize += 1;
+        }
+        else if (*exit != end)
+        {
+            callSize += 3;
+        }
+
+        if (size <= callSize)
+        {
+            return std::nullopt;
+        }
+        region.size = size;
+        region.gain = size - callSize;
+        return region;
+    }
+
+    MethodOutliner::Move MethodOutliner::prepareMove(const ControlFlowGraph& graph, const Region& region)
+    {
+        auto blocks = graph.getBlocks();
+        auto& code = code_.code_;
+        Move move{blocks[region.first].start, blocks[region.end - 1].end};
+        Instruction* startInstruction = code[move.first];
+        Instruction* exitInstruction = region.exit ? code[blocks[*region.exit].start] : nullptr;
+
+        // a final goto to the continuation stays after the call, the new method returns instead
+        const Instruction* lastInstruction = code[move.last - 1];
+        bool isFinalGoto = region.exit && *region.exit != region.end && move.last - 1 > move.first
+            && !isLabeled_[move.last - 1] && lastInstruction->getCommandCode() == Instruction::INSTRUCTION_goto
+            && static_cast<const InstructionJump*>(lastInstruction)->getJumpLabel()->getInstruction() == exitInstruction;
+        Instruction* finishInstruction = move.last < code.size() ? code[move.last] : nullptr;
+        if (isFinalGoto)
+        {
+            --move.last;
+        }
+        Instruction* endInstruction = move.last < code.size() ? code[move.last] : nullptr;
+
+        // private static synthetic method named after the outlined one
+        Class* owner = code_.getOwner()->getOwner();
+        std::string name = code_.getOwner()->getName()->getString();
+        if (name.starts_with('<'))
+        {
+            name = name.substr(1, name.size() - 2);
+        }
+        auto* descriptor = owner->getOrCreateUtf8Constant(region.descriptor);
+        do
+        {
+            move.method = owner->getOrCreateMethod(name + "$outlined" + std::to_string(helperCount_++), descriptor);
+        }
+        while (!move.method->getAccessFlags()->empty() || !move.method->getAttributes()->empty());
+        move.method->addFlag(Method::ACC_PRIVATE);
+        move.method->addFlag(Method::ACC_STATIC);
+        move.method->addFlag(Method::ACC_SYNTHETIC);
+        move.helper = move.method->getCodeAttribute();
+        move.helperStart = move.helper->CodeLabel();
+        move.helperExit = region.exit ? move.helper->CodeLabel() : nullptr;
+
+        // jumps to the start loop in the new method, jumps out of the region return from it;
+        // a moved range ending after the kept final goto ends at the return too
+        auto remap = [&](Label*& label)
+        {
+            const Instruction* target = label->getInstruction();
+            if (target == startInstruction)
+            {
+                label = move.helperStart;
+            }
+            else if (target != nullptr
+                && (target == exitInstruction || target == endInstruction || target == finishInstruction))
+            {
+                label = move.helperExit;
+            }
+        };
+        for (std::size_t position = move.first; position < move.last; ++position)
+        {
+            Instruction* instruction = code[position];
+            if (instruction->getOperandKind() == Instruction::OPERAND_jump)
+            {
+                remap(static_cast<InstructionJump*>(instruction)->label_);
+            }
+            else if (instruction->getOperandKind() == Instruction::OPERAND_switch)
+            {
+                auto* switchInstruction = static_cast<InstructionSwitch*>(instruction);
+                remap(switchInstruction->defaultLabel_);
+                for (auto& label : switchInstruction->labels_)
+                {
+                    remap(label);
+                }
+            }
+        }
+        for (const auto& range : handlers_)
+        {
+            if (move.first <= range.handler && range.handler < move.last)
+            {
+                remap(range.entry->tryStartLabel_);
+                remap(range.entry->tryFinishLabel_);
+                remap(range.entry->catchStartLabel_);
+                move.handlers.push_back(range.entry);
+            }
+        }
+
+        // arguments in the slots of the local variables, then the result or the return of the outlined method
+        uint16_t slot = 0;
+        for (std::size_t i = 0; i < region.arguments.size(); ++i)
+        {
+            const auto& type = region.arguments[i];
+            move.call.push_back(region.isZero[i] ? createZero(code_, type) : createLoad(code_, type, slot));
+            slot += getSlots(type);
+        }
+        move.call.push_back(code_.InvokeStatic(owner->getOrCreateMethodrefConstant(
+            owner->getOrCreateClassConstant(owner->getName()), move.method->getName(), descriptor)));
+        if (region.result)
+        {
+            move.call.push_back(createStore(code_, *region.result, region.resultSlot));
+            move.exit.push_back(createLoad(*move.helper, *region.result, region.resultSlot));
+            move.exit.push_back(createReturn(*move.helper, getDescriptor(*region.result)));
+        }
+        else if (region.exit)
+        {
+            move.exit.push_back(move.helper->ReturnVoid());
+        }
+        if (!region.exit)
+        {
+            move.call.push_back(createReturn(code_, Bytecode::getReturnType(region.descriptor)));
+        }
+        else if (*region.exit != region.end && !isFinalGoto)
+        {
+            move.call.push_back(code_.GoTo(getLabel(exitInstruction)));
+        }
+        return move;
+    }
+
+    void MethodOutliner::applyMove(const Move& move)
+    {
+        auto& code = code_.code_;
+        for (auto* label : code_.allRegisteredLabels_)
+        {
+            if (label->instruction_ == code[move.first])
+            {
+                label->instruction_ = move.call.front();
+            }
+        }
+        code_.moveTo(*move.helper, move.first, move.last, move.handlers);
+        code.insert(code.begin() + static_cast<std::ptrdiff_t>(move.first), move.call.begin(), move.call.end());
+
+        move.helperStart->instruction_ = move.helper->code_.front();
+        move.helper->allRegisteredLabels_.insert(move.helperStart);
+        if (move.helperExit != nullptr)
+        {
+            move.helper->addLabel(move.helperExit);
+        }
+        move.helper->addInstructions(move.exit);
+    }
+
+    Label* MethodOutliner::getLabel(Instruction* instruction)
+    {
+        for (auto* label : code_.allRegisteredLabels_)
+        {
+            if (label->instruction_ == instruction)
+            {
+                return label;
+            }
+        }
+        Label* label = code_.CodeLabel();
+        label->instruction_ = instruction;
+        code_.allRegisteredLabels_.insert(label);
+        return label;
+    }
+} // jvm::internal
@@ -0,0 +1,357 @@
+#include "jvm/internal/peephole-optimizer.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "jvm/attribute-code.h"
+#include "jvm/instruction-jump.h"
+#include "jvm/instruction-value.h"
+#include "jvm/internal/bytecode.h"
+
+namespace jvm::internal
+{
+    namespace
+    {
+        bool isLoad(Instruction::Command command)
+        {
+            return Instruction::INSTRUCTION_iload <= command && command <= Instruction::INSTRUCTION_aload_3;
+        }
+
+        bool isStore(Instruction::Command command)
+        {
+            return Instruction::INSTRUCTION_istore <= command && command <= Instruction::INSTRUCTION_astore_3;
+        }
+
+        /**
+         * @brief Get the type of a load or store: 0 to 4 for i, l, f, d, a.
+         */
+        int getLocalType(Instruction::Command command)
+        {
+            if (command <= Instruction::INSTRUCTION_aload)
+            {
+                return command - Instruction::INSTRUCTION_iload;
+            }
+            if (command <= Instruction::INSTRUCTION_aload_3)
+            {
+                return (command - Instruction::INSTRUCTION_iload_0) / 4;
+            }
+            if (command <= Instruction::INSTRUCTION_astore)
+            {
+                return command - Instruction::INSTRUCTION_istore;
+            }
+            return (command - Instruction::INSTRUCTION_istore_0) / 4;
+        }
+
+        /**
+         * @brief Get the int value pushed by @c iconst_<i>, @c bipush or @c sipush.
+         */
+        std::optional<int32_t> getIntConstant(const Instruction* instruction)
+        {
+            auto command = instruction->getCommandCode();
+            if (Instruction::INSTRUCTION_iconst_m1 <= command && command <= Instruction::INSTRUCTION_iconst_5)
+            {
+                return command - Instruction::INSTRUCTION_iconst_0;
+            }
+            if (command == Instruction::INSTRUCTION_bipush)
+            {
+                return static_cast<const InstructionValue<int8_t>*>(instruction)->getFirstValue();
+            }
+            if (command == Instruction::INSTRUCTION_sipush)
+            {
+                return static_cast<const InstructionValue<int16_t>*>(instruction)->getFirstValue();
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * @brief Get the slots pushed by an instruction without other effect.
+         *
+         * @return Pushed slots, or 0 if the instruction pops or has side effects.
+         */
+        uint8_t getPushedSlots(Instruction::Command command)
+        {
+            if (Instruction::INSTRUCTION_aconst_null <= command && command <= Instruction::INSTRUCTION_sipush)
+            {
+                bool isCategory2 = (Instruction::INSTRUCTION_lconst_0 <= command && command <= Instruction::INSTRUCTION_lconst_1)
+                    || (Instruction::INSTRUCTION_dconst_0 <= command && command <= Instruction::INSTRUCTION_dconst_1);
+                return isCategory2 ? 2 : 1;
+            }
+            if (isLoad(command))
+            {
+                return Bytecode::getLocalSlots(command);
+            }
+            if (command == Instruction::INSTRUCTION_dup)
+            {
+                return 1;
+            }
+            if (command == Instruction::INSTRUCTION_dup2)
+            {
+                return 2;
+            }
+            return 0;
+        }
+
+        /**
+         * @brief Check whether an operation after pushing @p constant leaves its other operand unchanged.
+         */
+        bool isIdentity(Instruction::Command constant, Instruction::Command operation)
+        {
+            switch (constant)
+            {
+            case Instruction::INSTRUCTION_iconst_0:
+                return operation == Instruction::INSTRUCTION_iadd || operation == Instruction::INSTRUCTION_isub
+                    || operation == Instruction::INSTRUCTION_ior || operation == Instruction::INSTRUCTION_ixor
+                    || operation == Instruction::INSTRUCTION_ishl || operation == Instruction::INSTRUCTION_ishr
+                    || operation == Instruction::INSTRUCTION_iushr || operation == Instruction::INSTRUCTION_lshl
+                    || operation == Instruction::INSTRUCTION_lshr || operation == Instruction::INSTRUCTION_lushr;
+            case Instruction::INSTRUCTION_iconst_1:
+                return operation == Instruction::INSTRUCTION_imul || operation == Instruction::INSTRUCTION_idiv;
+            case Instruction::INSTRUCTION_lconst_0:
+                return operation == Instruction::INSTRUCTION_ladd || operation == Instruction::INSTRUCTION_lsub
+                    || operation == Instruction::INSTRUCTION_lor || operation == Instruction::INSTRUCTION_lxor;
+            case Instruction::INSTRUCTION_lconst_1:
+                return operation == Instruction::INSTRUCTION_lmul || operation == Instruction::INSTRUCTION_ldiv;
+            default:
+                return false;
+            }
+        }
+
+        /**
+         * @brief Get the slots popped by a conditional jump.
+         *
+         * @return 1 or 2, or 0 if @p command is not a conditional jump.
+         */
+        uint8_t getConditionSlots(Instruction::Command command)
+        {
+            if ((Instruction::INSTRUCTION_ifeq <= command && command <= Instruction::INSTRUCTION_ifle)
+                || command == Instruction::INSTRUCTION_ifnull || command == Instruction::INSTRUCTION_ifnonnull)
+            {
+                return 1;
+            }
+            if (Instruction::INSTRUCTION_if_icmpeq <= command && command <= Instruction::INSTRUCTION_if_acmpne)
+            {
+                return 2;
+            }
+            return 0;
+        }
+    }
+
+    PeepholeOptimizer::PeepholeOptimizer(AttributeCode& code) : code_(code)
+    {
+    }
+
+    std::size_t PeepholeOptimizer::run()
+    {
+        std::size_t rewrites = 0;
+        for (std::size_t count = rewriteOnce(); count != 0; count = rewriteOnce())
+        {
+            rewrites += count;
+        }
+        code_.removeEmptyExceptionHandlers();
+        return rewrites;
+    }
+
+    std::size_t PeepholeOptimizer::rewriteOnce()
+    {
+        labeled_.clear();
+        for (const auto* label : code_.allRegisteredLabels_)
+        {
+            labeled_.insert(label->getInstruction());
+        }
+
+        std::vector<Instruction*> code;
+        code.reserve(code_.code_.size());
+        std::vector<Instruction*> removed;
+        std::unordered_map<const Instruction*, Instruction*> moved;
+        std::vector<const Instruction*> movedToNext;
+        std::size_t rewrites = 0;
+
+        auto emit = [&](Instruction* instruction)
+        {
+            for (const auto* removedFirst : movedToNext)
+            {
+                moved.emplace(removedFirst, instruction);
+            }
+            movedToNext.clear();
+            code.push_back(instruction);
+        };
+
+        for (std::size_t position = 0; position < code_.code_.size();)
+        {
+            auto rewrite = match(position);
+            if (rewrite && rewrite->replacement.empty() && position + rewrite->length == code_.code_.size()
+                && (labeled_.contains(code_.code_[position]) || !movedToNext.empty()))
+            {
+                // no next instruction to move the labels to
+                rewrite.reset();
+            }
+            if (!rewrite)
+            {
+                emit(code_.code_[position++]);
+                continue;
+            }
+            ++rewrites;
+
+            // labels can only be bound to the first instruction of the sequence
+            Instruction* first = code_.code_[position];
+            if (rewrite->replacement.empty())
+            {
+                if (labeled_.contains(first))
+                {
+                    movedToNext.push_back(first);
+                }
+            }
+            else if (rewrite->replacement.front() != first)
+            {
+                moved.emplace(first, rewrite->replacement.front());
+            }
+
+            for (std::size_t i = position; i < position + rewrite->length; ++i)
+            {
+                Instruction* instruction = code_.code_[i];
+                if (std::find(rewrite->replacement.begin(), rewrite->replacement.end(), instruction)
+                    == rewrite->replacement.end())
+                {
+                    removed.push_back(instruction);
+                }
+            }
+            for (auto* instruction : rewrite->replacement)
+            {
+                emit(instruction);
+            }
+            position += rewrite->length;
+        }
+        if (rewrites == 0)
+        {
+            return 0;
+        }
+
+        for (auto* label : code_.allRegisteredLabels_)
+        {
+            auto target = moved.find(label->instruction_);
+            if (target != moved.end())
+            {
+                label->instruction_ = target->second;
+            }
+        }
+        for (auto* instruction : removed)
+        {
+            std::destroy_at(instruction);
+        }
+        code_.code_ = std::move(code);
+        return rewrites;
+    }
+
+    std::optional<PeepholeOptimizer::Rewrite> PeepholeOptimizer::match(std::size_t position)
+    {
+        const auto& code = code_.code_;
+        Instruction* first = code[position];
+        auto command = first->getCommandCode();
+
+        // jump to the next instruction
+        if (first->getOperandKind() == Instruction::OPERAND_jump && position + 1 < code.size()
+            && static_cast<const InstructionJump*>(first)->getJumpLabel()->getInstruction() == code[position + 1])
+        {
+            if (command == Instruction::INSTRUCTION_goto)
+            {
+                return Rewrite{1};
+            }
+            if (uint8_t slots = getConditionSlots(command))
+            {
+                return Rewrite{1, {slots == 1 ? code_.PopOne() : code_.PopTwo()}};
+            }
+        }
+
+        if (!isSequence(position, 2))
+        {
+            return std::nullopt;
+        }
+        Instruction* second = code[position + 1];
+        auto secondCommand = second->getCommandCode();
+
+        // value popped right after it is pushed
+        if (uint8_t slots = getPushedSlots(command))
+        {
+            if ((slots == 1 && secondCommand == Instruction::INSTRUCTION_pop)
+                || (slots == 2 && secondCommand == Instruction::INSTRUCTION_pop2))
+            {
+                return Rewrite{2};
+            }
+        }
+
+        // operation with its identity element
+        if (isIdentity(command, secondCommand))
+        {
+            return Rewrite{2};
+        }
+
+        // load and store, or store and load, of the same local variable
+        bool isLoadStore = isLoad(command) && isStore(secondCommand);
+        bool isStoreLoad = isStore(command) && isLoad(secondCommand);
+        if ((isLoadStore || isStoreLoad) && getLocalType(command) == getLocalType(secondCommand)
+            && getLocalIndex(first) == getLocalIndex(second))
+        {
+            if (isLoadStore)
+            {
+                return Rewrite{2};
+            }
+            if (isSequence(position + 1, 2) && code[position + 2]->getCommandCode() == command
+                && getLocalIndex(code[position + 2]) == getLocalIndex(first))
+            {
+                // the load and the next store cancel out
+                return std::nullopt;
+            }
+            auto* duplicate = Bytecode::getLocalSlots(command) == 2 ? code_.DuplicateDouble() : code_.Duplicate();
+            return Rewrite{2, {duplicate, first}};
+        }
+
+        // local variable incremented by a constant
+        if (command != Instruction::INSTRUCTION_iload && (command < Instruction::INSTRUCTION_iload_0
+                                                          || command > Instruction::INSTRUCTION_iload_3))
+        {
+            return std::nullopt;
+        }
+        if (!isSequence(position, 4))
+        {
+            return std::nullopt;
+        }
+        auto constant = getIntConstant(second);
+        auto operation = code[position + 2]->getCommandCode();
+        const Instruction* store = code[position + 3];
+        if (!constant || (operation != Instruction::INSTRUCTION_iadd && operation != Instruction::INSTRUCTION_isub)
+            || !isStore(store->getCommandCode()) || getLocalType(store->getCommandCode()) != 0
+            || getLocalIndex(store) != getLocalIndex(first))
+        {
+            return std::nullopt;
+        }
+        int32_t increment = operation == Instruction::INSTRUCTION_iadd ? *constant : -*constant;
+        if (increment < INT16_MIN || increment > INT16_MAX)
+        {
+            return std::nullopt;
+        }
+        auto index = static_cast<uint16_t>(getLocalIndex(first));
+        return Rewrite{4, {code_.IncrementLocalVariable(index, static_cast<int16_t>(increment))}};
+    }
+
+    bool PeepholeOptimizer::isSequence(std::size_t position, std::size_t length) const
+    {
+        const auto& code = code_.code_;
+        if (position + length > code.size())
+        {
+            return false;
+        }
+        for (std::size_t i = position + 1; i < position + length; ++i)
+        {
+            if (labeled_.contains(code[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::size_t PeepholeOptimizer::getLocalIndex(const Instruction* instruction) const
+    {
+        return code_.getLocalsEnd(instruction) - Bytecode::getLocalSlots(instruction->getCommandCode());
+    }
+} // jvm::internal
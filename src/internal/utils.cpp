@@ -11,22 +11,30 @@ namespace jvm::internal
 
     void Utils::writeBigEndian(std::ostream& os, uint16_t val)
     {
-        os.put(static_cast<char>((val >> 8) & 0xFF));
-        os.put(static_cast<char>(val & 0xFF));
+        const char bytes[] = {
+            static_cast<char>((val >> 8) & 0xFF),
+            static_cast<char>(val & 0xFF),
+        };
+        os.write(bytes, sizeof(bytes));
     }
 
     void Utils::writeBigEndian(std::ostream& os, uint32_t val)
     {
-        os.put(static_cast<char>((val >> 24) & 0xFF));
-        os.put(static_cast<char>((val >> 16) & 0xFF));
-        os.put(static_cast<char>((val >> 8) & 0xFF));
-        os.put(static_cast<char>(val & 0xFF));
+        const char bytes[] = {
+            static_cast<char>((val >> 24) & 0xFF),
+            static_cast<char>((val >> 16) & 0xFF),
+            static_cast<char>((val >> 8) & 0xFF),
+            static_cast<char>(val & 0xFF),
+        };
+        os.write(bytes, sizeof(bytes));
     }
 
     void Utils::writeBigEndian(std::ostream& os, uint64_t val)
     {
+        char bytes[8];
         for (int i = 7; i >= 0; --i)
-            os.put(static_cast<char>((val >> (i * 8)) & 0xFF));
+            bytes[7 - i] = static_cast<char>((val >> (i * 8)) & 0xFF);
+        os.write(bytes, sizeof(bytes));
     }
 
     void Utils::writeBigEndian(std::ostream& os, int8_t val)
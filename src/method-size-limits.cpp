@@ -0,0 +1,80 @@
+#include "jvm/method-size-limits.h"
+
+#include <stdexcept>
+#include <string>
+
+#include "jvm/constant-utf-8-info.h"
+#include "jvm/method.h"
+
+using namespace jvm;
+
+namespace
+{
+    const char* getCategoryName(MethodSizeLimits::Category category)
+    {
+        switch (category)
+        {
+        case MethodSizeLimits::CATEGORY_inlinable:
+            return "inlinable";
+        case MethodSizeLimits::CATEGORY_hot_inlinable:
+            return "inlinable at frequent call sites";
+        case MethodSizeLimits::CATEGORY_compilable:
+            return "too large to inline";
+        default:
+            return "too large to compile";
+        }
+    }
+}
+
+MethodSizeLimits::Category MethodSizeLimits::getCategory(std::size_t codeLength) const noexcept
+{
+    // HotSpot rejects a method when its size is above a limit
+    if (codeLength > hugeMethodLimit)
+    {
+        return CATEGORY_huge;
+    }
+    if (codeLength > freqInlineSize)
+    {
+        return CATEGORY_compilable;
+    }
+    if (codeLength > maxInlineSize)
+    {
+        return CATEGORY_hot_inlinable;
+    }
+    return CATEGORY_inlinable;
+}
+
+MethodSizeReport MethodSizeLimits::report(const Method* method, std::size_t codeLength) const noexcept
+{
+    Category category = getCategory(codeLength);
+    std::size_t exceededLimit = 0;
+    switch (category)
+    {
+    case CATEGORY_hot_inlinable:
+        exceededLimit = maxInlineSize;
+        break;
+    case CATEGORY_compilable:
+        exceededLimit = freqInlineSize;
+        break;
+    case CATEGORY_huge:
+        exceededLimit = hugeMethodLimit;
+        break;
+    default:
+        exceededLimit = codeLength;
+        break;
+    }
+    return {method, codeLength, category, codeLength - exceededLimit};
+}
+
+void MethodSizeLimits::check(const Method* method, std::size_t codeLength) const
+{
+    auto sizeReport = report(method, codeLength);
+    if (sizeReport.category <= strictCategory)
+    {
+        return;
+    }
+    throw std::runtime_error("Method " + method->getName()->getString() + method->getDescriptor()->getString()
+                             + " has " + std::to_string(codeLength) + " bytes of code, "
+                             + std::to_string(sizeReport.excess) + " above the limit: "
+                             + getCategoryName(sizeReport.category) + ".");
+}
@@ -1,13 +1,27 @@
 #include "jvm/method.h"
 
 #include <cassert>
-#include <ostream>
+#include <memory>
+#include <stdexcept>
 #include <utility>
 
 #include "jvm/internal/utils.h"
 
 using namespace jvm;
 
+Method::~Method()
+{
+    // memory is released with the arena of the class
+    if (codeAttribute_ != nullptr)
+    {
+        std::destroy_at(codeAttribute_);
+    }
+    if (codeEmitter_ != nullptr)
+    {
+        std::destroy_at(codeEmitter_);
+    }
+}
+
 void Method::addFlag(AccessFlag flag)
 {
     uint16_t newFlags = 0;
@@ -57,15 +71,35 @@ const std::set<Attribute*>* Method::getAttributes() const
 
 AttributeCode* Method::getCodeAttribute()
 {
+    if (codeEmitter_ != nullptr)
+    {
+        throw std::logic_error("Method code is written by a CodeEmitter.");
+    }
     if (codeAttribute_ == nullptr)
     {
-        codeAttribute_ = new AttributeCode(this);
+        void* memory = getOwner()->getMemoryResource()->allocate(sizeof(AttributeCode), alignof(AttributeCode));
+        codeAttribute_ = new(memory) AttributeCode(this);
         attributes_.insert(codeAttribute_);
     }
     return codeAttribute_;
 }
 
-void Method::writeTo(std::ostream& os) const
+CodeEmitter* Method::getCodeEmitter()
+{
+    if (codeAttribute_ != nullptr)
+    {
+        throw std::logic_error("Method code is written by an AttributeCode.");
+    }
+    if (codeEmitter_ == nullptr)
+    {
+        void* memory = getOwner()->getMemoryResource()->allocate(sizeof(CodeEmitter), alignof(CodeEmitter));
+        codeEmitter_ = new(memory) CodeEmitter(this);
+        attributes_.insert(codeEmitter_);
+    }
+    return codeEmitter_;
+}
+
+void Method::writeTo(ByteWriter& writer) const
 {
     // u2             access_flags;
     uint16_t accessFlags = 0x0000;
@@ -73,31 +107,37 @@ void Method::writeTo(std::ostream& os) const
     {
         accessFlags = accessFlags | flag;
     }
-    internal::Utils::writeBigEndian(os, accessFlags);
+    writer.writeBigEndian(accessFlags);
 
     // u2             name_index;
     uint16_t nameIndex = name_->getIndex();
-    internal::Utils::writeBigEndian(os, nameIndex);
+    writer.writeBigEndian(nameIndex);
 
     // u2             descriptor_index;
     uint16_t descriptorIndex = descriptor_->getIndex();
-    internal::Utils::writeBigEndian(os, descriptorIndex);
+    writer.writeBigEndian(descriptorIndex);
 
     // u2             attributes_count;
     uint16_t attributeCount = attributes_.size();
-    internal::Utils::writeBigEndian(os, attributeCount);
+    writer.writeBigEndian(attributeCount);
 
-    if (codeAttribute_ != nullptr) { codeAttribute_->finalize(); }
+    // code finalized by the finalizer of a batch is kept, see Class::writeAll
+    if (codeAttribute_ != nullptr && !codeAttribute_->isFinalized()) { codeAttribute_->finalize(); }
+    if (codeEmitter_ != nullptr && !codeEmitter_->isFinalized()) { codeEmitter_->finalize(); }
     // attribute_info attributes[attributes_count];
     for (auto* attribute : attributes_)
     {
-        os << *attribute;
+        writer << *attribute;
     }
 }
 
 std::size_t Method::getByteSize() const
 {
-    size_t size = sizeof(AccessFlag) + sizeof(uint16_t) + sizeof(uint16_t) + sizeof(uint16_t);
+    if (codeAttribute_ != nullptr && !codeAttribute_->isFinalized()) { codeAttribute_->finalize(); }
+    if (codeEmitter_ != nullptr && !codeEmitter_->isFinalized()) { codeEmitter_->finalize(); }
+
+    // access_flags, name_index, descriptor_index, attributes_count
+    size_t size = 4 * sizeof(uint16_t);
     for (auto* attribute : attributes_)
     {
         size += attribute->getByteSize();
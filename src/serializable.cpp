@@ -0,0 +1,14 @@
+#include "jvm/serializable.h"
+
+#include <ostream>
+
+using namespace jvm;
+
+void Serializable::writeTo(std::ostream& os) const
+{
+    ByteWriter writer;
+    writeTo(writer);
+
+    auto bytes = writer.bytes();
+    os.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+}